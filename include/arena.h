@@ -0,0 +1,61 @@
+/** \file arena.h
+ ** \brief Defines Arena and declares its member functions.
+ **/
+#ifndef ARENA_H
+	#define ARENA_H
+	#include <stddef.h>
+	#include "debug.h"
+
+	#ifndef ARENA_BLOCK_SIZE
+		#define ARENA_BLOCK_SIZE 65536
+	#endif
+	#ifndef ARENA_ALIGNMENT
+		#define ARENA_ALIGNMENT 16
+	#endif
+	#ifndef ARENA_ROUND_UP
+		#define ARENA_ROUND_UP(size) \
+			(((size) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+	#endif
+
+	/** \brief An ArenaBlock is a chunk of memory that an Arena hands out from the front.
+	 **/
+	typedef struct ArenaBlockBody {
+		struct ArenaBlockBody* next;
+		size_t capacity;
+		size_t size;
+	} ArenaBlock;
+
+	/** \brief An Arena is a bump allocator whose memory is freed all at once.
+	 **
+	 ** Objects allocated from an Arena are never freed one by one; finalize_arena
+	 ** releases every ArenaBlock in one shot.
+	 **/
+	typedef struct ArenaBody {
+		ArenaBlock* head;
+		size_t nBytes;
+	} Arena;
+
+	#define ASSERT_ARENA(arena)	\
+		ASSERT_NOT_NULL(arena)
+
+	Arena* initialize_arena(Arena*);
+	void finalize_arena(Arena*);
+	void* allocate_arena(Arena*, const size_t);
+	void* reallocate_arena(Arena*, void*, const size_t, const size_t);
+	char* fromSlice_arena(Arena*, const char*, const size_t);
+
+	#ifdef SAFE_ARENA_MALLOC
+		#undef SAFE_ARENA_MALLOC
+	#endif
+	#define SAFE_ARENA_MALLOC(ptr,arena,type,size) ptr = allocate_arena(arena, (size) * sizeof(type)); ASSERT_NOT_NULL(ptr)
+
+	#ifdef SAFE_ARENA_CALLOC
+		#undef SAFE_ARENA_CALLOC
+	#endif
+	#define SAFE_ARENA_CALLOC(ptr,arena,type,size) SAFE_ARENA_MALLOC(ptr,arena,type,size); memset(ptr, 0, (size) * sizeof(type))
+
+	#ifdef SAFE_ARENA_REALLOC
+		#undef SAFE_ARENA_REALLOC
+	#endif
+	#define SAFE_ARENA_REALLOC(ptr,arena,type,oldSize,size) ptr = reallocate_arena(arena, ptr, (oldSize) * sizeof(type), (size) * sizeof(type)); ASSERT_NOT_NULL(ptr)
+#endif
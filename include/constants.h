@@ -510,36 +510,20 @@
 		#endif
 	#endif
 
-	#ifndef XML_MAX_TAG_SIZE
-		#define XML_MAX_TAG_SIZE 32
+	#ifndef XML_INITIAL_TAGS_SIZE
+		#define XML_INITIAL_TAGS_SIZE 256
 	#endif
 
-	#ifndef XML_MAX_CONTENT_SIZE
-		#define XML_MAX_CONTENT_SIZE 256
+	#ifndef XML_INITIAL_CHILDREN
+		#define XML_INITIAL_CHILDREN 4
 	#endif
 
-	#ifndef XML_MAX_CHILDREN
-		#define XML_MAX_CHILDREN 32
+	#ifndef XML_INITIAL_ATTRIBUTES
+		#define XML_INITIAL_ATTRIBUTES 2
 	#endif
 
-	#ifndef XML_MAX_NODES
-		#define XML_MAX_NODES 1024
-	#endif
-
-	#ifndef XML_MAX_ATTRIBUTES
-		#define XML_MAX_ATTRIBUTES 32
-	#endif
-
-	#ifndef XML_MAX_ATTRIBUTE_NAME_SIZE
-		#define XML_MAX_ATTRIBUTE_NAME_SIZE 32
-	#endif
-
-	#ifndef XML_MAX_ATTRIBUTE_VAL_SIZE
-		#define XML_MAX_ATTRIBUTE_VAL_SIZE 256
-	#endif
-
-	#ifndef XML_META_MAX_SIZE
-		#define XML_META_MAX_SIZE 250
+	#ifndef XML_CHUNK_SIZE
+		#define XML_CHUNK_SIZE 65536
 	#endif
 
 	#ifndef XML_EQUAL_SYMBOL
@@ -3,8 +3,10 @@
  **/
 #ifndef DFA_H
 	#define DFA_H
+	#include "arena.h"
 	#include "constants.h"
 	#include "dot.h"
+	#include "intern.h"
 	#include "list.h"
 	#include "xml.h"
 
@@ -13,8 +15,8 @@
 	#ifndef DFA_MAX_NAME_SIZE
 		#define DFA_MAX_NAME_SIZE 30
 	#endif
-	#ifndef DFA_MAX_STATES
-		#define DFA_MAX_STATES 100
+	#ifndef DFA_INITIAL_CAPACITY
+		#define DFA_INITIAL_CAPACITY 4
 	#endif
 	#ifndef DFA_MAX_SYMBOLS
 		#define DFA_MAX_SYMBOLS 256
@@ -34,31 +36,82 @@
 	#ifndef DFA_DEFAULT_STATE_NAME
 		#define DFA_DEFAULT_STATE_NAME(id) "s%u",id
 	#endif
+	#ifndef DFA_SINK_STATE_NAME
+		#define DFA_SINK_STATE_NAME "sink"
+	#endif
+	#ifndef DFA_COMPARE_COST
+		#define DFA_COMPARE_COST 1
+	#endif
+	#ifndef DFA_BITMAP_COST
+		#define DFA_BITMAP_COST 3
+	#endif
+	#ifndef DFA_SWITCH_COST
+		#define DFA_SWITCH_COST 6
+	#endif
+	#ifndef DFA_SKIP_MIN_BYTES
+		#define DFA_SKIP_MIN_BYTES 16
+	#endif
+	#ifndef DFA_SKIP_MAX_RANGES
+		#define DFA_SKIP_MAX_RANGES 3
+	#endif
+	#ifndef DFA_BATCH_WIDTH
+		#define DFA_BATCH_WIDTH 8
+	#endif
+	#ifndef DFA_SHUFFLE_STATES
+		#define DFA_SHUFFLE_STATES 16
+	#endif
+	#ifndef DFA_SHUFFLE_LANES
+		#define DFA_SHUFFLE_LANES 4
+	#endif
+	#ifndef DFA_SHUFFLE_BLOCK
+		#define DFA_SHUFFLE_BLOCK 4096
+	#endif
+	#ifndef DFA_DEAD_LABEL
+		#define DFA_DEAD_LABEL "dead_"
+	#endif
+	#ifndef DFA_NO_STATE
+		#define DFA_NO_STATE ((DFAStateId)-1)
+	#endif
 
+	/** \brief A state of a DFA. Its name is interned in the names of the DFA.
+	 **/
 	typedef struct DFAStateBody {
 		DFAStateId id;
-		char name[DFA_MAX_NAME_SIZE];
+		const char* name;
 		int isAccept;
 	} DFAState;
-	#define ASSERT_DFASTATE(state)								\
-		ASSERT_NOT_NULL(state);									\
-		ASSERT_NOT_EMPTY(state->name);							\
-		ASSERT_NOT_TOO_LONG(state->name, DFA_MAX_NAME_SIZE);	\
-		ASSERT_FITS_IN_BOUND(state->id, DFA_MAX_STATES)
+	#define ASSERT_DFASTATE(state)		\
+		ASSERT_NOT_NULL(state);			\
+		ASSERT_NOT_NULL(state->name);	\
+		ASSERT_NOT_EMPTY(state->name)
 
 	char* toString_dfas(char*, const DFAState*);
 
-	DECLARE_ARRAY_OF(DFAState,DFA_MAX_STATES,nStates,array,dfasa);
-	DECLARE_LIST_OF(DFAState,DFA_MAX_STATES,nStates,list,dfasl);
-	#define ASSERT_DFASTATEARRAY(array) ASSERT_ARRAY(array,nStates,DFA_MAX_STATES)
-	#define ASSERT_DFASTATELIST(list) ASSERT_LIST(list,nStates,DFA_MAX_STATES)
+	/** \brief A heap-backed array of DFAState objects, growing geometrically.
+	 **/
+	typedef struct DFAStateArrayBody {
+		DFAState* array;
+		unsigned int nStates;
+		unsigned int capacity;
+	} DFAStateArray;
+	#define ASSERT_DFASTATEARRAY(states)								\
+		ASSERT_NOT_NULL(states);										\
+		ASSERT_FITS_IN_BOUND(states->nStates, states->capacity + 1)
 
+	/** \brief A DFA with one contiguous transition row per state.
+	 **
+	 ** The states and the transition rows share the same capacity and grow together.
+	 ** The state names are interned in an InternTable backed by the Arena of the DFA,
+	 ** so a DFA must NOT be copied by value.
+	 **/
 	typedef struct DeterministicFiniteAutomatonBody {
 		char name[DFA_MAX_NAME_SIZE];
 		char alphabet[DFA_MAX_SYMBOLS];
 		DFAStateArray states[1];
 		DFAStateId initialStateId;
-		DFAStateId transitions[DFA_MAX_STATES][DFA_MAX_SYMBOLS];
+		DFAStateId (*transitions)[DFA_MAX_SYMBOLS];
+		Arena arena[1];
+		InternTable names[1];
 	} DeterministicFiniteAutomaton;
 	#define ASSERT_DFA(dfa)												\
 		ASSERT_NOT_NULL(dfa);											\
@@ -66,14 +119,115 @@
 		ASSERT_NOT_TOO_LONG(dfa->name, DFA_MAX_NAME_SIZE);				\
 		ASSERT_NOT_EMPTY(dfa->alphabet);								\
 		ASSERT_NOT_TOO_LONG(dfa->alphabet, DFA_MAX_SYMBOLS);			\
-		ASSERT_DFASTATEARRAY(dfa->states);								\
-		ASSERT_FITS_IN_BOUND(dfa->initialStateId, DFA_MAX_STATES)
+		ASSERT_DFASTATEARRAY(dfa->states)
+
+	/** \brief A partition of all byte values into equivalence classes.
+	 **
+	 ** Two bytes share a class iff they lead to the same state from every state of a DFA.
+	 ** Class 0 always contains the NUL byte, i.e. every byte outside of the alphabet.
+	 **/
+	typedef struct DFAByteClassesBody {
+		unsigned char classOf[DFA_MAX_SYMBOLS];
+		unsigned char representatives[DFA_MAX_SYMBOLS];
+		unsigned int nClasses;
+	} DFAByteClasses;
+	#define ASSERT_DFABYTECLASSES(classes)					\
+		ASSERT_NOT_NULL(classes);							\
+		ASSERT_NOT_ZERO(classes->nClasses);					\
+		ASSERT_FITS_IN_BOUND(classes->nClasses, DFA_MAX_SYMBOLS + 1)
+
+	/** \brief The self-loop of a state of a DFA, as a union of byte ranges.
+	 **
+	 ** nRanges is 0 when the state has no self-loop worth skipping with vector instructions,
+	 ** i.e. fewer than DFA_SKIP_MIN_BYTES looping bytes or more than DFA_SKIP_MAX_RANGES ranges.
+	 ** Range r covers the bytes lows[r] to lows[r] + widths[r].
+	 **/
+	typedef struct DFASelfLoopBody {
+		unsigned char lows[DFA_SKIP_MAX_RANGES];
+		unsigned char widths[DFA_SKIP_MAX_RANGES];
+		unsigned int nRanges;
+	} DFASelfLoop;
+	#define ASSERT_DFASELFLOOP(loop)		\
+		ASSERT_NOT_NULL(loop);				\
+		ASSERT_FITS_IN_BOUND(loop->nRanges, DFA_SKIP_MAX_RANGES + 1)
+
+	/** \brief Selects the signature of the C function emitted for a DeterministicFiniteAutomaton.
+	 **
+	 ** DFA_SIGNATURE_STRING emits `int name(const char* str)`, reading up to the terminating NUL.
+	 ** DFA_SIGNATURE_BUFFER emits `int name(const unsigned char* buf, size_t len)`, reading exactly len bytes.
+	 ** DFA_SIGNATURE_BATCH emits `void name(const unsigned char* const* bufs, const size_t* lens, size_t n,
+	 ** unsigned char* results)`, matching DFA_BATCH_WIDTH buffers in lockstep. It always uses DFA_BACKEND_TABLE.
+	 **/
+	typedef enum DFASignatureBody {
+		DFA_SIGNATURE_STRING,
+		DFA_SIGNATURE_BUFFER,
+		DFA_SIGNATURE_BATCH
+	} DFASignature;
+
+	/** \brief What a state of a DFA can still lead to.
+	 **
+	 ** From a DFA_FATE_DEAD state no accepting state is reachable, from a DFA_FATE_UNIVERSAL
+	 ** state every continuation accepts, anything else is DFA_FATE_OPEN.
+	 **/
+	typedef enum DFAFateBody {
+		DFA_FATE_OPEN,
+		DFA_FATE_DEAD,
+		DFA_FATE_UNIVERSAL
+	} DFAFate;
 
 	DeterministicFiniteAutomaton* initialize_dfa(DeterministicFiniteAutomaton*);
-	DFAState* insertState_dfa(DeterministicFiniteAutomaton*);
+	void finalize_dfa(DeterministicFiniteAutomaton*);
+	DFAState* insertState_dfa(DeterministicFiniteAutomaton*, const char*, const size_t);
 	int insertTransition_dfa(DeterministicFiniteAutomaton*, const DFAStateId, const DFAStateId, const char);
 	DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton*, const Xml*);
+	DeterministicFiniteAutomaton* fromStream_dfa(DeterministicFiniteAutomaton*, FILE*);
 	DeterministicFiniteAutomaton* fromFile_dfa(DeterministicFiniteAutomaton*, const char*);
-	Graph* toDot_dfa(Graph*, const DeterministicFiniteAutomaton*);
-	char* toC_dfa(char*, const DeterministicFiniteAutomaton*);
+	Graph* toDot_dfa(Graph*, Arena*, const DeterministicFiniteAutomaton*);
+	DFAByteClasses* toByteClasses_dfa(DFAByteClasses*, const DeterministicFiniteAutomaton*);
+	DFASelfLoop* toSelfLoop_dfa(DFASelfLoop*, const DeterministicFiniteAutomaton*, const DFAStateId);
+	DFAFate* toFates_dfa(DFAFate*, const DeterministicFiniteAutomaton*, const DFASignature);
+	DeterministicFiniteAutomaton* minimize_dfa(DeterministicFiniteAutomaton*);
+
+	/** \brief Selects how product_dfa() combines the acceptance of its operands.
+	 **
+	 ** A pair of states accepts if both states accept for DFA_OPERATION_INTERSECTION,
+	 ** if either does for DFA_OPERATION_UNION, if the left one does and the right one
+	 ** does not for DFA_OPERATION_DIFFERENCE, and if exactly one does for
+	 ** DFA_OPERATION_SYMMETRIC_DIFFERENCE.
+	 **/
+	typedef enum DFAOperationBody {
+		DFA_OPERATION_INTERSECTION,
+		DFA_OPERATION_UNION,
+		DFA_OPERATION_DIFFERENCE,
+		DFA_OPERATION_SYMMETRIC_DIFFERENCE
+	} DFAOperation;
+
+	DeterministicFiniteAutomaton* product_dfa(DeterministicFiniteAutomaton*, const DeterministicFiniteAutomaton*, const DeterministicFiniteAutomaton*, const DFAOperation);
+	DeterministicFiniteAutomaton* complete_dfa(DeterministicFiniteAutomaton*);
+	DeterministicFiniteAutomaton* complement_dfa(DeterministicFiniteAutomaton*);
+	int isEquivalent_dfa(const DeterministicFiniteAutomaton*, const DeterministicFiniteAutomaton*, char**);
+	int isIncluded_dfa(const DeterministicFiniteAutomaton*, const DeterministicFiniteAutomaton*, char**);
+
+	/** \brief Selects the shape of the C code emitted for a DeterministicFiniteAutomaton.
+	 **
+	 ** DFA_BACKEND_GOTO emits one label per state with coalesced range, bitmap or switch tests.
+	 ** DFA_BACKEND_TABLE emits a dense state x byte transition table and a one-load-per-byte loop.
+	 ** DFA_BACKEND_COMPUTED_GOTO emits a per-state table of label addresses and one indirect jump per byte,
+	 ** guarded by __GNUC__ and !__STRICT_ANSI__ with the DFA_BACKEND_GOTO code as the fallback.
+	 ** DFA_BACKEND_SHUFFLE emits one 16-byte shuffle vector per byte class and one pshufb per byte,
+	 ** guarded by __SSSE3__ with the DFA_BACKEND_TABLE code as the fallback. Automata needing more
+	 ** than DFA_SHUFFLE_STATES rows, counting the dead and universal states, always use DFA_BACKEND_TABLE.
+	 **/
+	typedef enum DFABackendBody {
+		DFA_BACKEND_GOTO,
+		DFA_BACKEND_TABLE,
+		DFA_BACKEND_COMPUTED_GOTO,
+		DFA_BACKEND_SHUFFLE
+	} DFABackend;
+
+	char* toC_dfa(char*, const DeterministicFiniteAutomaton*, const DFASignature);
+	void toStream_dfa(const DeterministicFiniteAutomaton*, FILE*, const DFABackend, const DFASignature);
+	void toFile_dfa(const DeterministicFiniteAutomaton*, const char*, const DFABackend, const DFASignature);
+	void toHppStream_dfa(const DeterministicFiniteAutomaton*, FILE*);
+	void toHppFile_dfa(const DeterministicFiniteAutomaton*, const char*);
 #endif
@@ -4,6 +4,7 @@
 #ifndef DOT_H
 	#define DOT_H
 	#include <stdio.h>
+	#include "arena.h"
 
 	#ifndef DOT_DEFAULT_SHAPE
 		#define DOT_DEFAULT_SHAPE "ellipse"
@@ -41,14 +42,14 @@
 	#ifndef DOT_MAX_NAME_SIZE
 		#define DOT_MAX_NAME_SIZE 30
 	#endif
-	#ifndef DOT_MAX_NODES
-		#define DOT_MAX_NODES 1000
+	#ifndef DOT_INITIAL_NODES
+		#define DOT_INITIAL_NODES 16
 	#endif
 	#ifndef DOT_MAX_CLUSTER_NODES
 		#define DOT_MAX_CLUSTER_NODES 100
 	#endif
-	#ifndef DOT_MAX_EDGES
-		#define DOT_MAX_EDGES 10
+	#ifndef DOT_INITIAL_EDGES
+		#define DOT_INITIAL_EDGES 4
 	#endif
 	#ifndef DOT_MAX_CLUSTERS
 		#define DOT_MAX_CLUSTERS 20
@@ -170,28 +171,30 @@
 	} Edge, DirectedEdge;
 	#define ASSERT_EDGE(edge)									\
 		ASSERT_NOT_NULL(edge); 									\
-		ASSERT_NOT_TOO_LONG(edge->label, DOT_MAX_LABEL_SIZE);	\
-		ASSERT_FITS_IN_BOUND(edge->target, DOT_MAX_NODES)
+		ASSERT_NOT_TOO_LONG(edge->label, DOT_MAX_LABEL_SIZE)
 
 	/** \brief A Node is a labeled point in a Graph.
+	 **
+	 ** The edges live in the Arena of the Graph and grow on demand. The name is NOT
+	 ** copied, so it may be shared with the object the Node stands for.
 	 **/
 	typedef struct NodeBody {
 		NodeId id;
-		char name[DOT_MAX_NAME_SIZE];
+		const char* name;
 		unsigned int peripheries;
 		char style[DOT_MAX_STYLE_SIZE];
 		char shape[DOT_MAX_SHAPE_SIZE];
 		char label[DOT_MAX_LABEL_SIZE];
-		Edge edges[DOT_MAX_EDGES];
+		Edge* edges;
 		unsigned int nEdges;
+		unsigned int edgeCapacity;
 	} Node;
 	#define ASSERT_NODE(node)									\
 		ASSERT_NOT_NULL(node);									\
+		ASSERT_NOT_NULL(node->name);							\
 		ASSERT_NOT_EMPTY(node->name);							\
-		ASSERT_NOT_TOO_LONG(node->name, DOT_MAX_NAME_SIZE);		\
 		ASSERT_NOT_TOO_LONG(node->label, DOT_MAX_LABEL_SIZE);	\
-		ASSERT_FITS_IN_BOUND(node->id, DOT_MAX_NODES);			\
-		ASSERT_FITS_IN_BOUND(node->nEdges, DOT_MAX_EDGES)
+		ASSERT_FITS_IN_BOUND(node->nEdges, node->edgeCapacity + 1)
 
 	/** \brief A SubGraph is a cluster in a Graph.
 	 **/
@@ -211,24 +214,28 @@
 		ASSERT_FITS_IN_BOUND(cluster->nChildren, DOT_MAX_CLUSTER_CHILDREN)
 
 	/** \brief A Graph is an array of Node objects.
+	 **
+	 ** The nodes and their edges are allocated from an Arena, which frees them all at once.
 	 **/
 	typedef struct DirectedGraphBody {
 		char name[DOT_MAX_NAME_SIZE];
 		SubGraph clusters[DOT_MAX_CLUSTERS];
 		unsigned int nClusters;
-		Node nodes[DOT_MAX_NODES];
+		Node* nodes;
 		unsigned int size;
+		unsigned int capacity;
+		Arena* arena;
 	} Graph, DirectedGraph;
 	#define ASSERT_GRAPH(graph) 									\
 		ASSERT_NOT_NULL(graph); 									\
 		ASSERT_NOT_EMPTY(graph->name);								\
 		ASSERT_NOT_TOO_LONG(graph->name, DOT_MAX_NAME_SIZE);		\
-		ASSERT_FITS_IN_BOUND(graph->size, DOT_MAX_NODES);			\
+		ASSERT_FITS_IN_BOUND(graph->size, graph->capacity + 1);	\
 		ASSERT_FITS_IN_BOUND(graph->nClusters, DOT_MAX_CLUSTERS)
 
 	char* toLabel_dot(char*, const char*);
 	Graph* beautify_dot(Graph*);
-	Graph* initialize_dot(Graph*);
+	Graph* initialize_dot(Graph*, Arena*);
 	Graph* fromStream_dot(Graph*, FILE*);
 	Graph* fromFile_dot(Graph*, const char*);
 	SubGraph* insertCluster_dot(Graph*, const SubGraphId);
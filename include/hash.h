@@ -1,8 +1,10 @@
 /** \file hash.h
  ** \brief Declares a string hashing function.
- ** \related HashTable
+ ** \related InternTable
  **/
 #ifndef HASH_H
 	#define HASH_H
+	#include <stddef.h>
 	unsigned long hash(const char*);
+	unsigned long hashSlice(const char*, const size_t);
 #endif
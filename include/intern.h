@@ -0,0 +1,47 @@
+/** \file intern.h
+ ** \brief Defines InternTable and declares its member functions.
+ **/
+#ifndef INTERN_H
+	#define INTERN_H
+	#include <stddef.h>
+	#include "arena.h"
+	#include "debug.h"
+
+	#ifndef INTERN_INITIAL_CAPACITY
+		#define INTERN_INITIAL_CAPACITY 16
+	#endif
+	#ifndef INTERN_NONE
+		#define INTERN_NONE ((InternId)-1)
+	#endif
+
+	/** \brief A dense integer standing for an interned string.
+	 **/
+	typedef unsigned int InternId;
+
+	/** \brief An InternTable keeps one copy of every distinct string and numbers them 0, 1, 2...
+	 **
+	 ** The strings live in an Arena, so the pointers handed out never move and two strings
+	 ** interned in the same InternTable are equal iff their InternId values are equal.
+	 ** The slots hold InternId values and are probed linearly; the hashes are kept
+	 ** per InternId so that growing never hashes a string again.
+	 **/
+	typedef struct InternTableBody {
+		Arena* arena;
+		const char** strings;
+		unsigned long* hashes;
+		unsigned int nStrings;
+		unsigned int stringCapacity;
+		InternId* slots;
+		unsigned int capacity;
+	} InternTable;
+
+	#define ASSERT_INTERNTABLE(table)									\
+		ASSERT_NOT_NULL(table);											\
+		ASSERT_ARENA(table->arena);										\
+		ASSERT_FITS_IN_BOUND(table->nStrings, table->capacity / 2 + 1)
+
+	InternTable* initialize_it(InternTable*, Arena*);
+	InternId intern_it(InternTable*, const char*, const size_t);
+	InternId find_it(const InternTable*, const char*, const size_t);
+	const char* toString_it(const InternTable*, const InternId);
+#endif
@@ -0,0 +1,41 @@
+/** \file jit.h
+ ** \brief Defines DFAJit and declares its member functions.
+ **/
+#ifndef JIT_H
+	#define JIT_H
+	#include <stddef.h>
+	#include "dfa.h"
+	#include "match.h"
+
+	#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+		#define DFA_JIT_X86_64
+	#endif
+
+	/** \brief The signature of a compiled DFAJit, that of the C emitted for DFA_SIGNATURE_BUFFER.
+	 **/
+	typedef int (*DFAJitFunction)(const unsigned char*, size_t);
+
+	/** \brief A DFAJit runs a DeterministicFiniteAutomaton as x86-64 machine code, built in process.
+	 **
+	 ** Every open state becomes a block of code that reads one byte, maps it to
+	 ** its byte class and jumps through the block's own table of addresses, one
+	 ** per class. Dead and universal states return at once, like in the emitted C.
+	 ** The code lives in an executable mapping of size bytes and is called through
+	 ** function. On other architectures, or if the mapping fails, function is NULL
+	 ** and matcher interprets the table instead; match_dfaj() works either way.
+	 ** A DFAJit does NOT refer to its DFA once it is initialized.
+	 **/
+	typedef struct DFAJitBody {
+		DFAJitFunction function;
+		unsigned char* code;
+		size_t size;
+		DFAMatcher matcher;
+	} DFAJit;
+	#define ASSERT_DFAJIT(jit)											\
+		ASSERT_NOT_NULL(jit);											\
+		errorUnless(jit->function || jit->matcher.table, MSG_ERROR_NULL(jit->function))
+
+	DFAJit* initialize_dfaj(DFAJit*, const DeterministicFiniteAutomaton*);
+	void finalize_dfaj(DFAJit*);
+	int match_dfaj(const DFAJit*, const char*, const size_t);
+#endif
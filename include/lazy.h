@@ -0,0 +1,54 @@
+/** \file lazy.h
+ ** \brief Defines LazyDFA and declares its member functions.
+ **/
+#ifndef LAZY_H
+	#define LAZY_H
+	#include <stddef.h>
+	#include "dfa.h"
+	#include "nfa.h"
+
+	#ifndef LAZY_DFA_BUDGET
+		#define LAZY_DFA_BUDGET (1UL << 20)
+	#endif
+	#ifndef LAZY_DFA_MIN_STATES
+		#define LAZY_DFA_MIN_STATES 4
+	#endif
+	#ifndef LAZY_DFA_UNKNOWN
+		#define LAZY_DFA_UNKNOWN (DFA_NO_STATE - 1)
+	#endif
+
+	/** \brief A LazyDFA runs a NondeterministicFiniteAutomaton as a DFA whose states are built while matching.
+	 **
+	 ** The states are the closed sets of NFA states met so far, kept in cache and
+	 ** numbered like its sets; state 0 is the closure of the initial NFA state.
+	 ** The table has one row of nClasses entries per state, each the next state,
+	 ** DFA_NO_STATE for the empty set or LAZY_DFA_UNKNOWN if not built yet. A
+	 ** missing entry is built from the NFAIndex on first use. The cache holds at
+	 ** most maxStates states, fitting the memory budget given at initialization;
+	 ** when it is full, it is flushed and restarts with the initial state and the
+	 ** current one. nHits counts the entries found built, nMisses those built,
+	 ** nFlushes the flushes. A LazyDFA does NOT refer to its NFA once it is initialized.
+	 **/
+	typedef struct LazyDFABody {
+		NFAIndex index[1];
+		NFASubsets cache[1];
+		unsigned int maxStates;
+		DFAStateId* table;
+		unsigned char* isAccept;
+		unsigned long* initial;
+		unsigned long* scratch;
+		unsigned long nHits;
+		unsigned long nMisses;
+		unsigned long nFlushes;
+	} LazyDFA;
+	#define ASSERT_LAZYDFA(lazy)										\
+		ASSERT_NOT_NULL(lazy);											\
+		ASSERT_NOT_NULL(lazy->table);									\
+		ASSERT_NOT_NULL(lazy->isAccept);								\
+		ASSERT_NOT_ZERO(lazy->cache->nSets);							\
+		ASSERT_FITS_IN_BOUND(lazy->cache->nSets, lazy->maxStates + 1)
+
+	LazyDFA* initialize_ldfa(LazyDFA*, const NondeterministicFiniteAutomaton*, const size_t);
+	void finalize_ldfa(LazyDFA*);
+	int match_ldfa(LazyDFA*, const char*, const size_t);
+#endif
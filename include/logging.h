@@ -14,8 +14,8 @@
 	void writeLog(const char* format, ...);
 	void vSay(const char*, va_list);
 	void say(const char*, ...);
-	static void (*vWarning)(const char*, va_list) = &vSay;
-	static void (*warning)(const char*, ...) = &say;
+	#define vWarning vSay
+	#define warning say
 	void vWarningIf(const int, const char*, va_list);
 	void warningIf(const int, const char*, ...);
 	void vWarningUnless(const int, const char*, va_list);
@@ -0,0 +1,60 @@
+/** \file match.h
+ ** \brief Defines DFAMatcher and declares the runtime matching functions.
+ **/
+#ifndef MATCH_H
+	#define MATCH_H
+	#include <stddef.h>
+	#include "dfa.h"
+
+	#ifndef DFA_PARALLEL_MIN_CHUNK
+		#define DFA_PARALLEL_MIN_CHUNK 65536
+	#endif
+	#ifndef DFA_PARALLEL_MERGE_SIZE
+		#define DFA_PARALLEL_MERGE_SIZE 4096
+	#endif
+	#ifndef DFA_NO_MATCH
+		#define DFA_NO_MATCH ((size_t)-1)
+	#endif
+
+	/** \brief A DFAMatcher runs a DeterministicFiniteAutomaton in process, without generating C.
+	 **
+	 ** The transitions are compacted to one row of nClasses entries per state, using the byte
+	 ** classes of the DFA. The last two rows are terminal: universalStateId accepts whatever
+	 ** follows and deadStateId rejects whatever follows. Every transition to a universal state
+	 ** of the DFA leads to the former, every missing transition or transition to a dead state
+	 ** leads to the latter, so scans stop as soon as the state id reaches universalStateId. States with a large self-loop have a
+	 ** non-empty DFASelfLoop in loops, match_dfam() skips its bytes with vector instructions.
+	 ** When compiled for SSSE3 and nStates is at most DFA_SHUFFLE_STATES, shuffles holds one
+	 ** 16-byte vector per class, mapping every state to its successor, and the scans advance
+	 ** all states at once with one pshufb per byte; shuffles is NULL otherwise.
+	 ** A DFAMatcher does NOT refer to its DFA once it is initialized.
+	 **/
+	typedef struct DFAMatcherBody {
+		unsigned char classOf[DFA_MAX_SYMBOLS];
+		unsigned int nClasses;
+		unsigned int nStates;
+		DFAStateId initialStateId;
+		DFAStateId universalStateId;
+		DFAStateId deadStateId;
+		DFAStateId* table;
+		unsigned char* isAccept;
+		DFASelfLoop* loops;
+		unsigned char* shuffles;
+	} DFAMatcher;
+	#define ASSERT_DFAMATCHER(matcher)									\
+		ASSERT_NOT_NULL(matcher);										\
+		ASSERT_NOT_NULL(matcher->table);								\
+		ASSERT_NOT_NULL(matcher->isAccept);								\
+		ASSERT_NOT_NULL(matcher->loops);								\
+		ASSERT_FITS_IN_BOUND(matcher->initialStateId, matcher->nStates)
+
+	DFAMatcher* initialize_dfam(DFAMatcher*, const DeterministicFiniteAutomaton*);
+	void finalize_dfam(DFAMatcher*);
+	int match_dfam(const DFAMatcher*, const char*, const size_t);
+	int matchParallel_dfam(const DFAMatcher*, const char*, const size_t, unsigned int);
+	void matchBatch_dfam(const DFAMatcher*, const char* const*, const size_t*, const size_t, unsigned char*);
+	size_t longestPrefix_dfam(const DFAMatcher*, const char*, const size_t);
+	size_t findAll_dfam(const DFAMatcher*, const char*, const size_t, size_t*, const size_t);
+
+	int match_dfa(const DeterministicFiniteAutomaton*, const char*, const size_t);
+#endif
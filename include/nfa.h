@@ -0,0 +1,144 @@
+/** \file nfa.h
+ ** \brief Defines NondeterministicFiniteAutomaton and declares its member functions.
+ **/
+#ifndef NFA_H
+	#define NFA_H
+	#include <limits.h>
+	#include <stddef.h>
+	#include <stdio.h>
+	#include "dfa.h"
+
+	typedef unsigned int NFAStateId;
+
+	#ifndef NFA_INITIAL_CAPACITY
+		#define NFA_INITIAL_CAPACITY 16
+	#endif
+	#ifndef NFA_MAX_REPEAT
+		#define NFA_MAX_REPEAT 1000
+	#endif
+	#ifndef NFA_SET_SIZE
+		#define NFA_SET_SIZE (DFA_MAX_SYMBOLS / 8)
+	#endif
+	#ifndef NFA_NO_STATE
+		#define NFA_NO_STATE ((NFAStateId)-1)
+	#endif
+
+	/** \brief The number of states in a word of a state set.
+	 **/
+	#define NFA_WORD_BITS (CHAR_BIT * sizeof(unsigned long))
+
+	/** \brief Checks whether a state set holds a state.
+	 **/
+	#define NFA_HAS_STATE(set,q) ((set)[(q) / NFA_WORD_BITS] & (1UL << ((q) % NFA_WORD_BITS)))
+
+	/** \brief Adds a state to a state set.
+	 **/
+	#define NFA_ADD_STATE(set,q) ((set)[(q) / NFA_WORD_BITS] |= 1UL << ((q) % NFA_WORD_BITS))
+
+	/** \brief An edge of an NFA, taken on any byte of a set, or on no input at all if isEpsilon.
+	 **
+	 ** Byte b is in the set iff bit b % 8 of bytes[b / 8] is set. NUL is never in the set.
+	 **/
+	typedef struct NFAEdgeBody {
+		NFAStateId sourceId;
+		NFAStateId sinkId;
+		unsigned char bytes[NFA_SET_SIZE];
+		int isEpsilon;
+	} NFAEdge;
+
+	/** \brief An NFA with epsilon edges and edges on sets of bytes.
+	 **
+	 ** The states are numbered 0, 1, 2... and only hold their acceptance, the
+	 ** edges are kept in one array in insertion order. The alphabet is empty
+	 ** unless it is declared, then it holds at least the bytes of the edges.
+	 **/
+	typedef struct NondeterministicFiniteAutomatonBody {
+		char name[DFA_MAX_NAME_SIZE];
+		char alphabet[DFA_MAX_SYMBOLS];
+		unsigned char* isAccept;
+		unsigned int nStates;
+		unsigned int stateCapacity;
+		NFAStateId initialStateId;
+		NFAEdge* edges;
+		unsigned int nEdges;
+		unsigned int edgeCapacity;
+	} NondeterministicFiniteAutomaton;
+	#define ASSERT_NFA(nfa)												\
+		ASSERT_NOT_NULL(nfa);											\
+		ASSERT_NOT_EMPTY(nfa->name);									\
+		ASSERT_FITS_IN_BOUND(nfa->nStates, nfa->stateCapacity + 1);	\
+		ASSERT_FITS_IN_BOUND(nfa->nEdges, nfa->edgeCapacity + 1)
+
+	/** \brief The edges of a NondeterministicFiniteAutomaton, indexed for moving sets of states by byte class.
+	 **
+	 ** The bytes are split into nClasses classes that no edge tells apart, class 0
+	 ** holding NUL and the bytes of no edge. Sets of states are bitsets of nWords
+	 ** unsigned long words. The byte edges of state q are byteStart[q] to
+	 ** byteStart[q + 1] - 1, edge j enters byteSinks[j] on the classes
+	 ** classes[classStart[j]] to classes[classStart[j + 1] - 1], in increasing
+	 ** order. The epsilon edges are laid out likewise, and stack has room for
+	 ** one id per state. A NFAIndex does NOT refer to its NFA once it is initialized.
+	 **/
+	typedef struct NFAIndexBody {
+		unsigned char classOf[DFA_MAX_SYMBOLS];
+		unsigned int nClasses;
+		unsigned int nStates;
+		unsigned int nWords;
+		NFAStateId initialStateId;
+		unsigned long* accepting;
+		unsigned int* byteStart;
+		NFAStateId* byteSinks;
+		unsigned int* classStart;
+		unsigned int* classes;
+		unsigned int* epsilonStart;
+		NFAStateId* epsilonSinks;
+		NFAStateId* stack;
+	} NFAIndex;
+	#define ASSERT_NFAINDEX(index)										\
+		ASSERT_NOT_NULL(index);											\
+		ASSERT_NOT_NULL(index->accepting);								\
+		ASSERT_NOT_NULL(index->stack);									\
+		ASSERT_FITS_IN_BOUND(index->nClasses, DFA_MAX_SYMBOLS + 1)
+
+	/** \brief The distinct sets of NFA states met by a subset construction, numbered 0, 1, 2...
+	 **
+	 ** Every set is a bitset of nWords words, stored one after the other in sets.
+	 ** The slots hold set ids and are probed linearly; the hashes are kept per
+	 ** set so that growing never hashes a set again.
+	 **/
+	typedef struct NFASubsetsBody {
+		unsigned int nWords;
+		unsigned long* sets;
+		unsigned long* hashes;
+		unsigned int nSets;
+		unsigned int setCapacity;
+		DFAStateId* slots;
+		unsigned int capacity;
+	} NFASubsets;
+	#define ASSERT_NFASUBSETS(subsets)									\
+		ASSERT_NOT_NULL(subsets);										\
+		ASSERT_NOT_NULL(subsets->slots);								\
+		ASSERT_FITS_IN_BOUND(subsets->nSets, subsets->setCapacity + 1)
+
+	NondeterministicFiniteAutomaton* initialize_nfa(NondeterministicFiniteAutomaton*);
+	void finalize_nfa(NondeterministicFiniteAutomaton*);
+	NFAStateId insertState_nfa(NondeterministicFiniteAutomaton*, const int);
+	void insertEdge_nfa(NondeterministicFiniteAutomaton*, const NFAStateId, const NFAStateId, const unsigned char*);
+	NondeterministicFiniteAutomaton* fromRegex_nfa(NondeterministicFiniteAutomaton*, const char*);
+	NondeterministicFiniteAutomaton* fromStream_nfa(NondeterministicFiniteAutomaton*, FILE*);
+	NondeterministicFiniteAutomaton* fromFile_nfa(NondeterministicFiniteAutomaton*, const char*);
+	DeterministicFiniteAutomaton* toDfa_nfa(DeterministicFiniteAutomaton*, const NondeterministicFiniteAutomaton*);
+
+	NFAIndex* initialize_nfai(NFAIndex*, const NondeterministicFiniteAutomaton*);
+	void finalize_nfai(NFAIndex*);
+	void close_nfai(NFAIndex*, unsigned long*);
+	void move_nfai(NFAIndex*, const unsigned long*, const unsigned int, unsigned long*);
+	int isAccept_nfai(const NFAIndex*, const unsigned long*);
+	int isEmpty_nfai(const NFAIndex*, const unsigned long*);
+
+	NFASubsets* initialize_nfas(NFASubsets*, const unsigned int, const unsigned int);
+	void finalize_nfas(NFASubsets*);
+	void clear_nfas(NFASubsets*);
+	DFAStateId find_nfas(const NFASubsets*, const unsigned long*);
+	DFAStateId intern_nfas(NFASubsets*, const unsigned long*);
+#endif
@@ -4,70 +4,91 @@
 #ifndef XML_H
 	#define XML_H
 	#include <stdio.h>
+	#include "arena.h"
 	#include "constants.h"
-	#include "list.h"
+	#include "intern.h"
 
+	/** \brief An XmlAttribute is a name-value pair of an XmlNode.
+	 **/
 	typedef struct XmlAttributeBody {
-		char name[XML_MAX_ATTRIBUTE_NAME_SIZE];
-		char value[XML_MAX_ATTRIBUTE_VAL_SIZE];
+		char* name;
+		char* value;
 	} XmlAttribute;
-	XmlAttribute* initialize_xattr(XmlAttribute*, const char*, const char*);
+	XmlAttribute* initialize_xattr(XmlAttribute*, Arena*, const char*, const char*);
 	char* toString_xattr(char*, const XmlAttribute*);
 
-	#define ASSERT_XMLATTRIBUTE(attribute)									\
-		ASSERT_NOT_NULL(attribute);											\
-		ASSERT_NOT_EMPTY(attribute->name);									\
-		ASSERT_NOT_TOO_LONG(attribute->name, XML_MAX_ATTRIBUTE_NAME_SIZE);	\
-		ASSERT_NOT_TOO_LONG(attribute->value, XML_MAX_ATTRIBUTE_VAL_SIZE)
-
-	DECLARE_ARRAY_OF(XmlAttribute,XML_MAX_ATTRIBUTES,size,array,xattra);
-	DECLARE_LIST_OF(XmlAttribute,XML_MAX_ATTRIBUTES,size,list,xattrl);
-
-	#define ASSERT_XMLATTRIBUTEARRAY(array)				\
-		ASSERT_ARRAY(array,size,XML_MAX_ATTRIBUTES)
-	#define ASSERT_XMLATTRIBUTELIST(list)				\
-		ASSERT_LIST(list,size,XML_MAX_ATTRIBUTES)
+	#define ASSERT_XMLATTRIBUTE(attribute)		\
+		ASSERT_NOT_NULL(attribute);				\
+		ASSERT_NOT_NULL(attribute->name);		\
+		ASSERT_NOT_EMPTY(attribute->name);		\
+		ASSERT_NOT_NULL(attribute->value)
 
+	/** \brief An XmlNode is an element of an Xml tree.
+	 **
+	 ** content[i] is the text before children[i], and content[nChildren] is the text
+	 ** after the last child. Empty content is NULL. Everything is allocated from
+	 ** the Arena of the Xml and sized to the actual input. The tag is interned in
+	 ** the Xml, so nodes with the same tag share it and have the same tagId.
+	 **/
 	typedef struct XmlNodeBody {
 		struct XmlNodeBody* parent;
-		char tag[XML_MAX_TAG_SIZE];
-		char content[XML_MAX_CHILDREN+1][XML_MAX_CONTENT_SIZE];
-		struct XmlNodeBody* children[XML_MAX_CHILDREN];
+		const char* tag;
+		InternId tagId;
+		char** content;
+		struct XmlNodeBody** children;
 		unsigned int nChildren;
-		XmlAttributeArray attributes[1];
+		unsigned int childCapacity;
+		XmlAttribute* attributes;
+		unsigned int nAttributes;
+		unsigned int attributeCapacity;
 	} XmlNode;
-	XmlNode* initialize_xmln(XmlNode*, XmlNode*);
+	XmlNode* initialize_xmln(XmlNode*, Arena*, XmlNode*);
+	const char* getContent_xmln(const XmlNode*, const unsigned int);
 	char* toString_xmln(char*, const XmlNode*);
 	char* toContent_xmln(char*, const XmlNode*);
 
-	#define ASSERT_XMLNODE(node)									\
-		ASSERT_NOT_NULL(node);										\
-		ASSERT_NOT_EMPTY(node->tag);								\
-		ASSERT_NOT_TOO_LONG(node->tag, XML_MAX_TAG_SIZE);			\
-		ASSERT_FITS_IN_BOUND(node->nChildren, XML_MAX_CHILDREN);	\
-		ASSERT_XMLATTRIBUTEARRAY(node->attributes)
-
-	DECLARE_ARRAY_OF(XmlNode,XML_MAX_NODES,size,nodes,xmlna);
-	DECLARE_LIST_OF(XmlNode,XML_MAX_NODES,size,nodes,xmlnl);
-
-	#define ASSERT_XMLNODEARRAY(array)	\
-		ASSERT_ARRAY(array,size,XML_MAX_NODES)
-	#define ASSERT_XMLNODELIST(list)	\
-		ASSERT_LIST(list,size,XML_MAX_NODES)
+	#define ASSERT_XMLNODE(node)										\
+		ASSERT_NOT_NULL(node);											\
+		ASSERT_NOT_NULL(node->tag);										\
+		ASSERT_NOT_EMPTY(node->tag);									\
+		ASSERT_FITS_IN_BOUND(node->nChildren, node->childCapacity + 1);	\
+		ASSERT_FITS_IN_BOUND(node->nAttributes, node->attributeCapacity + 1)
 
+	/** \brief An Xml is a tree of XmlNode objects living in an Arena.
+	 **/
 	typedef struct XmlBody {
-		char meta[XML_META_MAX_SIZE];
-		XmlNodeArray tree[1];
+		char* meta;
+		XmlNode* root;
+		unsigned int nNodes;
+		Arena* arena;
+		InternTable tags[1];
 	} Xml;
 
-	#define ASSERT_XML(xml)									\
-		ASSERT_NOT_NULL(xml);								\
-		ASSERT_NOT_TOO_LONG(xml->meta, XML_META_MAX_SIZE);	\
-		ASSERT_XMLNODEARRAY(xml->tree)
+	#define ASSERT_XML(xml)				\
+		ASSERT_NOT_NULL(xml);			\
+		ASSERT_NOT_NULL(xml->meta);		\
+		ASSERT_ARENA(xml->arena)
+
+	/** \brief Callbacks of the event-driven Xml reader.
+	 **
+	 ** Every string is a (pointer, length) slice that is only valid during the callback.
+	 ** Any callback may be NULL. The text of an element may arrive in several pieces.
+	 **/
+	typedef struct XmlHandlerBody {
+		void (*meta)(void*, const char*, const size_t);
+		void (*startTag)(void*, const char*, const size_t);
+		void (*attribute)(void*, const char*, const size_t, const char*, const size_t);
+		void (*text)(void*, const char*, const size_t);
+		void (*endTag)(void*, const char*, const size_t);
+	} XmlHandler;
+
+	void parseString_xml(const char*, const size_t, const XmlHandler*, void*);
+	void parseStream_xml(FILE*, const XmlHandler*, void*);
+	void parseFile_xml(const char*, const XmlHandler*, void*);
 
-	Xml* initialize_xml(Xml*);
-	Xml* fromString_xml(Xml*, const char*);
-	Xml* fromStream_xml(Xml*, FILE*);
-	Xml* fromFile_xml(Xml*, const char*);
+	Xml* initialize_xml(Xml*, Arena*);
+	Xml* fromString_xml(Xml*, Arena*, const char*);
+	Xml* fromStream_xml(Xml*, Arena*, FILE*);
+	Xml* fromFile_xml(Xml*, Arena*, const char*);
 	char* toString_xml(char*, const Xml*);
 #endif
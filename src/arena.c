@@ -0,0 +1,186 @@
+/** \file arena.c
+ ** \brief Implements Arena and its member functions.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "debug.h"
+#include "stdlibplus.h"
+#include "unless.h"
+
+DECLARE_SOURCE("ARENA");
+
+/** \brief The offset of the first usable byte of an ArenaBlock.
+ **/
+#define ARENA_HEADER_SIZE ARENA_ROUND_UP(sizeof(ArenaBlock))
+
+/** \brief Returns the first usable byte of an ArenaBlock.
+ **/
+#define ARENA_DATA(block) ((char*)(block) + ARENA_HEADER_SIZE)
+
+/** \brief Initializes a given Arena or creates it from scratch.
+ ** \param arena The Arena
+ ** \returns A pointer to the Arena.
+ ** \memberof Arena
+ **
+ ** No memory is reserved until the first allocation.
+ **/
+Arena* initialize_arena(Arena* arena)
+{
+	DECLARE_FUNCTION(initialize_arena);
+
+	unless (arena)
+		SAFE_MALLOC(arena, Arena, 1);
+
+	arena->head = NULL;
+	arena->nBytes = 0;
+
+	return arena;
+}
+
+/** \brief Frees every object allocated from an Arena.
+ ** \param arena The Arena
+ ** \memberof Arena
+ **
+ ** The Arena itself is NOT freed and may be used again.
+ **/
+void finalize_arena(Arena* arena)
+{
+	DECLARE_FUNCTION(finalize_arena);
+
+	/* Variable declaration. */
+	ArenaBlock* block;
+
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	while (arena->head) {
+		block = arena->head;
+		arena->head = block->next;
+		free(block);
+	}
+	arena->nBytes = 0;
+}
+
+/** \brief Allocates an aligned object from an Arena.
+ ** \param arena The Arena
+ ** \param size The size of the object in bytes
+ ** \returns A pointer to the object.
+ ** \memberof Arena
+ **
+ ** Objects larger than a quarter of ARENA_BLOCK_SIZE get a block of their own,
+ ** placed behind the current block so that it keeps serving small objects.
+ **/
+void* allocate_arena(Arena* arena, const size_t size)
+{
+	DECLARE_FUNCTION(allocate_arena);
+
+	/* Variable declarations. */
+	size_t alignedSize, capacity;
+	ArenaBlock* block;
+	void* ptr;
+
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	alignedSize = ARENA_ROUND_UP(size ? size : 1);
+
+	/* The common case: bump the current block. */
+	block = arena->head;
+	if (block && block->capacity - block->size >= alignedSize) {
+		ptr = ARENA_DATA(block) + block->size;
+		block->size += alignedSize;
+		arena->nBytes += alignedSize;
+		return ptr;
+	}
+
+	capacity = alignedSize > ARENA_BLOCK_SIZE / 4 ? alignedSize : ARENA_BLOCK_SIZE;
+	block = malloc(ARENA_HEADER_SIZE + capacity);
+	ASSERT_NOT_NULL(block);
+	block->capacity = capacity;
+	block->size = alignedSize;
+
+	if (capacity == alignedSize && arena->head) {
+		/* A dedicated block goes behind the current one. */
+		block->next = arena->head->next;
+		arena->head->next = block;
+	} else {
+		block->next = arena->head;
+		arena->head = block;
+	}
+
+	arena->nBytes += alignedSize;
+	return ARENA_DATA(block);
+}
+
+/** \brief Resizes an object allocated from an Arena.
+ ** \param arena The Arena
+ ** \param ptr The object, NULL to allocate a new one
+ ** \param oldSize The current size of the object in bytes
+ ** \param size The new size of the object in bytes
+ ** \returns A pointer to the resized object.
+ ** \memberof Arena
+ **
+ ** The most recent object of the current block grows in place when there is room;
+ ** any other object is copied, and its old memory is only reclaimed by finalize_arena.
+ **/
+void* reallocate_arena(Arena* arena, void* ptr, const size_t oldSize, const size_t size)
+{
+	DECLARE_FUNCTION(reallocate_arena);
+
+	/* Variable declarations. */
+	size_t alignedOldSize, alignedSize;
+	ArenaBlock* block;
+	void* newPtr;
+
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	unless (ptr)
+		return allocate_arena(arena, size);
+
+	alignedOldSize = ARENA_ROUND_UP(oldSize ? oldSize : 1);
+	alignedSize = ARENA_ROUND_UP(size ? size : 1);
+
+	/* Grow or shrink in place if the object is the last one of the current block. */
+	block = arena->head;
+	if (
+		block
+		&& (char*)ptr + alignedOldSize == ARENA_DATA(block) + block->size
+		&& block->capacity - (block->size - alignedOldSize) >= alignedSize
+	) {
+		block->size = block->size - alignedOldSize + alignedSize;
+		arena->nBytes = arena->nBytes - alignedOldSize + alignedSize;
+		return ptr;
+	}
+
+	newPtr = allocate_arena(arena, size);
+	memcpy(newPtr, ptr, oldSize < size ? oldSize : size);
+
+	return newPtr;
+}
+
+/** \brief Copies a slice into a NUL-terminated string allocated from an Arena.
+ ** \param arena The Arena
+ ** \param str The slice
+ ** \param len The length of the slice
+ ** \returns A pointer to the string.
+ ** \memberof Arena
+ **/
+char* fromSlice_arena(Arena* arena, const char* str, const size_t len)
+{
+	DECLARE_FUNCTION(fromSlice_arena);
+
+	/* Variable declaration. */
+	char* copy;
+
+	/* Checks. */
+	ASSERT_ARENA(arena);
+	ASSERT_NOT_NULL(str);
+
+	SAFE_ARENA_MALLOC(copy, arena, char, len + 1);
+	memcpy(copy, str, len);
+	copy[len] = '\0';
+
+	return copy;
+}
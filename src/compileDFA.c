@@ -1,54 +1,243 @@
 /** \file compileDFA.c
  **/
+#include "arena.h"
 #include "constants.h"
 #include "debug.h"
 #include "dfa.h"
 #include "dot.h"
-#include "hashtable.h"
 #include "logging.h"
+#include "nfa.h"
 #include "stdioplus.h"
 #include "stringplus.h"
 #include "xml.h"
 
 DECLARE_SOURCE("compileDFA");
 
+#ifndef COMPILEDFA_USAGE
+	#define COMPILEDFA_USAGE "Usage: compileDFA.out [--goto|--computed-goto|--table|--shuffle] [--length|--batch] [--minimize] [--nfa] [--intersect|--union|--difference|--xor] [--complement] [-e <regex>] [<input>.xml...] <output>.[dot|c|hpp]\n       compileDFA.out [--nfa] --equivalent|--included [-e <regex>] <input>.xml [<input>.xml]"
+#endif
+
+/** \brief Reads an operand, a regex or an XML file, into a DeterministicFiniteAutomaton.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param pattern The regex, NULL to read the file
+ ** \param input The file, a <dfa>, or a <nfa> if isNondeterministic
+ ** \param isNondeterministic Whether the file holds a <nfa>
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ **/
+DeterministicFiniteAutomaton* private_read_compileDFA(DeterministicFiniteAutomaton* dfa, const char* pattern, const char* input, const int isNondeterministic)
+{
+	DECLARE_FUNCTION(private_read_compileDFA);
+
+	/* Variable declaration. */
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+
+	if (pattern || isNondeterministic) {
+		nfa = pattern ? fromRegex_nfa(nfa, pattern) : fromFile_nfa(nfa, input);
+		ASSERT_NFA(nfa);
+		dfa = toDfa_nfa(dfa, nfa);
+		finalize_nfa(nfa);
+	} else
+		dfa = fromFile_dfa(dfa, input);
+
+	ASSERT_DFA(dfa);
+	return dfa;
+}
+
+/** \brief Spells a string printable, writing every other byte, backslash and double quote as \\xHH.
+ ** \param buffer The buffer, with room for capacity bytes
+ ** \param capacity The capacity of the buffer, at least 4; longer spellings are cut short with "..."
+ ** \param str The string
+ ** \returns A pointer to the buffer.
+ **/
+char* private_escape_compileDFA(char* buffer, const size_t capacity, const char* str)
+{
+	/* Variable declarations. */
+	static const char digits[] = "0123456789ABCDEF";
+	unsigned char c;
+	size_t n;
+
+	for (n = 0; *str; str++) {
+		c = (unsigned char)*str;
+		if (n + (c < ' ' || c > '~' || c == '\\' || c == '"' ? 4 : 1) + 4 > capacity) {
+			strcpy(buffer + n, "...");
+			return buffer;
+		}
+		if (c < ' ' || c > '~' || c == '\\' || c == '"') {
+			buffer[n++] = '\\';
+			buffer[n++] = 'x';
+			buffer[n++] = digits[c >> 4];
+			buffer[n++] = digits[c & 0xF];
+		} else
+			buffer[n++] = (char)c;
+	}
+	buffer[n] = '\0';
+
+	return buffer;
+}
+
 int main(int argc, char* argv[])
 {
 	DECLARE_FUNCTION(main);
 
-	char buffer[BUFFER_LARGE_SIZE], *str = buffer;
-	Graph gBuffer, *G = &gBuffer;
+	int i, nOperands;
+	const char* output;
+	const char* pattern;
+	char* counterexample;
+	char escaped[LOG_SAY_MAX / 2];
+	Graph* G;
 	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
-	FILE* fp;
+	DeterministicFiniteAutomaton oBuffer, *operand = &oBuffer;
+	DeterministicFiniteAutomaton pBuffer, *product = &pBuffer;
+	DeterministicFiniteAutomaton* swap;
+	Arena aBuffer, *arena = &aBuffer;
+	DFABackend backend;
+	DFASignature signature;
+	int isMinimizing;
+	int isNondeterministic;
+	int isComplementing;
+	int isCombining;
+	int isCheckingEquivalence;
+	int isCheckingInclusion;
+	int isHolding;
+	DFAOperation operation;
 
 	start_logging();
 
-	say(MSG_REPORT_VAR("sizeof(DeterministicFiniteAutomaton)", "%luK", sizeof(DeterministicFiniteAutomaton)/1024));
-	say(MSG_REPORT_VAR("sizeof(Graph)", "%luK", sizeof(Graph)/1024));
-	say(MSG_REPORT_VAR("sizeof(HashTable)", "%luM", sizeof(HashTable)/1024/1024));
-	say(MSG_REPORT_VAR("sizeof(Xml)", "%luM", sizeof(Xml)/1024/1024));
+	say(MSG_REPORT_VAR("sizeof(DeterministicFiniteAutomaton)", "%luB", sizeof(DeterministicFiniteAutomaton)));
+	say(MSG_REPORT_VAR("sizeof(Graph)", "%luB", sizeof(Graph)));
+	say(MSG_REPORT_VAR("sizeof(Xml)", "%luB", sizeof(Xml)));
 
-	if (argc < 3) {
-		say(MSG_REPORT("Usage: compileDFA.out <input>.xml <output>.[dot|c]"));
+	arena = initialize_arena(arena);
+
+	/* Parse the options. */
+	backend = DFA_BACKEND_GOTO;
+	signature = DFA_SIGNATURE_STRING;
+	isMinimizing = 0;
+	isNondeterministic = 0;
+	isComplementing = 0;
+	isCombining = 0;
+	isCheckingEquivalence = 0;
+	isCheckingInclusion = 0;
+	operation = DFA_OPERATION_INTERSECTION;
+	pattern = NULL;
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "--goto")) {
+			backend = DFA_BACKEND_GOTO;
+		} else if (!strcmp(argv[i], "--computed-goto")) {
+			backend = DFA_BACKEND_COMPUTED_GOTO;
+		} else if (!strcmp(argv[i], "--table")) {
+			backend = DFA_BACKEND_TABLE;
+		} else if (!strcmp(argv[i], "--shuffle")) {
+			backend = DFA_BACKEND_SHUFFLE;
+		} else if (!strcmp(argv[i], "--length")) {
+			signature = DFA_SIGNATURE_BUFFER;
+		} else if (!strcmp(argv[i], "--batch")) {
+			signature = DFA_SIGNATURE_BATCH;
+		} else if (!strcmp(argv[i], "--minimize")) {
+			isMinimizing = 1;
+		} else if (!strcmp(argv[i], "--nfa")) {
+			isNondeterministic = 1;
+		} else if (!strcmp(argv[i], "--intersect")) {
+			isCombining = 1;
+			operation = DFA_OPERATION_INTERSECTION;
+		} else if (!strcmp(argv[i], "--union")) {
+			isCombining = 1;
+			operation = DFA_OPERATION_UNION;
+		} else if (!strcmp(argv[i], "--difference")) {
+			isCombining = 1;
+			operation = DFA_OPERATION_DIFFERENCE;
+		} else if (!strcmp(argv[i], "--xor")) {
+			isCombining = 1;
+			operation = DFA_OPERATION_SYMMETRIC_DIFFERENCE;
+		} else if (!strcmp(argv[i], "--equivalent")) {
+			isCheckingEquivalence = 1;
+			isCheckingInclusion = 0;
+		} else if (!strcmp(argv[i], "--included")) {
+			isCheckingInclusion = 1;
+			isCheckingEquivalence = 0;
+		} else if (!strcmp(argv[i], "--complement")) {
+			isComplementing = 1;
+		} else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+			pattern = argv[++i];
+		} else {
+			warning(MSG_REPORT_VAR("Unrecognized Option", "%s", argv[i]));
+			say(MSG_REPORT(COMPILEDFA_USAGE));
+			exit(1);
+		}
+	}
+
+	/* The regex, if any, is the first operand, then come the files. */
+	if (isCheckingEquivalence || isCheckingInclusion) {
+		if (argc - i + (pattern ? 1 : 0) != 2) {
+			say(MSG_REPORT(COMPILEDFA_USAGE));
+			exit(1);
+		}
+
+		/* Checks have no output, they exit with 0 if they hold and 1 otherwise. */
+		dfa = private_read_compileDFA(dfa, pattern, pattern ? NULL : argv[i], isNondeterministic);
+		operand = private_read_compileDFA(operand, NULL, argv[argc - 1], isNondeterministic);
+		if (isCheckingEquivalence) {
+			isHolding = isEquivalent_dfa(dfa, operand, &counterexample);
+			say(MSG_REPORT_VAR("Equivalent", "%s", isHolding ? "yes" : "no"));
+		} else {
+			isHolding = isIncluded_dfa(dfa, operand, &counterexample);
+			say(MSG_REPORT_VAR("Included", "%s", isHolding ? "yes" : "no"));
+		}
+		if (counterexample) {
+			say(MSG_REPORT_VAR("Counterexample", "\"%s\"", private_escape_compileDFA(escaped, sizeof(escaped), counterexample)));
+			free(counterexample);
+		}
+
+		finalize_dfa(dfa);
+		finalize_dfa(operand);
+		finalize_arena(arena);
+		stop_logging();
+
+		return isHolding ? 0 : 1;
+	}
+
+	nOperands = argc - i - 1 + (pattern ? 1 : 0);
+	if (argc - i < 1 || nOperands < 1 || (nOperands > 1 && !isCombining)) {
+		say(MSG_REPORT(COMPILEDFA_USAGE));
 		exit(1);
 	}
+	output = argv[argc - 1];
 
-	dfa = fromFile_dfa(dfa, argv[1]);
-	ASSERT_DFA(dfa);
+	dfa = private_read_compileDFA(dfa, pattern, pattern ? NULL : argv[i], isNondeterministic);
+	for (i += pattern ? 0 : 1; i < argc - 1; i++) {
+		operand = private_read_compileDFA(operand, NULL, argv[i], isNondeterministic);
+		product = product_dfa(product, dfa, operand, operation);
+		finalize_dfa(dfa);
+		finalize_dfa(operand);
+		swap = dfa;
+		dfa = product;
+		product = swap;
+	}
+
+	if (isComplementing) {
+		dfa = complement_dfa(dfa);
+		ASSERT_DFA(dfa);
+	}
 
-	if (argv[2][strlen(argv[2])-1] == 'c') {
-		str = toC_dfa(buffer, dfa);
-		ASSERT_NOT_NULL(str);
-		ASSERT_NOT_EMPTY(str);
-		SAFE_FOPEN(fp, argv[2], "w");
-		fprintf(fp, "%s", str);
-		fclose(fp);
+	if (isMinimizing) {
+		dfa = minimize_dfa(dfa);
+		ASSERT_DFA(dfa);
+	}
+
+	if (strlen(output) > 4 && !strcmp(output + strlen(output) - 4, ".hpp")) {
+		toHppFile_dfa(dfa, output);
+	} else if (output[strlen(output)-1] == 'c') {
+		toFile_dfa(dfa, output, backend, signature);
 	} else {
-		G = toDot_dfa(G, dfa);
+		G = toDot_dfa(NULL, arena, dfa);
 		ASSERT_GRAPH(G);
-		toFile_dot(G, argv[2]);
+		toFile_dot(G, output);
 	}
 
+	finalize_dfa(dfa);
+	say(MSG_REPORT_VAR("Arena", "%luB", arena->nBytes));
+	finalize_arena(arena);
+
 	stop_logging();
 
 	return 0;
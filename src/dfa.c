@@ -1,10 +1,11 @@
 /** \file dfa.c
  ** \brief Implements the member functions of DeterministicFiniteAutomaton
  **/
+#include <ctype.h>
 #include "constants.h"
 #include "debug.h"
 #include "dfa.h"
-#include "hashtable.h"
+#include "stdioplus.h"
 #include "stringplus.h"
 #include "xml.h"
 
@@ -19,14 +20,17 @@ char* toString_dfas(char* str, const DFAState* state)
 	str = fromPattern(str, BUFFER_SIZE, "%s", state->name);
 	ASSERT_NOT_NULL(str);
 	ASSERT_NOT_EMPTY(str);
-	ASSERT_NOT_TOO_LONG(str, DFA_MAX_NAME_SIZE);
 
 	return str;
 }
 
-IMPLEMENT_ARRAY_FUNCTIONS_OF(DFAState,DFA_MAX_STATES,nStates,array,dfasa,dfas)
-IMPLEMENT_LIST_FUNCTIONS_OF(DFAState,DFA_MAX_STATES,nStates,list,array,dfasl,dfas)
-
+/** \brief Initializes a DeterministicFiniteAutomaton with no states, or creates it from scratch.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Nothing is allocated until the first state is inserted.
+ **/
 DeterministicFiniteAutomaton* initialize_dfa(DeterministicFiniteAutomaton* dfa)
 {
 	DECLARE_FUNCTION(initialize_dfa);
@@ -43,34 +47,96 @@ DeterministicFiniteAutomaton* initialize_dfa(DeterministicFiniteAutomaton* dfa)
 	ASSERT_NOT_NULL(check);
 	ASSERT_NOT_EMPTY(check);
 
-	initialize_dfasa(dfa->states);
+	dfa->states->array = NULL;
+	dfa->states->nStates = 0;
+	dfa->states->capacity = 0;
+	dfa->transitions = NULL;
 	ASSERT_DFASTATEARRAY(dfa->states);
 
 	dfa->initialStateId = DFA_DEFAULT_INITIAL_STATE_ID;
 
+	/* The state names are interned in the Arena of the DFA. */
+	initialize_arena(dfa->arena);
+	initialize_it(dfa->names, dfa->arena);
+	ASSERT_INTERNTABLE(dfa->names);
+
 	ASSERT_DFA(dfa);
 	return dfa;
 }
 
-DFAState* insertState_dfa(DeterministicFiniteAutomaton* dfa)
+/** \brief Releases the states and the transitions of a DeterministicFiniteAutomaton.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The DeterministicFiniteAutomaton itself is NOT freed, it is left with no states.
+ **/
+void finalize_dfa(DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(finalize_dfa);
+
+	ASSERT_DFA(dfa);
+
+	free(dfa->states->array);
+	free(dfa->transitions);
+	dfa->states->array = NULL;
+	dfa->states->nStates = 0;
+	dfa->states->capacity = 0;
+	dfa->transitions = NULL;
+
+	/* Forget every state name. */
+	finalize_arena(dfa->arena);
+	initialize_it(dfa->names, dfa->arena);
+}
+
+/** \brief Inserts a state with no transitions to a DeterministicFiniteAutomaton.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param name The beginning of the name, NULL for DFA_DEFAULT_STATE_NAME
+ ** \param len The length of the name
+ ** \returns A pointer to the DFAState, valid until the next insertion.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The name is interned, and it must differ from the names of the other states.
+ **/
+DFAState* insertState_dfa(DeterministicFiniteAutomaton* dfa, const char* name, const size_t len)
 {
 	DECLARE_FUNCTION(insertState_dfa);
 
-	char* check;
+	char buffer[DFA_MAX_NAME_SIZE];
+	unsigned int nNames;
+	InternId nameId;
 	DFAState* s;
+	DFAStateId* ptr;
 
 	ASSERT_DFA(dfa);
 
-	s = getNew_dfasa(dfa->states);
-	ASSERT_NOT_NULL(s);
+	/* Grow the states and the transition rows together. */
+	if (dfa->states->nStates == dfa->states->capacity) {
+		dfa->states->capacity = dfa->states->capacity ? 2 * dfa->states->capacity : DFA_INITIAL_CAPACITY;
+		SAFE_REALLOC(dfa->states->array, DFAState, dfa->states->capacity);
+		SAFE_REALLOC(dfa->transitions, DFAStateId[DFA_MAX_SYMBOLS], dfa->states->capacity);
+	}
+
+	s = dfa->states->array + dfa->states->nStates++;
 	ASSERT_DFA(dfa);
 	s->id = dfa->states->nStates - 1;
 
 	s->isAccept = DFA_DEFAULT_ACCEPT;
 
-	check = fromPattern(s->name, DFA_MAX_NAME_SIZE, DFA_DEFAULT_STATE_NAME(s->id));
-	ASSERT_NOT_NULL(check);
-	ASSERT_NOT_EMPTY(check);
+	/* Intern the name. */
+	nNames = dfa->names->nStrings;
+	if (name) {
+		nameId = intern_it(dfa->names, name, len);
+	} else {
+		name = fromPattern(buffer, DFA_MAX_NAME_SIZE, DFA_DEFAULT_STATE_NAME(s->id));
+		ASSERT_NOT_NULL(name);
+		nameId = intern_it(dfa->names, name, strlen(name));
+	}
+	s->name = toString_it(dfa->names, nameId);
+	errorUnless(nameId == nNames, MSG_ERROR_SYNTAX("Duplicate state name"));
+
+	/* No transitions, every symbol leads to rejection. */
+	for (ptr = dfa->transitions[s->id]; ptr < dfa->transitions[s->id] + DFA_MAX_SYMBOLS; ptr++)
+		*ptr = DFA_NO_STATE;
 
 	ASSERT_DFASTATE(s);
 	return s;
@@ -94,7 +160,7 @@ int insertTransition_dfa(DeterministicFiniteAutomaton* dfa, const DFAStateId sou
 	ASSERT_DFASTATE(to);
 
 	if (strchr(dfa->alphabet, with)) {
-		dfa->transitions[sourceId][(int)with] = sinkId;
+		dfa->transitions[sourceId][(unsigned char)with] = sinkId;
 		return 1;
 	} else {
 		return 0;
@@ -112,7 +178,8 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	char* alphabetEnd;
 	DFAState* s;
 	DFAStateId sourceId, sinkId;
-	const Object* obj;
+	DFAStateId* stateOf;
+	InternId statesId, initialStateId, transitionsId, acceptId, rejectId;
 	const XmlNode* root;
 	const XmlNode* node;
 	const XmlNode* from;
@@ -122,25 +189,34 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	const XmlNode* initialState;
 	const XmlNode* transitions;
 	const XmlAttribute* attribute;
-	HashTable* ht;
 
 	ASSERT_XML(xml);
 
 	dfa = initialize_dfa(dfa);
 	ASSERT_DFA(dfa);
 
-	ht = initialize_ht(NULL);
-	ASSERT_HASHTABLE(ht);
+	/* The state of every tag, by the InternId of the tag. */
+	SAFE_MALLOC(stateOf, DFAStateId, (xml->tags->nStrings + 1));
+	for (i = 0; i < xml->tags->nStrings; i++)
+		stateOf[i] = DFA_NO_STATE;
+
+	/* Resolve the section tags once, then compare InternId values. */
+	statesId = find_it(xml->tags, "states", strlen("states"));
+	initialStateId = find_it(xml->tags, "initialState", strlen("initialState"));
+	transitionsId = find_it(xml->tags, "transitions", strlen("transitions"));
+	acceptId = find_it(xml->tags, "accept", strlen("accept"));
+	rejectId = find_it(xml->tags, "reject", strlen("reject"));
 
 	/* Clear the alphabet. */
 	dfa->alphabet[0] = '\0';
 	alphabetEnd = dfa->alphabet;
 
-	root = xml->tree->nodes;
+	root = xml->root;
+	ASSERT_XMLNODE(root);
 	ASSERT_EQUAL_STR(root->tag, "dfa");
 
 	isAlphabetPredefined = 0;
-	for (attribute = root->attributes->array; attribute < root->attributes->array + root->attributes->size; attribute++)
+	for (attribute = root->attributes; attribute < root->attributes + root->nAttributes; attribute++)
 	{
 		ASSERT_XMLATTRIBUTE(attribute);
 		say(MSG_REPORT_VAR(attribute->name, "%s", attribute->value));
@@ -166,11 +242,11 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	{
 		node = root->children[i];
 		ASSERT_XMLNODE(node);
-		if (!strcmp(node->tag, "states"))
+		if (node->tagId == statesId)
 			states = node;
-		else if (!strcmp(node->tag, "initialState"))
+		else if (node->tagId == initialStateId)
 			initialState = node;
-		else if (!strcmp(node->tag, "transitions"))
+		else if (node->tagId == transitionsId)
 			transitions = node;
 		else
 			warning(MSG_REPORT_VAR("Unrecognized DFA Child", "%s", node->tag));
@@ -182,8 +258,8 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	{
 		node = states->children[i];
 		ASSERT_XMLNODE(node);
-		isAccept = !strcmp(node->tag, "accept");
-		isReject = !strcmp(node->tag, "reject");
+		isAccept = (node->tagId == acceptId);
+		isReject = (node->tagId == rejectId);
 
 		unless (isAccept || isReject) {
 			warning(MSG_REPORT_VAR("Skipping unrecognized State Type (accept/reject)", "%s", node->tag));
@@ -193,20 +269,16 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 		for (j = 0; j < node->nChildren; j++) {
 			state = node->children[j];
 			ASSERT_XMLNODE(state);
-			s = insertState_dfa(dfa);
+			s = insertState_dfa(dfa, state->tag, strlen(state->tag));
 			ASSERT_DFASTATE(s);
 			s->isAccept = isAccept;
-			check = fromPattern(s->name, DFA_MAX_NAME_SIZE, "%s", state->tag);
-			ASSERT_NOT_NULL(check);
-			ASSERT_NOT_EMPTY(check);
 			if (isAccept)
 				say(MSG_REPORT_VAR("Accept State", "%s", s->name));
 			else
 				say(MSG_REPORT_VAR("Reject State", "%s", s->name));
 
-			/* Map the state name to the state index. */
-			insert_ht(ht, s->name, fromUInt_obj(s->id));
-			ASSERT_HASHTABLE(ht);
+			/* Map the tag to the state index. */
+			stateOf[state->tagId] = s->id;
 		}
 	}
 
@@ -214,10 +286,8 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	errorUnless(initialState->nChildren == 1, MSG_ERROR_SYNTAX("There has to be EXACTLY one initial state!"));
 	node = initialState->children[0];
 	ASSERT_XMLNODE(node);
-	obj = get_ht(ht, node->tag);
-	ASSERT_NOT_NULL(obj);
-	dfa->initialStateId = obj->asUInt;
-	ASSERT_FITS_IN_BOUND(dfa->initialStateId, dfa->states->nStates);
+	dfa->initialStateId = stateOf[node->tagId];
+	errorIf(dfa->initialStateId == DFA_NO_STATE, MSG_ERROR_UNRECOGNIZED_STR(node->tag));
 
 	ASSERT_XMLNODE(transitions);
 	say(MSG_REPORT("Processing transitions..."));
@@ -225,21 +295,17 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 	{
 		from = transitions->children[i];
 		ASSERT_XMLNODE(from);
-		obj = get_ht(ht, from->tag);
-		ASSERT_NOT_NULL(obj);
-		sourceId = obj->asUInt;
-		ASSERT_FITS_IN_BOUND(sourceId, dfa->states->nStates);
+		sourceId = stateOf[from->tagId];
+		errorIf(sourceId == DFA_NO_STATE, MSG_ERROR_UNRECOGNIZED_STR(from->tag));
 
 		for (j = 0; j < from->nChildren; j++)
 		{
 			to = from->children[j];
 			ASSERT_XMLNODE(to);
-			obj = get_ht(ht, to->tag);
-			ASSERT_NOT_NULL(obj);
-			sinkId = obj->asUInt;
-			ASSERT_FITS_IN_BOUND(sinkId, dfa->states->nStates);
+			sinkId = stateOf[to->tagId];
+			errorIf(sinkId == DFA_NO_STATE, MSG_ERROR_UNRECOGNIZED_STR(to->tag));
 
-			for (with = to->content[0]; (*with); with++) {
+			for (with = getContent_xmln(to, 0); (*with); with++) {
 				unless (strchr(dfa->alphabet, *with)) {
 					/* The alphabet must NOT be predefined. */
 					errorIf(isAlphabetPredefined, MSG_ERROR_SYNTAX("Encountered symbol outside the alphabet!"));
@@ -256,34 +322,342 @@ DeterministicFiniteAutomaton* fromXml_dfa(DeterministicFiniteAutomaton* dfa, con
 		}
 	}
 
-	/* Free the Hashtable. */
-	free(ht);
+	free(stateOf);
+
+	ASSERT_DFA(dfa);
+	return dfa;
+}
+
+/** \brief The part of a <dfa> element that the DFA reader is in.
+ **/
+typedef enum DFASectionBody {
+	DFA_SECTION_NONE,
+	DFA_SECTION_STATES,
+	DFA_SECTION_INITIAL_STATE,
+	DFA_SECTION_TRANSITIONS,
+	DFA_SECTION_UNKNOWN
+} DFASection;
+
+/** \brief The state of a DeterministicFiniteAutomaton being built from the events of the Xml reader.
+ **
+ ** The depth is 1 inside <dfa>, 2 inside a section, 3 inside <accept>, <reject> or a
+ ** source state and 4 inside a sink state.
+ **/
+typedef struct DFAReaderBody {
+	DeterministicFiniteAutomaton* dfa;
+	unsigned int depth;
+	unsigned int nSections;
+	unsigned int nInitialStates;
+	DFASection section;
+	int isAccept;
+	int isSkipping;
+	int isAlphabetPredefined;
+	char* alphabetEnd;
+	DFAStateId sourceId;
+	DFAStateId sinkId;
+} DFAReader;
+
+/** \brief Returns the id of a state, given its name as a slice.
+ ** \related DeterministicFiniteAutomaton
+ **
+ ** While reading, the n-th interned name is the name of the n-th state.
+ **/
+DFAStateId private_stateId_dfar(const DFAReader* reader, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_stateId_dfar);
+
+	/* Variable declarations. */
+	char name[DFA_MAX_NAME_SIZE];
+	InternId id;
+
+	id = find_it(reader->dfa->names, tag, len);
+	if (id == INTERN_NONE) {
+		fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+		error(MSG_ERROR_UNRECOGNIZED_STR(name));
+	}
+	ASSERT_FITS_IN_BOUND(id, reader->dfa->states->nStates);
+
+	return id;
+}
+
+/** \brief Handles a start tag of a <dfa> element.
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_startTag_dfar(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_startTag_dfar);
+
+	/* Variable declarations. */
+	char name[DFA_MAX_NAME_SIZE];
+	char* check;
+	DFAState* s;
+	DFAReader* reader = context;
+
+	switch (reader->depth++) {
+		case 0:
+			errorUnless(len == 3 && !strncmp(tag, "dfa", len), MSG_ERROR_SYNTAX("Expected <dfa>"));
+			break;
+		case 1:
+			reader->nSections++;
+			if (len == 6 && !strncmp(tag, "states", len)) {
+				reader->section = DFA_SECTION_STATES;
+			} else if (len == 12 && !strncmp(tag, "initialState", len)) {
+				errorUnless(reader->dfa->states->nStates, MSG_ERROR_SYNTAX("<states> must come before <initialState>"));
+				reader->section = DFA_SECTION_INITIAL_STATE;
+			} else if (len == 11 && !strncmp(tag, "transitions", len)) {
+				errorUnless(reader->dfa->states->nStates, MSG_ERROR_SYNTAX("<states> must come before <transitions>"));
+				reader->section = DFA_SECTION_TRANSITIONS;
+				say(MSG_REPORT("Processing transitions..."));
+			} else {
+				check = fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+				warning(MSG_REPORT_VAR("Unrecognized DFA Child", "%s", check));
+				reader->section = DFA_SECTION_UNKNOWN;
+			}
+			break;
+		case 2:
+			if (reader->section == DFA_SECTION_STATES) {
+				reader->isAccept = (len == 6 && !strncmp(tag, "accept", len));
+				reader->isSkipping = !reader->isAccept && !(len == 6 && !strncmp(tag, "reject", len));
+				if (reader->isSkipping)
+				{
+					check = fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+					warning(MSG_REPORT_VAR("Skipping unrecognized State Type (accept/reject)", "%s", check));
+				}
+			} else if (reader->section == DFA_SECTION_INITIAL_STATE) {
+				reader->nInitialStates++;
+				reader->dfa->initialStateId = private_stateId_dfar(reader, tag, len);
+			} else if (reader->section == DFA_SECTION_TRANSITIONS) {
+				reader->sourceId = private_stateId_dfar(reader, tag, len);
+			}
+			break;
+		case 3:
+			if (reader->section == DFA_SECTION_STATES && !reader->isSkipping) {
+				s = insertState_dfa(reader->dfa, tag, len);
+				ASSERT_DFASTATE(s);
+				s->isAccept = reader->isAccept;
+				if (reader->isAccept)
+					say(MSG_REPORT_VAR("Accept State", "%s", s->name));
+				else
+					say(MSG_REPORT_VAR("Reject State", "%s", s->name));
+			} else if (reader->section == DFA_SECTION_TRANSITIONS) {
+				reader->sinkId = private_stateId_dfar(reader, tag, len);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/** \brief Handles an attribute of a <dfa> element.
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_attribute_dfar(void* context, const char* name, const size_t nameLen, const char* value, const size_t valueLen)
+{
+	DECLARE_FUNCTION(private_attribute_dfar);
+
+	/* Variable declarations. */
+	char* check;
+	DFAReader* reader = context;
+
+	/* Only the attributes of the root matter. */
+	unless (reader->depth == 1)
+		return;
+
+	if (nameLen == 4 && !strncmp(name, "name", nameLen)) {
+		check = fromPattern(reader->dfa->name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)valueLen, value);
+		ASSERT_NOT_NULL(check);
+		ASSERT_NOT_EMPTY(check);
+		say(MSG_REPORT_VAR("name", "%s", reader->dfa->name));
+	} else if (nameLen == 8 && !strncmp(name, "alphabet", nameLen)) {
+		reader->isAlphabetPredefined = 1;
+		check = fromPattern(reader->dfa->alphabet, DFA_MAX_SYMBOLS - 1, "%.*s", (int)valueLen, value);
+		ASSERT_NOT_NULL(check);
+		ASSERT_NOT_EMPTY(check);
+		reader->alphabetEnd = reader->dfa->alphabet + strlen(reader->dfa->alphabet);
+		say(MSG_REPORT_VAR("alphabet", "%s", reader->dfa->alphabet));
+	}
+}
+
+/** \brief Handles the symbols of a transition.
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_text_dfar(void* context, const char* text, const size_t len)
+{
+	DECLARE_FUNCTION(private_text_dfar);
+
+	/* Variable declarations. */
+	int result;
+	const char* with;
+	DFAReader* reader = context;
+
+	unless (reader->depth == 4 && reader->section == DFA_SECTION_TRANSITIONS)
+		return;
+
+	for (with = text; with < text + len; with++) {
+		unless (strchr(reader->dfa->alphabet, *with)) {
+			/* The alphabet must NOT be predefined. */
+			errorIf(reader->isAlphabetPredefined, MSG_ERROR_SYNTAX("Encountered symbol outside the alphabet!"));
+			ASSERT_FITS_IN_BOUND((reader->alphabetEnd - reader->dfa->alphabet), DFA_MAX_SYMBOLS - 1);
+
+			/* Append the new symbol to the alphabet. */
+			*(reader->alphabetEnd++) = *with;
+			*(reader->alphabetEnd) = '\0';
+		}
+		result = insertTransition_dfa(reader->dfa, reader->sourceId, reader->sinkId, *with);
+		ASSERT_NOT_ZERO(result);
+	}
+}
+
+/** \brief Handles an end tag of a <dfa> element.
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_endTag_dfar(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_endTag_dfar);
+
+	/* Variable declaration. */
+	DFAReader* reader = context;
+
+	(void)tag;
+	(void)len;
+
+	switch (--reader->depth) {
+		case 0:
+			errorUnless(reader->nSections == 3, MSG_ERROR_SYNTAX("DFA must have exactly 3 children, <states>, <initialState>, <transitions>"));
+			break;
+		case 1:
+			if (reader->section == DFA_SECTION_INITIAL_STATE)
+				errorUnless(reader->nInitialStates == 1, MSG_ERROR_SYNTAX("There has to be EXACTLY one initial state!"));
+			reader->section = DFA_SECTION_NONE;
+			break;
+		default:
+			break;
+	}
+}
+
+/** \brief The XmlHandler building a DeterministicFiniteAutomaton.
+ ** \related DeterministicFiniteAutomaton
+ **/
+const XmlHandler private_reader_dfa = {
+	NULL,
+	private_startTag_dfar,
+	private_attribute_dfar,
+	private_text_dfar,
+	private_endTag_dfar
+};
+
+/** \brief Initializes a DFAReader for a DeterministicFiniteAutomaton.
+ ** \related DeterministicFiniteAutomaton
+ **/
+DFAReader* private_initialize_dfar(DFAReader* reader, DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(private_initialize_dfar);
+
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	ASSERT_DFA(dfa);
+
+	/* Clear the alphabet. */
+	dfa->alphabet[0] = '\0';
+
+	reader->dfa = dfa;
+	reader->depth = 0;
+	reader->nSections = 0;
+	reader->nInitialStates = 0;
+	reader->section = DFA_SECTION_NONE;
+	reader->isAccept = 0;
+	reader->isSkipping = 0;
+	reader->isAlphabetPredefined = 0;
+	reader->alphabetEnd = dfa->alphabet;
+	reader->sourceId = DFA_NO_STATE;
+	reader->sinkId = DFA_NO_STATE;
+
+	return reader;
+}
+
+/** \brief Finalizes a DFAReader, once all the events have been read.
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_finalize_dfar(DFAReader* reader)
+{
+	DECLARE_FUNCTION(private_finalize_dfar);
+
+	/* Check. */
+	ASSERT_NOT_NULL(reader);
+
+	errorUnless(reader->nSections, MSG_ERROR_SYNTAX("Expected <dfa>"));
+}
+
+/** \brief Creates a DeterministicFiniteAutomaton from a FILE stream, without building an Xml tree.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The stream
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The <states> must come before the <initialState> and the <transitions>.
+ **/
+DeterministicFiniteAutomaton* fromStream_dfa(DeterministicFiniteAutomaton* dfa, FILE* stream)
+{
+	DECLARE_FUNCTION(fromStream_dfa);
+
+	/* Variable declaration. */
+	DFAReader reader;
+
+	/* Check. */
+	ASSERT_NOT_NULL(stream);
 
+	dfa = initialize_dfa(dfa);
+	ASSERT_DFA(dfa);
+
+	private_initialize_dfar(&reader, dfa);
+	parseStream_xml(stream, &private_reader_dfa, &reader);
+	private_finalize_dfar(&reader);
+
+	ASSERT_DFA(dfa);
 	return dfa;
 }
 
+/** \brief Creates a DeterministicFiniteAutomaton from a file, without building an Xml tree.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param filename The filename
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The file is memory-mapped when possible, see parseFile_xml.
+ **/
 DeterministicFiniteAutomaton* fromFile_dfa(DeterministicFiniteAutomaton* dfa, const char* filename)
 {
 	DECLARE_FUNCTION(fromFile_dfa);
 
-	Xml* xml;
+	/* Variable declaration. */
+	DFAReader reader;
 
+	/* Checks. */
 	ASSERT_NOT_NULL(filename);
 	ASSERT_NOT_EMPTY(filename);
 	ASSERT_NOT_TOO_LONG(filename, BUFFER_SIZE);
 
-	xml = fromFile_xml(NULL, filename);
-	ASSERT_XML(xml);
-
-	dfa = fromXml_dfa(dfa, xml);
+	dfa = initialize_dfa(dfa);
 	ASSERT_DFA(dfa);
 
-	free(xml);
+	private_initialize_dfar(&reader, dfa);
+	parseFile_xml(filename, &private_reader_dfa, &reader);
+	private_finalize_dfar(&reader);
 
+	ASSERT_DFA(dfa);
 	return dfa;
 }
 
-Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
+/** \brief Creates a Graph from a DeterministicFiniteAutomaton.
+ ** \param G The Graph
+ ** \param arena The Arena the Graph allocates from
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the Graph.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The Node names are the interned state names, so the Graph must NOT outlive the DFA.
+ **/
+Graph* toDot_dfa(Graph* G, Arena* arena, const DeterministicFiniteAutomaton* dfa)
 {
 	DECLARE_FUNCTION(toDot_dfa);
 
@@ -298,7 +672,7 @@ Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
 
 	ASSERT_DFA(dfa);
 
-	G = initialize_dot(G);
+	G = initialize_dot(G, arena);
 	ASSERT_GRAPH(G);
 
 	/* DFA name. */
@@ -314,9 +688,7 @@ Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
 		node = insertNode_dot(G, -1);
 		ASSERT_NODE(node);
 		ASSERT_GRAPH(G);
-		check = fromPattern(node->name, DOT_MAX_NAME_SIZE, "%s", state->name);
-		ASSERT_NOT_NULL(check);
-		ASSERT_NOT_EMPTY(check);
+		node->name = state->name;
 		check = fromPattern(node->label, 1, "");
 		ASSERT_NOT_NULL(check);
 		ASSERT_EMPTY(check);
@@ -332,9 +704,7 @@ Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
 	node = insertNode_dot(G, -1);
 	ASSERT_NODE(node);
 	ASSERT_GRAPH(G);
-	check = fromPattern(node->name, DOT_MAX_NAME_SIZE, "reset");
-	ASSERT_NOT_NULL(check);
-	ASSERT_NOT_EMPTY(check);
+	node->name = "reset";
 	check = fromPattern(node->label, 1, "");
 	ASSERT_NOT_NULL(check);
 	ASSERT_EMPTY(check);
@@ -354,7 +724,10 @@ Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
 	{
 		for (with = start; with < end; with++)
 		{
-			j = dfa->transitions[i][(int)*with];
+			j = dfa->transitions[i][(unsigned char)*with];
+			if (j == DFA_NO_STATE)
+				continue;
+
 			edge = getEdge_dot(G, i, j);
 			if (edge) {
 				ASSERT_EDGE(edge);
@@ -375,97 +748,2189 @@ Graph* toDot_dfa(Graph* G, const DeterministicFiniteAutomaton* dfa)
 	return G;
 }
 
-char* toC_dfa(char* str, const DeterministicFiniteAutomaton* dfa)
+/** \brief Partitions the byte values into equivalence classes of a DeterministicFiniteAutomaton.
+ ** \param classes The DFAByteClasses
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DFAByteClasses.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Every byte gets a hash of its column in the transition table, so columns
+ ** are only compared when their hashes collide.
+ **/
+DFAByteClasses* toByteClasses_dfa(DFAByteClasses* classes, const DeterministicFiniteAutomaton* dfa)
 {
-	DECLARE_FUNCTION(toC_dfa);
+	DECLARE_FUNCTION(toByteClasses_dfa);
 
-	DFAStateId sourceId, sinkId;
-	char* ptr;
-	const char* start;
-	const char* end;
-	const char* with;
-	const DFAState* from;
-	const DFAState* to;
+	/* Variable declarations. */
+	unsigned int b, k, rep;
+	unsigned long hashes[DFA_MAX_SYMBOLS];
+	const DFAState* state;
+	const DFAStateId* row;
 
+	/* Check. */
 	ASSERT_DFA(dfa);
 
-	start = dfa->alphabet;
-	end = dfa->alphabet + strlen(dfa->alphabet);
+	unless (classes)
+		SAFE_MALLOC(classes, DFAByteClasses, 1);
 
-	say(MSG_REPORT_VAR("Function", "%s", dfa->name));
-	ptr = fromPattern(str, BUFFER_LARGE_SIZE, "int %s(const char* str)\n{\n\tchar c;\n\tif (!str)\n\t\treturn 0;\n", dfa->name);
-	ASSERT_NOT_NULL(ptr);
-	ASSERT_NOT_EMPTY(ptr);
-	ptr += strlen(ptr);
+	/* Hash every column, hash = hash * 33 + sinkId */
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+		hashes[b] = 5381;
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++) {
+		row = dfa->transitions[state->id];
+		for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+			hashes[b] = ((hashes[b] << 5) + hashes[b]) + row[b];
+	}
 
-	/* Go to the initial state. */
-	to = dfa->states->array + dfa->initialStateId;
-	ASSERT_DFASTATE(to);
-	ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "\tgoto %s;\n", to->name);
-	ASSERT_NOT_NULL(ptr);
-	ASSERT_NOT_EMPTY(ptr);
-	ptr += strlen(ptr);
+	/* Assign every byte to the first class with an identical column. */
+	classes->nClasses = 0;
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+		for (k = 0; k < classes->nClasses; k++) {
+			rep = classes->representatives[k];
+			unless (hashes[rep] == hashes[b])
+				continue;
+			for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+				unless (dfa->transitions[state->id][rep] == dfa->transitions[state->id][b])
+					break;
+			if (state == dfa->states->array + dfa->states->nStates)
+				break;
+		}
+		if (k == classes->nClasses)
+			classes->representatives[classes->nClasses++] = b;
+		classes->classOf[b] = k;
+	}
 
-	/* Insert every state. */
-	for (from = dfa->states->array; from < dfa->states->array + dfa->states->nStates; from++)
-	{
-		ASSERT_DFASTATE(from);
-		sourceId = from->id;
-		ASSERT_FITS_IN_BOUND(sourceId, dfa->states->nStates);
+	ASSERT_DFABYTECLASSES(classes);
+	ASSERT_ZERO(classes->classOf[0]);
+	return classes;
+}
 
-		/* Mark the beginning of the state. */
-		say(MSG_REPORT_VAR("Implementing", "%s", from->name));
-		ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "%s: c = *str++;\n", from->name);
-		ASSERT_NOT_NULL(ptr);
-		ASSERT_NOT_EMPTY(ptr);
-		ptr += strlen(ptr);
-
-		/* Insert accept/reject. */
-		ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "\tif (c == '\\0') {\n");
-		ASSERT_NOT_NULL(ptr);
-		ASSERT_NOT_EMPTY(ptr);
-		ptr += strlen(ptr);
-
-		ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "\t\treturn %d;\n\t}", from->isAccept);
-		ASSERT_NOT_NULL(ptr);
-		ASSERT_NOT_EMPTY(ptr);
-		ptr += strlen(ptr);
-
-		/* Insert every transition. */
-		for (with = start; with < end; with++)
-		{
-			ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, " else if (c == '%c') {\n", *with);
-			ASSERT_NOT_NULL(ptr);
-			ASSERT_NOT_EMPTY(ptr);
-			ptr += strlen(ptr);
+/** \brief Describes the self-loop of a state of a DeterministicFiniteAutomaton.
+ ** \param loop The DFASelfLoop
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stateId The id of the state
+ ** \returns A pointer to the DFASelfLoop, with no range if the loop is not worth skipping.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+DFASelfLoop* toSelfLoop_dfa(DFASelfLoop* loop, const DeterministicFiniteAutomaton* dfa, const DFAStateId stateId)
+{
+	DECLARE_FUNCTION(toSelfLoop_dfa);
+
+	/* Variable declarations. */
+	unsigned int b, first, nBytes, nRanges;
+	const DFAStateId* row;
 
-			sinkId = dfa->transitions[sourceId][(int)*with];
-			ASSERT_FITS_IN_BOUND(sinkId, DFA_MAX_STATES);
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_FITS_IN_BOUND(stateId, dfa->states->nStates);
 
-			to = dfa->states->array + sinkId;
-			ASSERT_DFASTATE(to);
+	unless (loop)
+		SAFE_MALLOC(loop, DFASelfLoop, 1);
 
-			ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "\t\tgoto %s;\n\t}", to->name);
-			ASSERT_NOT_NULL(ptr);
-			ASSERT_NOT_EMPTY(ptr);
-			ptr += strlen(ptr);
+	row = dfa->transitions[stateId];
+	nBytes = 0;
+	nRanges = 0;
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+		if (row[b] != stateId)
+			continue;
+		for (first = b; b + 1 < DFA_MAX_SYMBOLS && row[b+1] == stateId; b++);
+		if (nRanges < DFA_SKIP_MAX_RANGES) {
+			loop->lows[nRanges] = (unsigned char)first;
+			loop->widths[nRanges] = (unsigned char)(b - first);
 		}
+		nRanges++;
+		nBytes += b - first + 1;
+	}
+	loop->nRanges = (nBytes < DFA_SKIP_MIN_BYTES || nRanges > DFA_SKIP_MAX_RANGES) ? 0 : nRanges;
+
+	ASSERT_DFASELFLOOP(loop);
+	return loop;
+}
 
-		ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, " else {\n\t\treturn 0;\n\t}\n");
-		ASSERT_NOT_NULL(ptr);
-		ASSERT_NOT_EMPTY(ptr);
-		ptr += strlen(ptr);
+/** \brief Marks every state that can reach a marked state.
+ ** \param n The number of states
+ ** \param invStart Where the predecessors of each state start in invSource, n + 1 entries
+ ** \param invSource The predecessors of all states, grouped by sink
+ ** \param isMarked The marks, in and out
+ ** \param queue A scratch array of n states
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void private_reverseReach_dfa(const unsigned int n, const unsigned int* invStart, const unsigned int* invSource, char* isMarked, unsigned int* queue)
+{
+	/* Variable declarations. */
+	unsigned int q, i, j, nQueue;
+
+	nQueue = 0;
+	for (q = 0; q < n; q++)
+		if (isMarked[q])
+			queue[nQueue++] = q;
+	for (i = 0; i < nQueue; i++) {
+		for (j = invStart[queue[i]]; j < invStart[queue[i] + 1]; j++) {
+			if (isMarked[invSource[j]])
+				continue;
+			isMarked[invSource[j]] = 1;
+			queue[nQueue++] = invSource[j];
+		}
 	}
+}
 
-	/* Finalize the function. */
-	ptr = fromPattern(ptr, BUFFER_LARGE_SIZE, "}");
-	ASSERT_NOT_NULL(ptr);
-	ASSERT_NOT_EMPTY(ptr);
-	ptr += strlen(ptr);
+/** \brief Finds the dead and the universal states of a DeterministicFiniteAutomaton.
+ ** \param fates The DFAFate of every state, or NULL to allocate them
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param signature The signature of the matcher, DFA_SIGNATURE_STRING never reads past a NUL byte
+ ** \returns A pointer to the fates.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Both are found by reverse reachability: a state is live if it reaches an
+ ** accepting state, and bounded if it reaches a rejecting state or a missing
+ ** transition on some byte. Dead states are not live, universal states are
+ ** not bounded.
+ **/
+DFAFate* toFates_dfa(DFAFate* fates, const DeterministicFiniteAutomaton* dfa, const DFASignature signature)
+{
+	DECLARE_FUNCTION(toFates_dfa);
+
+	/* Variable declarations. */
+	unsigned int n, k, a, b, q;
+	unsigned int* invStart;
+	unsigned int* invSource;
+	unsigned int* cursor;
+	unsigned int* queue;
+	char* isLive;
+	char* isBounded;
+	DFAStateId sinkId;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+	Arena aBuffer, *scratch = &aBuffer;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
 
-	ASSERT_NOT_NULL(str);
-	ASSERT_NOT_EMPTY(str);
-	ASSERT_NOT_TOO_LONG(str, BUFFER_LARGE_SIZE);
+	n = dfa->states->nStates;
+	unless (fates)
+		SAFE_MALLOC(fates, DFAFate, n);
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	k = classes->nClasses;
+
+	scratch = initialize_arena(scratch);
+
+	/* Inverse transitions, grouped by sink. */
+	SAFE_ARENA_CALLOC(invStart, scratch, unsigned int, (n + 1));
+	SAFE_ARENA_MALLOC(invSource, scratch, unsigned int, (n * k + 1));
+	SAFE_ARENA_MALLOC(cursor, scratch, unsigned int, (n + 1));
+	SAFE_ARENA_MALLOC(queue, scratch, unsigned int, (n + 1));
+	for (q = 0; q < n; q++) {
+		for (a = 0; a < k; a++) {
+			sinkId = dfa->transitions[q][classes->representatives[a]];
+			if (sinkId != DFA_NO_STATE)
+				invStart[sinkId + 1]++;
+		}
+	}
+	for (q = 0; q < n; q++)
+		invStart[q + 1] += invStart[q];
+	memcpy(cursor, invStart, (n + 1) * sizeof(unsigned int));
+	for (q = 0; q < n; q++) {
+		for (a = 0; a < k; a++) {
+			sinkId = dfa->transitions[q][classes->representatives[a]];
+			if (sinkId != DFA_NO_STATE)
+				invSource[cursor[sinkId]++] = q;
+		}
+	}
 
-	return str;
+	/* Live states reach an accepting state. */
+	SAFE_ARENA_CALLOC(isLive, scratch, char, (n + 1));
+	for (q = 0; q < n; q++)
+		isLive[q] = dfa->states->array[q].isAccept ? 1 : 0;
+	private_reverseReach_dfa(n, invStart, invSource, isLive, queue);
+
+	/* Bounded states reach a rejecting state or a missing transition. */
+	SAFE_ARENA_CALLOC(isBounded, scratch, char, (n + 1));
+	for (q = 0; q < n; q++) {
+		unless (dfa->states->array[q].isAccept) {
+			isBounded[q] = 1;
+			continue;
+		}
+		for (b = (signature == DFA_SIGNATURE_STRING) ? 1 : 0; b < DFA_MAX_SYMBOLS && dfa->transitions[q][b] != DFA_NO_STATE; b++);
+		isBounded[q] = b < DFA_MAX_SYMBOLS;
+	}
+	private_reverseReach_dfa(n, invStart, invSource, isBounded, queue);
+
+	for (q = 0; q < n; q++)
+		fates[q] = !isLive[q] ? DFA_FATE_DEAD : !isBounded[q] ? DFA_FATE_UNIVERSAL : DFA_FATE_OPEN;
+
+	finalize_arena(scratch);
+
+	return fates;
+}
+
+/** \brief Minimizes a DeterministicFiniteAutomaton in place.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the minimal DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Unreachable states are pruned first, then Hopcroft's partition refinement
+ ** runs over the byte classes with an implicit dead state standing for every
+ ** missing transition. Each block keeps the name of its lowest state and the
+ ** block of the dead state is dropped, unless it contains the initial state.
+ **/
+DeterministicFiniteAutomaton* minimize_dfa(DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(minimize_dfa);
+
+	/* Variable declarations. */
+	unsigned int n, N, k, a, i, j, q, p, t, size, nBlocks, nTouched, nWork, nSplitter;
+	unsigned int B, Y, Z, first;
+	unsigned int* dense;
+	unsigned int* orig;
+	unsigned int* invStart;
+	unsigned int* invSource;
+	unsigned int* elements;
+	unsigned int* location;
+	unsigned int* blockOf;
+	unsigned int* blockStart;
+	unsigned int* blockEnd;
+	unsigned int* blockMarked;
+	unsigned int* touched;
+	unsigned int* work;
+	unsigned int* splitter;
+	unsigned int* newId;
+	char* isInWork;
+	DFAStateId sinkId;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+	Arena aBuffer, *scratch = &aBuffer;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+	say(MSG_REPORT_VAR("States Before Minimization", "%u", dfa->states->nStates));
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	k = classes->nClasses;
+
+	/* Every temporary array lives in one Arena, freed at the end. */
+	scratch = initialize_arena(scratch);
+
+	/* Find the reachable states, in breadth-first order. */
+	SAFE_ARENA_MALLOC(dense, scratch, unsigned int, dfa->states->nStates);
+	SAFE_ARENA_MALLOC(orig, scratch, unsigned int, dfa->states->nStates);
+	for (q = 0; q < dfa->states->nStates; q++)
+		dense[q] = DFA_NO_STATE;
+	n = 0;
+	dense[dfa->initialStateId] = n;
+	orig[n++] = dfa->initialStateId;
+	for (i = 0; i < n; i++) {
+		for (a = 0; a < k; a++) {
+			sinkId = dfa->transitions[orig[i]][classes->representatives[a]];
+			if (sinkId == DFA_NO_STATE || dense[sinkId] != DFA_NO_STATE)
+				continue;
+			dense[sinkId] = n;
+			orig[n++] = sinkId;
+		}
+	}
+	say(MSG_REPORT_VAR("Reachable States", "%u", n));
+
+	/* The dense state n is the implicit dead state. */
+	N = n + 1;
+
+	/* Inverse transitions, grouped by (class, sink). */
+	SAFE_ARENA_CALLOC(invStart, scratch, unsigned int, (k * N + 1));
+	SAFE_ARENA_MALLOC(invSource, scratch, unsigned int, k * N);
+	for (a = 0; a < k; a++) {
+		for (q = 0; q < N; q++) {
+			sinkId = (q < n) ? dfa->transitions[orig[q]][classes->representatives[a]] : DFA_NO_STATE;
+			t = (sinkId == DFA_NO_STATE) ? n : dense[sinkId];
+			invStart[a * N + t + 1]++;
+		}
+	}
+	for (i = 0; i < k * N; i++)
+		invStart[i + 1] += invStart[i];
+	SAFE_ARENA_MALLOC(touched, scratch, unsigned int, (k * N + 1));
+	memcpy(touched, invStart, (k * N + 1) * sizeof(unsigned int));
+	for (a = 0; a < k; a++) {
+		for (q = 0; q < N; q++) {
+			sinkId = (q < n) ? dfa->transitions[orig[q]][classes->representatives[a]] : DFA_NO_STATE;
+			t = (sinkId == DFA_NO_STATE) ? n : dense[sinkId];
+			invSource[touched[a * N + t]++] = q;
+		}
+	}
+
+	/* Initial partition: accepting states first, then the rest. */
+	SAFE_ARENA_MALLOC(elements, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(location, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(blockOf, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(blockStart, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(blockEnd, scratch, unsigned int, N);
+	SAFE_ARENA_CALLOC(blockMarked, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(work, scratch, unsigned int, N);
+	SAFE_ARENA_MALLOC(splitter, scratch, unsigned int, N);
+	SAFE_ARENA_CALLOC(isInWork, scratch, char, N);
+
+	/* The touched cursors above had k * N + 1 entries, enough to list the touched blocks. */
+
+	size = 0;
+	for (q = 0; q < n; q++)
+		if (dfa->states->array[orig[q]].isAccept)
+			elements[size++] = q;
+	first = size;
+	for (q = 0; q < N; q++)
+		unless (q < n && dfa->states->array[orig[q]].isAccept)
+			elements[size++] = q;
+
+	nBlocks = 0;
+	nWork = 0;
+	if (first) {
+		blockStart[nBlocks] = 0;
+		blockEnd[nBlocks++] = first;
+	}
+	blockStart[nBlocks] = first;
+	blockEnd[nBlocks++] = N;
+	for (B = 0; B < nBlocks; B++)
+		for (i = blockStart[B]; i < blockEnd[B]; i++)
+			blockOf[elements[i]] = B;
+	for (i = 0; i < N; i++)
+		location[elements[i]] = i;
+
+	/* Start with the smaller block as the only splitter. */
+	if (nBlocks == 2) {
+		B = (first <= N - first) ? 0 : 1;
+		work[nWork++] = B;
+		isInWork[B] = 1;
+	}
+
+	while (nWork) {
+		B = work[--nWork];
+		isInWork[B] = 0;
+
+		/* The splitter is the block as it was when it got popped. */
+		nSplitter = 0;
+		for (i = blockStart[B]; i < blockEnd[B]; i++)
+			splitter[nSplitter++] = elements[i];
+
+		for (a = 0; a < k; a++) {
+			/* Mark every predecessor by moving it to the front of its block. */
+			nTouched = 0;
+			for (i = 0; i < nSplitter; i++) {
+				t = splitter[i];
+				for (j = invStart[a * N + t]; j < invStart[a * N + t + 1]; j++) {
+					p = invSource[j];
+					Y = blockOf[p];
+					unless (location[p] >= blockStart[Y] + blockMarked[Y])
+						continue;
+					unless (blockMarked[Y])
+						touched[nTouched++] = Y;
+					q = elements[blockStart[Y] + blockMarked[Y]];
+					elements[location[p]] = q;
+					location[q] = location[p];
+					elements[blockStart[Y] + blockMarked[Y]] = p;
+					location[p] = blockStart[Y] + blockMarked[Y];
+					blockMarked[Y]++;
+				}
+			}
+
+			/* Split every touched block into its marked and unmarked parts. */
+			for (i = 0; i < nTouched; i++) {
+				Y = touched[i];
+				if (blockMarked[Y] == blockEnd[Y] - blockStart[Y]) {
+					blockMarked[Y] = 0;
+					continue;
+				}
+				Z = nBlocks++;
+				blockStart[Z] = blockStart[Y];
+				blockEnd[Z] = blockStart[Y] + blockMarked[Y];
+				blockStart[Y] = blockEnd[Z];
+				blockMarked[Y] = 0;
+				for (j = blockStart[Z]; j < blockEnd[Z]; j++)
+					blockOf[elements[j]] = Z;
+
+				if (isInWork[Y] || blockEnd[Z] - blockStart[Z] <= blockEnd[Y] - blockStart[Y]) {
+					work[nWork++] = Z;
+					isInWork[Z] = 1;
+				} else {
+					work[nWork++] = Y;
+					isInWork[Y] = 1;
+				}
+			}
+		}
+	}
+
+	/* Number the blocks in the order of their lowest original state. */
+	SAFE_ARENA_MALLOC(newId, scratch, unsigned int, nBlocks);
+	for (B = 0; B < nBlocks; B++)
+		newId[B] = DFA_NO_STATE;
+	for (q = 0; q < dfa->states->nStates; q++)
+		dense[q] = (dense[q] == DFA_NO_STATE) ? DFA_NO_STATE : blockOf[dense[q]];
+	size = 0;
+	for (q = 0; q < dfa->states->nStates; q++) {
+		B = dense[q];
+		if (B == DFA_NO_STATE || newId[B] != DFA_NO_STATE)
+			continue;
+		if (B == blockOf[n] && B != dense[dfa->initialStateId])
+			continue;
+		newId[B] = size;
+		orig[size++] = q;
+	}
+
+	/* Rebuild in place, every new state is copied from a state with a higher or equal id. */
+	for (i = 0; i < size; i++) {
+		q = orig[i];
+		dfa->states->array[i] = dfa->states->array[q];
+		dfa->states->array[i].id = i;
+		for (a = 0; a < DFA_MAX_SYMBOLS; a++) {
+			sinkId = dfa->transitions[q][a];
+			dfa->transitions[i][a] = (sinkId == DFA_NO_STATE || dense[sinkId] == blockOf[n])
+				? DFA_NO_STATE
+				: newId[dense[sinkId]];
+		}
+	}
+	dfa->initialStateId = newId[dense[dfa->initialStateId]];
+	dfa->states->nStates = size;
+
+	/* Free the working memory. */
+	finalize_arena(scratch);
+
+	say(MSG_REPORT_VAR("States After Minimization", "%u", dfa->states->nStates));
+	ASSERT_DFA(dfa);
+	return dfa;
+}
+
+/** \brief The pairs of states met by a product construction, numbered 0, 1, 2...
+ **
+ ** Pair i is made of pairs[2 * i] and pairs[2 * i + 1], either one DFA_NO_STATE for the
+ ** implicit dead state. The slots hold pair ids and are probed linearly.
+ **/
+typedef struct DFAPairTableBody {
+	DFAStateId* pairs;
+	unsigned int nPairs;
+	unsigned int pairCapacity;
+	DFAStateId* slots;
+	unsigned int capacity;
+} DFAPairTable;
+
+/** \brief Returns the id of a pair of states, adding it if it is new.
+ ** \param table The DFAPairTable
+ ** \param p The state of the left operand
+ ** \param q The state of the right operand
+ ** \returns The id, equal to the previous number of pairs if the pair is new.
+ ** \related DeterministicFiniteAutomaton
+ **/
+DFAStateId private_intern_dfap(DFAPairTable* table, const DFAStateId p, const DFAStateId q)
+{
+	DECLARE_FUNCTION(private_intern_dfap);
+
+	/* Variable declarations. */
+	unsigned long hashValue;
+	unsigned int slot;
+	DFAStateId id, other;
+
+	hashValue = ((unsigned long)p * 2654435761UL) ^ ((unsigned long)q * 40503UL);
+	hashValue ^= hashValue >> 15;
+	for (slot = hashValue & (table->capacity - 1); table->slots[slot] != DFA_NO_STATE; slot = (slot + 1) & (table->capacity - 1)) {
+		id = table->slots[slot];
+		if (table->pairs[2 * id] == p && table->pairs[2 * id + 1] == q)
+			return id;
+	}
+
+	/* A new pair. */
+	if (table->nPairs == table->pairCapacity) {
+		table->pairCapacity *= 2;
+		SAFE_REALLOC(table->pairs, DFAStateId, (2 * table->pairCapacity));
+	}
+	id = table->nPairs++;
+	table->pairs[2 * id] = p;
+	table->pairs[2 * id + 1] = q;
+	table->slots[slot] = id;
+
+	/* Keep at least half of the slots empty. */
+	if (2 * table->nPairs > table->capacity) {
+		free(table->slots);
+		table->capacity *= 2;
+		SAFE_MALLOC(table->slots, DFAStateId, table->capacity);
+		memset(table->slots, 0xFF, table->capacity * sizeof(DFAStateId));
+		for (other = 0; other < table->nPairs; other++) {
+			hashValue = ((unsigned long)table->pairs[2 * other] * 2654435761UL) ^ ((unsigned long)table->pairs[2 * other + 1] * 40503UL);
+			hashValue ^= hashValue >> 15;
+			for (slot = hashValue & (table->capacity - 1); table->slots[slot] != DFA_NO_STATE; slot = (slot + 1) & (table->capacity - 1));
+			table->slots[slot] = other;
+		}
+	}
+
+	return id;
+}
+
+/** \brief Initializes an empty DFAPairTable.
+ ** \param table The DFAPairTable
+ ** \returns A pointer to the DFAPairTable.
+ ** \related DeterministicFiniteAutomaton
+ **/
+DFAPairTable* private_initialize_dfap(DFAPairTable* table)
+{
+	DECLARE_FUNCTION(private_initialize_dfap);
+
+	table->nPairs = 0;
+	table->pairCapacity = DFA_INITIAL_CAPACITY;
+	SAFE_MALLOC(table->pairs, DFAStateId, (2 * table->pairCapacity));
+	table->capacity = 2 * DFA_INITIAL_CAPACITY;
+	SAFE_MALLOC(table->slots, DFAStateId, table->capacity);
+	memset(table->slots, 0xFF, table->capacity * sizeof(DFAStateId));
+
+	return table;
+}
+
+/** \brief Releases the pairs of a DFAPairTable.
+ ** \param table The DFAPairTable
+ ** \related DeterministicFiniteAutomaton
+ **/
+void private_finalize_dfap(DFAPairTable* table)
+{
+	free(table->pairs);
+	free(table->slots);
+	table->pairs = NULL;
+	table->slots = NULL;
+	table->nPairs = 0;
+}
+
+/** \brief Splits the bytes of the alphabets of two DFAs into pairs of byte classes.
+ ** \param left The left DeterministicFiniteAutomaton
+ ** \param right The right DeterministicFiniteAutomaton
+ ** \param pairClassOf The pair class of every byte, 0 for the bytes of neither alphabet
+ ** \param leftOf A byte of the left byte class of every pair class
+ ** \param rightOf A byte of the right byte class of every pair class
+ ** \param byteOf The first byte of every pair class, for spelling strings
+ ** \returns The number of pair classes, class 0 included.
+ ** \related DeterministicFiniteAutomaton
+ **
+ ** Two bytes share a pair class iff they share a byte class in both DFAs, so
+ ** pairs of states move once per pair class instead of once per byte.
+ **/
+unsigned int private_pairClasses_dfa(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, unsigned char* pairClassOf, unsigned char* leftOf, unsigned char* rightOf, unsigned char* byteOf)
+{
+	DECLARE_FUNCTION(private_pairClasses_dfa);
+
+	/* Variable declarations. */
+	unsigned int b, k, nPairClasses;
+	DFAByteClasses lBuffer, *leftClasses = &lBuffer;
+	DFAByteClasses rBuffer, *rightClasses = &rBuffer;
+
+	toByteClasses_dfa(leftClasses, left);
+	toByteClasses_dfa(rightClasses, right);
+	memset(pairClassOf, 0, DFA_MAX_SYMBOLS);
+	nPairClasses = 1;
+	leftOf[0] = 0;
+	rightOf[0] = 0;
+	byteOf[0] = 0;
+	for (b = 1; b < DFA_MAX_SYMBOLS; b++) {
+		unless (strchr(left->alphabet, (int)b) || strchr(right->alphabet, (int)b))
+			continue;
+		for (k = 1; k < nPairClasses; k++)
+			if (leftClasses->classOf[leftOf[k]] == leftClasses->classOf[b] && rightClasses->classOf[rightOf[k]] == rightClasses->classOf[b])
+				break;
+		if (k == nPairClasses) {
+			leftOf[k] = leftClasses->representatives[leftClasses->classOf[b]];
+			rightOf[k] = rightClasses->representatives[rightClasses->classOf[b]];
+			byteOf[k] = (unsigned char)b;
+			nPairClasses++;
+		}
+		pairClassOf[b] = (unsigned char)k;
+	}
+	say(MSG_REPORT_VAR("Byte Classes", "%u", nPairClasses));
+
+	return nPairClasses;
+}
+
+/** \brief Combines the acceptance of the two states of a pair.
+ ** \param operation The DFAOperation
+ ** \param isLeft Whether the left state accepts
+ ** \param isRight Whether the right state accepts
+ ** \returns Whether the pair accepts.
+ ** \related DeterministicFiniteAutomaton
+ **/
+int private_apply_dfa(const DFAOperation operation, const int isLeft, const int isRight)
+{
+	switch (operation) {
+		case DFA_OPERATION_INTERSECTION:
+			return isLeft && isRight;
+		case DFA_OPERATION_UNION:
+			return isLeft || isRight;
+		case DFA_OPERATION_DIFFERENCE:
+			return isLeft && !isRight;
+		default:
+			return !isLeft != !isRight;
+	}
+}
+
+/** \brief Checks whether a pair of states can never accept whatever follows, whatever its live state does.
+ ** \param operation The DFAOperation
+ ** \param p The state of the left operand, DFA_NO_STATE if dead
+ ** \param q The state of the right operand, DFA_NO_STATE if dead
+ ** \returns 1 if the pair is dead, 0 if it may not be.
+ ** \related DeterministicFiniteAutomaton
+ **/
+int private_isDeadPair_dfa(const DFAOperation operation, const DFAStateId p, const DFAStateId q)
+{
+	switch (operation) {
+		case DFA_OPERATION_INTERSECTION:
+			return p == DFA_NO_STATE || q == DFA_NO_STATE;
+		case DFA_OPERATION_DIFFERENCE:
+			return p == DFA_NO_STATE;
+		default:
+			return p == DFA_NO_STATE && q == DFA_NO_STATE;
+	}
+}
+
+/** \brief Builds the product of two DeterministicFiniteAutomaton objects.
+ ** \param product The DeterministicFiniteAutomaton to build
+ ** \param left The left operand
+ ** \param right The right operand
+ ** \param operation The DFAOperation combining the acceptance of the operands
+ ** \returns A pointer to the product.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The states are the pairs of states of the operands reachable from the pair of
+ ** initial states, in breadth-first order, with a missing transition standing for
+ ** an implicit dead state in either operand. Pairs that cannot accept under the
+ ** operation are left out. The alphabet is the union of the alphabets, and every
+ ** pair moves once per pair of byte classes of the operands met in the alphabet. The product must
+ ** differ from both operands, which may be the same.
+ **/
+DeterministicFiniteAutomaton* product_dfa(DeterministicFiniteAutomaton* product, const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, const DFAOperation operation)
+{
+	DECLARE_FUNCTION(product_dfa);
+
+	/* Variable declarations. */
+	static const char* const operationNames[] = { "and", "or", "minus", "xor" };
+	char name[2 * DFA_MAX_NAME_SIZE + 9];
+	unsigned char pairClassOf[DFA_MAX_SYMBOLS];
+	unsigned char leftOf[DFA_MAX_SYMBOLS];
+	unsigned char rightOf[DFA_MAX_SYMBOLS];
+	unsigned char byteOf[DFA_MAX_SYMBOLS];
+	DFAStateId sinkOf[DFA_MAX_SYMBOLS];
+	unsigned int b, k, nPairClasses;
+	DFAStateId d, p, q, sinkP, sinkQ;
+	char* alphabetEnd;
+	DFAState* state;
+	DFAPairTable tBuffer, *table = &tBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(left);
+	ASSERT_DFA(right);
+	ASSERT_NOT_ZERO(left->states->nStates);
+	ASSERT_NOT_ZERO(right->states->nStates);
+	ASSERT_FITS_IN_BOUND(operation, DFA_OPERATION_SYMMETRIC_DIFFERENCE + 1);
+
+	product = initialize_dfa(product);
+
+	/* The name joins those of the operands, cut to fit. */
+	fromPattern(name, 2 * DFA_MAX_NAME_SIZE + 8, "%s_%s_%s", left->name, operationNames[operation], right->name);
+	fromPattern(product->name, DFA_MAX_NAME_SIZE - 1, "%.*s", DFA_MAX_NAME_SIZE - 2, name);
+
+	/* The alphabet, the left one followed by the new symbols of the right one. */
+	strcpy(product->alphabet, left->alphabet);
+	alphabetEnd = product->alphabet + strlen(product->alphabet);
+	for (b = 0; right->alphabet[b]; b++) {
+		unless (strchr(product->alphabet, right->alphabet[b])) {
+			*alphabetEnd++ = right->alphabet[b];
+			*alphabetEnd = '\0';
+		}
+	}
+	ASSERT_NOT_EMPTY(product->alphabet);
+
+	/* A byte class of the product is a pair of byte classes of the operands. */
+	nPairClasses = private_pairClasses_dfa(left, right, pairClassOf, leftOf, rightOf, byteOf);
+	table = private_initialize_dfap(table);
+	private_intern_dfap(table, left->initialStateId, right->initialStateId);
+	state = insertState_dfa(product, NULL, 0);
+	state->isAccept = private_apply_dfa(operation, left->states->array[left->initialStateId].isAccept, right->states->array[right->initialStateId].isAccept);
+	product->initialStateId = 0;
+
+	for (d = 0; d < table->nPairs; d++) {
+		/* Move the pair once per class, class 0 leads nowhere. */
+		p = table->pairs[2 * d];
+		q = table->pairs[2 * d + 1];
+		sinkOf[0] = DFA_NO_STATE;
+		for (k = 1; k < nPairClasses; k++) {
+			sinkP = p == DFA_NO_STATE ? DFA_NO_STATE : left->transitions[p][leftOf[k]];
+			sinkQ = q == DFA_NO_STATE ? DFA_NO_STATE : right->transitions[q][rightOf[k]];
+			if (private_isDeadPair_dfa(operation, sinkP, sinkQ)) {
+				sinkOf[k] = DFA_NO_STATE;
+				continue;
+			}
+			sinkOf[k] = private_intern_dfap(table, sinkP, sinkQ);
+			if (sinkOf[k] == product->states->nStates) {
+				state = insertState_dfa(product, NULL, 0);
+				state->isAccept = private_apply_dfa(operation,
+					sinkP != DFA_NO_STATE && left->states->array[sinkP].isAccept,
+					sinkQ != DFA_NO_STATE && right->states->array[sinkQ].isAccept);
+			}
+		}
+		for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+			product->transitions[d][b] = sinkOf[pairClassOf[b]];
+	}
+	say(MSG_REPORT_VAR("Product States", "%u", product->states->nStates));
+
+	private_finalize_dfap(table);
+
+	ASSERT_DFA(product);
+	return product;
+}
+
+/** \brief Makes every transition of a DeterministicFiniteAutomaton over its alphabet explicit.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Missing transitions on symbols of the alphabet lead to a new rejecting state,
+ ** named after DFA_SINK_STATE_NAME, that loops to itself on the whole alphabet.
+ ** Nothing changes if no transition is missing. Bytes outside of the alphabet
+ ** still lead nowhere.
+ **/
+DeterministicFiniteAutomaton* complete_dfa(DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(complete_dfa);
+
+	/* Variable declarations. */
+	char name[DFA_MAX_NAME_SIZE];
+	const char* with;
+	unsigned int n;
+	DFAStateId s, sinkId;
+	DFAState* state;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+
+	sinkId = DFA_NO_STATE;
+	for (s = 0; s < dfa->states->nStates && sinkId == DFA_NO_STATE; s++)
+		for (with = dfa->alphabet; *with; with++)
+			if (dfa->transitions[s][(unsigned char)*with] == DFA_NO_STATE)
+				sinkId = dfa->states->nStates;
+	if (sinkId == DFA_NO_STATE)
+		return dfa;
+
+	/* Find a name no state has. */
+	fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%s", DFA_SINK_STATE_NAME);
+	for (n = 1; find_it(dfa->names, name, strlen(name)) != INTERN_NONE; n++)
+		fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%s%u", DFA_SINK_STATE_NAME, n);
+	state = insertState_dfa(dfa, name, strlen(name));
+	state->isAccept = 0;
+	say(MSG_REPORT_VAR("Sink State", "%s", state->name));
+
+	for (s = 0; s < dfa->states->nStates; s++)
+		for (with = dfa->alphabet; *with; with++)
+			if (dfa->transitions[s][(unsigned char)*with] == DFA_NO_STATE)
+				dfa->transitions[s][(unsigned char)*with] = sinkId;
+
+	ASSERT_DFA(dfa);
+	return dfa;
+}
+
+/** \brief Makes a DeterministicFiniteAutomaton accept exactly the strings over its alphabet it rejected.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The DFA is completed with complete_dfa(), then every state flips. Strings with
+ ** a byte outside of the alphabet are still rejected.
+ **/
+DeterministicFiniteAutomaton* complement_dfa(DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(complement_dfa);
+
+	/* Variable declaration. */
+	DFAStateId s;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+
+	dfa = complete_dfa(dfa);
+	for (s = 0; s < dfa->states->nStates; s++)
+		dfa->states->array[s].isAccept = !dfa->states->array[s].isAccept;
+
+	ASSERT_DFA(dfa);
+	return dfa;
+}
+
+/** \brief Finds the representative of an element of a union-find, halving the path on the way.
+ ** \param parent The parent of every element, roots are their own parents
+ ** \param x The element
+ ** \returns The representative.
+ ** \related DeterministicFiniteAutomaton
+ **/
+unsigned int private_find_dfa(unsigned int* parent, unsigned int x)
+{
+	while (parent[x] != x) {
+		parent[x] = parent[parent[x]];
+		x = parent[x];
+	}
+	return x;
+}
+
+/** \brief Searches the pairs of states of two DFAs, in breadth-first order, for one accepting under an operation.
+ ** \param left The left DeterministicFiniteAutomaton
+ ** \param right The right DeterministicFiniteAutomaton
+ ** \param operation The DFAOperation
+ ** \param witness Set to a new string leading to the pair, or to NULL if there is none; ignored if NULL
+ ** \returns 1 if there is such a pair, 0 otherwise.
+ ** \related DeterministicFiniteAutomaton
+ **
+ ** The pairs are those of product_dfa(), met on the fly and never turned into
+ ** states, and the search stops at the first one found. The string is then one
+ ** of the shortest the product accepts, it is to be freed by the caller.
+ **/
+int private_search_dfa(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, const DFAOperation operation, char** witness)
+{
+	DECLARE_FUNCTION(private_search_dfa);
+
+	/* Variable declarations. */
+	unsigned char pairClassOf[DFA_MAX_SYMBOLS];
+	unsigned char leftOf[DFA_MAX_SYMBOLS];
+	unsigned char rightOf[DFA_MAX_SYMBOLS];
+	unsigned char byteOf[DFA_MAX_SYMBOLS];
+	unsigned int k, nPairClasses, nPairs, capacity, length;
+	DFAStateId d, p, q, sinkP, sinkQ, sinkId, found;
+	DFAStateId* parents;
+	unsigned char* via;
+	DFAPairTable tBuffer, *table = &tBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(left);
+	ASSERT_DFA(right);
+	ASSERT_NOT_ZERO(left->states->nStates);
+	ASSERT_NOT_ZERO(right->states->nStates);
+
+	nPairClasses = private_pairClasses_dfa(left, right, pairClassOf, leftOf, rightOf, byteOf);
+	table = private_initialize_dfap(table);
+	capacity = DFA_INITIAL_CAPACITY;
+	SAFE_MALLOC(parents, DFAStateId, capacity);
+	SAFE_MALLOC(via, unsigned char, capacity);
+
+	private_intern_dfap(table, left->initialStateId, right->initialStateId);
+	parents[0] = DFA_NO_STATE;
+	via[0] = 0;
+	found = DFA_NO_STATE;
+	for (d = 0; d < table->nPairs; d++) {
+		p = table->pairs[2 * d];
+		q = table->pairs[2 * d + 1];
+		if (private_apply_dfa(operation, p != DFA_NO_STATE && left->states->array[p].isAccept, q != DFA_NO_STATE && right->states->array[q].isAccept)) {
+			found = d;
+			break;
+		}
+		for (k = 1; k < nPairClasses; k++) {
+			sinkP = p == DFA_NO_STATE ? DFA_NO_STATE : left->transitions[p][leftOf[k]];
+			sinkQ = q == DFA_NO_STATE ? DFA_NO_STATE : right->transitions[q][rightOf[k]];
+			if (private_isDeadPair_dfa(operation, sinkP, sinkQ))
+				continue;
+			nPairs = table->nPairs;
+			sinkId = private_intern_dfap(table, sinkP, sinkQ);
+			unless (sinkId == nPairs)
+				continue;
+
+			/* A new pair, reached from d along byteOf[k]. */
+			if (sinkId == capacity) {
+				capacity *= 2;
+				SAFE_REALLOC(parents, DFAStateId, capacity);
+				SAFE_REALLOC(via, unsigned char, capacity);
+			}
+			parents[sinkId] = d;
+			via[sinkId] = byteOf[k];
+		}
+	}
+	say(MSG_REPORT_VAR("Pairs Visited", "%u", table->nPairs));
+
+	/* Spell the string backwards from the pair found. */
+	if (witness) {
+		*witness = NULL;
+		if (found != DFA_NO_STATE) {
+			for (length = 0, d = found; parents[d] != DFA_NO_STATE; d = parents[d])
+				length++;
+			SAFE_MALLOC(*witness, char, (length + 1));
+			(*witness)[length] = '\0';
+			for (d = found; parents[d] != DFA_NO_STATE; d = parents[d])
+				(*witness)[--length] = (char)via[d];
+		}
+	}
+
+	private_finalize_dfap(table);
+	free(parents);
+	free(via);
+
+	return found != DFA_NO_STATE;
+}
+
+/** \brief Checks whether two DeterministicFiniteAutomaton objects accept the same strings.
+ ** \param left The left DeterministicFiniteAutomaton
+ ** \param right The right DeterministicFiniteAutomaton
+ ** \param counterexample Set to a new shortest string only one of them accepts, or to NULL if there is none; ignored if NULL
+ ** \returns 1 if they are equivalent, 0 otherwise.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Hopcroft and Karp's algorithm: the states of both DFAs and one dead state
+ ** shared by both are merged in a union-find, starting from the initial states.
+ ** Every merge pushes the pair merged on a work list, whose pairs must agree
+ ** on acceptance and whose successors on every pair of byte classes are merged
+ ** in turn. There are fewer merges than states, so neither the product nor the
+ ** minimal DFAs are built. Only when they differ is the counterexample searched
+ ** for, with the breadth-first search of isIncluded_dfa() on the symmetric difference.
+ ** The counterexample is to be freed by the caller.
+ **/
+int isEquivalent_dfa(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, char** counterexample)
+{
+	DECLARE_FUNCTION(isEquivalent_dfa);
+
+	/* Variable declarations. */
+	unsigned char pairClassOf[DFA_MAX_SYMBOLS];
+	unsigned char leftOf[DFA_MAX_SYMBOLS];
+	unsigned char rightOf[DFA_MAX_SYMBOLS];
+	unsigned char byteOf[DFA_MAX_SYMBOLS];
+	unsigned int k, nPairClasses, nLeft, dead, nStack, nMerges, p, q, sinkP, sinkQ, rootP, rootQ;
+	unsigned int* parent;
+	unsigned int* size;
+	unsigned int* stack;
+	int isEquivalent, isAcceptP, isAcceptQ;
+
+	/* Checks. */
+	ASSERT_DFA(left);
+	ASSERT_DFA(right);
+	ASSERT_NOT_ZERO(left->states->nStates);
+	ASSERT_NOT_ZERO(right->states->nStates);
+
+	nPairClasses = private_pairClasses_dfa(left, right, pairClassOf, leftOf, rightOf, byteOf);
+
+	/* Left states come first, then right states, then the dead state. */
+	nLeft = left->states->nStates;
+	dead = nLeft + right->states->nStates;
+	SAFE_MALLOC(parent, unsigned int, (dead + 1));
+	SAFE_MALLOC(size, unsigned int, (dead + 1));
+	SAFE_MALLOC(stack, unsigned int, (2 * dead + 2));
+	for (p = 0; p <= dead; p++) {
+		parent[p] = p;
+		size[p] = 1;
+	}
+
+	parent[nLeft + right->initialStateId] = left->initialStateId;
+	size[left->initialStateId]++;
+	stack[0] = left->initialStateId;
+	stack[1] = nLeft + right->initialStateId;
+	nStack = 2;
+	nMerges = 1;
+	isEquivalent = 1;
+	while (nStack && isEquivalent) {
+		q = stack[--nStack];
+		p = stack[--nStack];
+		isAcceptP = p < nLeft ? left->states->array[p].isAccept : p < dead ? right->states->array[p - nLeft].isAccept : 0;
+		isAcceptQ = q < nLeft ? left->states->array[q].isAccept : q < dead ? right->states->array[q - nLeft].isAccept : 0;
+		if (!isAcceptP != !isAcceptQ) {
+			isEquivalent = 0;
+			break;
+		}
+		for (k = 1; k < nPairClasses; k++) {
+			if (p < nLeft)
+				sinkP = left->transitions[p][leftOf[k]] == DFA_NO_STATE ? dead : left->transitions[p][leftOf[k]];
+			else
+				sinkP = p < dead && right->transitions[p - nLeft][rightOf[k]] != DFA_NO_STATE ? nLeft + right->transitions[p - nLeft][rightOf[k]] : dead;
+			if (q < nLeft)
+				sinkQ = left->transitions[q][leftOf[k]] == DFA_NO_STATE ? dead : left->transitions[q][leftOf[k]];
+			else
+				sinkQ = q < dead && right->transitions[q - nLeft][rightOf[k]] != DFA_NO_STATE ? nLeft + right->transitions[q - nLeft][rightOf[k]] : dead;
+			rootP = private_find_dfa(parent, sinkP);
+			rootQ = private_find_dfa(parent, sinkQ);
+			if (rootP == rootQ)
+				continue;
+
+			/* Merge the smaller class into the larger one. */
+			if (size[rootP] < size[rootQ]) {
+				parent[rootP] = rootQ;
+				size[rootQ] += size[rootP];
+			} else {
+				parent[rootQ] = rootP;
+				size[rootP] += size[rootQ];
+			}
+			stack[nStack++] = sinkP;
+			stack[nStack++] = sinkQ;
+			nMerges++;
+		}
+	}
+	say(MSG_REPORT_VAR("Merges", "%u", nMerges));
+
+	free(parent);
+	free(size);
+	free(stack);
+
+	if (isEquivalent) {
+		if (counterexample)
+			*counterexample = NULL;
+	} else
+		private_search_dfa(left, right, DFA_OPERATION_SYMMETRIC_DIFFERENCE, counterexample);
+
+	return isEquivalent;
+}
+
+/** \brief Checks whether every string a DeterministicFiniteAutomaton accepts is accepted by another.
+ ** \param left The DeterministicFiniteAutomaton accepting fewer strings
+ ** \param right The DeterministicFiniteAutomaton accepting more strings
+ ** \param counterexample Set to a new shortest string left accepts and right rejects, or to NULL if there is none; ignored if NULL
+ ** \returns 1 if left is included in right, 0 otherwise.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The pairs of states of the difference are searched in breadth-first order
+ ** and the search stops at the first one where left accepts and right rejects.
+ ** Pairs where left is dead are never visited. The counterexample is to be freed by the caller.
+ **/
+int isIncluded_dfa(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, char** counterexample)
+{
+	return !private_search_dfa(left, right, DFA_OPERATION_DIFFERENCE, counterexample);
+}
+
+/** \brief Writes the byte to class map of a C matcher.
+ ** \param classes The DFAByteClasses
+ ** \param stream The target stream
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void private_toClassMapStream_dfa(const DFAByteClasses* classes, FILE* stream)
+{
+	DECLARE_FUNCTION(private_toClassMapStream_dfa);
+
+	/* Variable declaration. */
+	unsigned int b;
+
+	/* Checks. */
+	ASSERT_DFABYTECLASSES(classes);
+	ASSERT_NOT_NULL(stream);
+
+	fprintf(stream, "\tstatic const unsigned char classOf[%u] = {", DFA_MAX_SYMBOLS);
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+		fprintf(stream, b ? ",%u" : "%u", classes->classOf[b]);
+	fprintf(stream, "};\n");
+}
+
+/** \brief Writes the signature and the opening brace of a C matcher.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void private_toSignatureStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toSignatureStream_dfa);
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	say(MSG_REPORT_VAR("Function", "%s", dfa->name));
+	if (signature == DFA_SIGNATURE_BATCH)
+		fprintf(stream, "#include <stddef.h>\n\nvoid %s(const unsigned char* const* bufs, const size_t* lens, size_t n, unsigned char* results)\n{\n", dfa->name);
+	else if (signature == DFA_SIGNATURE_BUFFER)
+		fprintf(stream, "#include <stddef.h>\n\nint %s(const unsigned char* buf, size_t len)\n{\n", dfa->name);
+	else
+		fprintf(stream, "int %s(const char* str)\n{\n", dfa->name);
+}
+
+/** \brief Writes the vector headers and macros used to skip self-loops, if any state needs them.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Only length-delimited matchers skip self-loops: a NUL-terminated string may
+ ** end anywhere in a vector, so it cannot be read ahead safely.
+ **/
+void private_toSkipHeaderStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toSkipHeaderStream_dfa);
+
+	/* Variable declarations. */
+	DFAStateId id;
+	DFASelfLoop lBuffer, *loop = &lBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	if (signature != DFA_SIGNATURE_BUFFER)
+		return;
+	for (id = 0; id < dfa->states->nStates && !toSelfLoop_dfa(loop, dfa, id)->nRanges; id++);
+	if (id == dfa->states->nStates)
+		return;
+
+	fprintf(stream, "#if defined(__AVX2__)\n#include <immintrin.h>\n#elif defined(__SSE2__)\n#include <emmintrin.h>\n#endif\n");
+	fprintf(stream, "#ifndef DFA_IN_RANGE_16\n");
+	fprintf(stream, "#define DFA_IN_RANGE_16(v, low, width) _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8((v), _mm_set1_epi8((char)(low))), _mm_set1_epi8((char)(width))), _mm_setzero_si128())\n");
+	fprintf(stream, "#define DFA_IN_RANGE_32(v, low, width) _mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8((v), _mm256_set1_epi8((char)(low))), _mm256_set1_epi8((char)(width))), _mm256_setzero_si256())\n");
+	fprintf(stream, "#endif\n");
+}
+
+/** \brief Writes the vector loop skipping the self-loop of a state, 32 bytes at a time with AVX2 or 16 with SSE2.
+ ** \param stream The target stream
+ ** \param loop The DFASelfLoop of the state
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The loop stops in front of the first byte leaving the state, which the
+ ** scalar code of the state handles. Without vector extensions, nothing is
+ ** emitted and the scalar code loops one byte at a time.
+ **/
+void private_toSkipStream_dfa(FILE* stream, const DFASelfLoop* loop)
+{
+	DECLARE_FUNCTION(private_toSkipStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int r, w;
+	static const char* const vectorTypes[2] = {"__m256i", "__m128i"};
+	static const char* const prefixes[2] = {"_mm256", "_mm"};
+	static const char* const suffixes[2] = {"si256", "si128"};
+	static const unsigned int widths[2] = {32, 16};
+
+	/* Checks. */
+	ASSERT_NOT_NULL(stream);
+	ASSERT_DFASELFLOOP(loop);
+
+	unless (loop->nRanges)
+		return;
+
+	for (w = 0; w < 2; w++) {
+		fprintf(stream, w ? "#elif defined(__SSE2__)\n" : "\n#if defined(__AVX2__)\n");
+		fprintf(stream, "\twhile (end - buf >= %u) {\n", widths[w]);
+		fprintf(stream, "\t\t%s v = %s_loadu_%s((const %s*)buf);\n", vectorTypes[w], prefixes[w], suffixes[w], vectorTypes[w]);
+		fprintf(stream, "\t\tunsigned int m = ~(unsigned int)%s_movemask_epi8(", prefixes[w]);
+		for (r = 1; r < loop->nRanges; r++)
+			fprintf(stream, "%s_or_%s(", prefixes[w], suffixes[w]);
+		for (r = 0; r < loop->nRanges; r++)
+			fprintf(stream, r ? ", DFA_IN_RANGE_%u(v, %u, %u))" : "DFA_IN_RANGE_%u(v, %u, %u)", widths[w], loop->lows[r], loop->widths[r]);
+		fprintf(stream, w ? ") & 0xFFFFu;\n" : ");\n");
+		fprintf(stream, "\t\tif (m) {\n\t\t\tbuf += __builtin_ctz(m);\n\t\t\tbreak;\n\t\t}\n");
+		fprintf(stream, "\t\tbuf += %u;\n\t}\n", widths[w]);
+	}
+	fprintf(stream, "#endif\n\t");
+}
+
+/** \brief Collects the distinct sinks of a row of transitions.
+ ** \param row The transitions of a state, one per byte
+ ** \param fates The DFAFate of every state
+ ** \param sinks The array of at least DFA_MAX_SYMBOLS sinks to fill
+ ** \returns The number of distinct sinks, missing transitions and dead sinks excluded.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+unsigned int private_sinksOf_dfa(const DFAStateId* row, const DFAFate* fates, DFAStateId* sinks)
+{
+	DECLARE_FUNCTION(private_sinksOf_dfa);
+
+	/* Variable declarations. */
+	unsigned int b, j, nSinks;
+
+	/* Checks. */
+	ASSERT_NOT_NULL(row);
+	ASSERT_NOT_NULL(fates);
+	ASSERT_NOT_NULL(sinks);
+
+	nSinks = 0;
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+		if (row[b] == DFA_NO_STATE || fates[row[b]] == DFA_FATE_DEAD)
+			continue;
+		for (j = 0; j < nSinks && sinks[j] != row[b]; j++);
+		if (j == nSinks)
+			sinks[nSinks++] = row[b];
+	}
+
+	return nSinks;
+}
+
+/** \brief Estimates the cost of testing the bytes leading to a sink with range checks.
+ ** \param row The transitions of a state, one per byte
+ ** \param sink The sink
+ ** \returns The number of comparisons, one per isolated byte and two per range.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+unsigned int private_rangeCost_dfa(const DFAStateId* row, const DFAStateId sink)
+{
+	/* Variable declarations. */
+	unsigned int b, first, cost;
+
+	cost = 0;
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+		if (row[b] != sink)
+			continue;
+		for (first = b; b + 1 < DFA_MAX_SYMBOLS && row[b+1] == sink; b++);
+		cost += first == b ? DFA_COMPARE_COST : 2 * DFA_COMPARE_COST;
+	}
+
+	return cost;
+}
+
+/** \brief Writes a byte as a C character constant when printable, as a number otherwise.
+ ** \param stream The target stream
+ ** \param b The byte
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void private_toByteStream_dfa(FILE* stream, const unsigned int b)
+{
+	if (isprint(b) && b != '\'' && b != '\\')
+		fprintf(stream, "'%c'", (char)b);
+	else
+		fprintf(stream, "%u", b);
+}
+
+/** \brief Writes the range checks selecting the bytes leading to a sink.
+ ** \param stream The target stream
+ ** \param row The transitions of a state, one per byte
+ ** \param sink The sink
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Bounds an unsigned char always meets, 0 and 255, are left out.
+ **/
+void private_toRangeTestStream_dfa(FILE* stream, const DFAStateId* row, const DFAStateId sink)
+{
+	/* Variable declarations. */
+	unsigned int b, first;
+	int isFirst;
+
+	isFirst = 1;
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+		if (row[b] != sink)
+			continue;
+		for (first = b; b + 1 < DFA_MAX_SYMBOLS && row[b+1] == sink; b++);
+		fprintf(stream, isFirst ? "" : " || ");
+		isFirst = 0;
+		if (first == b) {
+			fprintf(stream, "c == ");
+			private_toByteStream_dfa(stream, b);
+		} else if (first == 0) {
+			fprintf(stream, "c <= ");
+			private_toByteStream_dfa(stream, b);
+		} else if (b == DFA_MAX_SYMBOLS - 1) {
+			fprintf(stream, "c >= ");
+			private_toByteStream_dfa(stream, first);
+		} else {
+			fprintf(stream, "(c >= ");
+			private_toByteStream_dfa(stream, first);
+			fprintf(stream, " && c <= ");
+			private_toByteStream_dfa(stream, b);
+			fprintf(stream, ")");
+		}
+	}
+}
+
+/** \brief Selects the shape of the tests of a state of a goto-driven matcher.
+ ** \param row The transitions of a state, one per byte
+ ** \param sinks The distinct sinks of the row
+ ** \param nSinks The number of distinct sinks
+ ** \param isBitmap Filled with one flag per sink, set when its bytes are tested against a bitmap
+ ** \returns Whether the state is cheaper to implement as a switch statement.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Each sink is tested with whichever of range checks or a bitmap lookup is
+ ** cheaper. The whole state becomes a switch when the resulting if/else
+ ** ladder costs more than a jump table.
+ **/
+int private_isSwitch_dfa(const DFAStateId* row, const DFAStateId* sinks, const unsigned int nSinks, int* isBitmap)
+{
+	/* Variable declarations. */
+	unsigned int j, rangeCost, cost;
+
+	cost = 0;
+	for (j = 0; j < nSinks; j++) {
+		rangeCost = private_rangeCost_dfa(row, sinks[j]);
+		isBitmap[j] = rangeCost > DFA_BITMAP_COST;
+		cost += isBitmap[j] ? DFA_BITMAP_COST : rangeCost;
+	}
+
+	return cost > DFA_SWITCH_COST;
+}
+
+/** \brief Writes the bitmaps tested by a goto-driven matcher.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param fates The DFAFate of every state
+ ** \param stream The target stream, or NULL to only count the bitmaps
+ ** \returns The number of bitmaps.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Bitmaps are numbered in the order of the states and of their sinks, as
+ ** private_toGotoStream_dfa() walks them.
+ **/
+unsigned int private_toBitmapsStream_dfa(const DeterministicFiniteAutomaton* dfa, const DFAFate* fates, FILE* stream)
+{
+	DECLARE_FUNCTION(private_toBitmapsStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int b, j, nSinks, nBitmaps;
+	DFAStateId sourceId;
+	DFAStateId sinks[DFA_MAX_SYMBOLS];
+	int isBitmap[DFA_MAX_SYMBOLS];
+	unsigned char bits[DFA_MAX_SYMBOLS / 8];
+	const DFAStateId* row;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+
+	nBitmaps = 0;
+	for (sourceId = 0; sourceId < dfa->states->nStates; sourceId++)
+	{
+		if (fates[sourceId] != DFA_FATE_OPEN)
+			continue;
+		row = dfa->transitions[sourceId];
+		nSinks = private_sinksOf_dfa(row, fates, sinks);
+		if (private_isSwitch_dfa(row, sinks, nSinks, isBitmap))
+			continue;
+
+		for (j = 0; j < nSinks; j++) {
+			unless (isBitmap[j])
+				continue;
+			if (stream) {
+				memset(bits, 0, sizeof(bits));
+				for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+					if (row[b] == sinks[j])
+						bits[b >> 3] |= (unsigned char)(1 << (b & 7));
+				fprintf(stream, nBitmaps ? ",\n\t\t{" : "\t\t{");
+				for (b = 0; b < sizeof(bits); b++)
+					fprintf(stream, b ? ",%u" : "%u", bits[b]);
+				fprintf(stream, "}");
+			}
+			nBitmaps++;
+		}
+	}
+
+	return nBitmaps;
+}
+
+/** \brief Writes a goto-driven C matcher of a DeterministicFiniteAutomaton to a stream.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Every state becomes a label. The bytes leading to the same sink are tested
+ ** together, with range checks or a bitmap lookup, or the whole state becomes
+ ** a switch statement, whichever private_isSwitch_dfa() finds cheaper. Dead
+ ** sinks are rejected like missing transitions, and dead or universal states
+ ** return as soon as they are entered.
+ **/
+void private_toGotoStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toGotoStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int b, j, nSinks, nBitmaps;
+	int isChained;
+	DFAStateId sourceId;
+	DFAStateId sinks[DFA_MAX_SYMBOLS];
+	int isBitmap[DFA_MAX_SYMBOLS];
+	const DFAStateId* row;
+	const DFAState* from;
+	DFAFate* fates;
+	char* isEntered;
+	DFASelfLoop lBuffer, *loop = &lBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	private_toSkipHeaderStream_dfa(dfa, stream, signature);
+	private_toSignatureStream_dfa(dfa, stream, signature);
+
+	/* Bitmaps for the sinks reached by too many ranges. */
+	fates = toFates_dfa(NULL, dfa, signature);
+	nBitmaps = private_toBitmapsStream_dfa(dfa, fates, NULL);
+	say(MSG_REPORT_VAR("Bitmaps", "%u", nBitmaps));
+	if (nBitmaps) {
+		fprintf(stream, "\tstatic const unsigned char bitmaps[%u][%u] = {\n", nBitmaps, DFA_MAX_SYMBOLS / 8);
+		private_toBitmapsStream_dfa(dfa, fates, stream);
+		fprintf(stream, "\n\t};\n");
+	}
+
+	if (signature == DFA_SIGNATURE_BUFFER)
+		fprintf(stream, "\tunsigned char c;\n\tconst unsigned char* end;\n\tif (!buf)\n\t\treturn 0;\n\tend = buf + len;\n");
+	else
+		fprintf(stream, "\tunsigned char c;\n\tif (!str)\n\t\treturn 0;\n");
+
+	/* Universal states are only written if the start or an open state jumps to them. */
+	SAFE_CALLOC(isEntered, char, dfa->states->nStates);
+	isEntered[dfa->initialStateId] = 1;
+	for (sourceId = 0; sourceId < dfa->states->nStates; sourceId++)
+		if (fates[sourceId] == DFA_FATE_OPEN)
+			for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+				if (dfa->transitions[sourceId][b] != DFA_NO_STATE)
+					isEntered[dfa->transitions[sourceId][b]] = 1;
+
+	/* Go to the initial state. */
+	fprintf(stream, "\tgoto %s;\n", dfa->states->array[dfa->initialStateId].name);
+
+	/* Insert every state. */
+	nBitmaps = 0;
+	for (from = dfa->states->array; from < dfa->states->array + dfa->states->nStates; from++)
+	{
+		ASSERT_DFASTATE(from);
+		sourceId = from->id;
+		ASSERT_FITS_IN_BOUND(sourceId, dfa->states->nStates);
+		row = dfa->transitions[sourceId];
+
+		/* Mark the beginning of the state. */
+		say(MSG_REPORT_VAR("Implementing", "%s", from->name));
+
+		/* Dead and universal states decide at once, nothing jumps to dead states but the start. */
+		if (fates[sourceId] == DFA_FATE_DEAD && sourceId != dfa->initialStateId)
+			continue;
+		if (fates[sourceId] == DFA_FATE_UNIVERSAL && !isEntered[sourceId])
+			continue;
+		if (fates[sourceId] != DFA_FATE_OPEN) {
+			fprintf(stream, "%s: return %d;\n", from->name, fates[sourceId] == DFA_FATE_UNIVERSAL);
+			continue;
+		}
+
+		/* Skip the self-loop then insert accept/reject at the end of the input. */
+		if (signature == DFA_SIGNATURE_BUFFER) {
+			fprintf(stream, "%s: ", from->name);
+			private_toSkipStream_dfa(stream, toSelfLoop_dfa(loop, dfa, sourceId));
+			fprintf(stream, "if (buf == end) {\n\t\treturn %d;\n\t}\n", from->isAccept);
+			fprintf(stream, "\tc = *buf++;\n\t");
+			isChained = 0;
+		} else {
+			fprintf(stream, "%s: c = (unsigned char)*str++;\n", from->name);
+			fprintf(stream, "\tif (c == '\\0') {\n\t\treturn %d;\n\t}", from->isAccept);
+			isChained = 1;
+		}
+
+		nSinks = private_sinksOf_dfa(row, fates, sinks);
+
+		/* Jump table, one case per byte. */
+		if (private_isSwitch_dfa(row, sinks, nSinks, isBitmap)) {
+			fprintf(stream, isChained ? "\n\tswitch (c) {\n" : "switch (c) {\n");
+			for (j = 0; j < nSinks; j++) {
+				fprintf(stream, "\t");
+				for (b = 0; b < DFA_MAX_SYMBOLS; b++) {
+					if (row[b] != sinks[j])
+						continue;
+					fprintf(stream, "case ");
+					private_toByteStream_dfa(stream, b);
+					fprintf(stream, ": ");
+				}
+				fprintf(stream, "\n\t\tgoto %s;\n", dfa->states->array[sinks[j]].name);
+			}
+			fprintf(stream, "\tdefault:\n\t\treturn 0;\n\t}\n");
+			continue;
+		}
+
+		/* A sink taking every byte left, all but NUL once it is tested, needs no test. */
+		for (b = signature == DFA_SIGNATURE_BUFFER ? 0 : 1; nSinks == 1 && !isBitmap[0] && b < DFA_MAX_SYMBOLS && row[b] == sinks[0]; b++);
+		if (b == DFA_MAX_SYMBOLS) {
+			fprintf(stream, isChained ? " else {\n\t\tgoto %s;\n\t}\n" : "goto %s;\n", dfa->states->array[sinks[0]].name);
+			continue;
+		}
+
+		/* If/else ladder, one test per sink. */
+		for (j = 0; j < nSinks; j++) {
+			ASSERT_FITS_IN_BOUND(sinks[j], dfa->states->nStates);
+			fprintf(stream, isChained ? " else if (" : "if (");
+			if (isBitmap[j])
+				fprintf(stream, "(bitmaps[%u][c >> 3] >> (c & 7)) & 1", nBitmaps++);
+			else
+				private_toRangeTestStream_dfa(stream, row, sinks[j]);
+			fprintf(stream, ") {\n\t\tgoto %s;\n\t}", dfa->states->array[sinks[j]].name);
+			isChained = 1;
+		}
+
+		if (isChained)
+			fprintf(stream, " else {\n\t\treturn 0;\n\t}\n");
+		else
+			fprintf(stream, "return 0;\n");
+	}
+
+	/* Finalize the function. */
+	fprintf(stream, "}");
+	free(isEntered);
+	free(fates);
+}
+
+/** \brief Chooses a label that no state of a DeterministicFiniteAutomaton is named after.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param prefix The label wanted
+ ** \returns The prefix followed by as few '_' as needed, to be freed.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+char* private_toFreeLabel_dfa(const DeterministicFiniteAutomaton* dfa, const char* prefix)
+{
+	DECLARE_FUNCTION(private_toFreeLabel_dfa);
+
+	/* Variable declarations. */
+	size_t len;
+	char* label;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(prefix);
+
+	/* Every state name rules out one label at most. */
+	len = strlen(prefix);
+	SAFE_MALLOC(label, char, (len + dfa->states->nStates + 1));
+	strcpy(label, prefix);
+	for (; find_it(dfa->names, label, len) != INTERN_NONE; len++) {
+		label[len] = '_';
+		label[len + 1] = '\0';
+	}
+
+	return label;
+}
+
+/** \brief Writes a computed-goto C matcher of a DeterministicFiniteAutomaton to a stream.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Every state becomes a label and owns one row of a dispatch table of label
+ ** addresses, indexed by byte class, so that each input byte costs a single
+ ** indirect jump. Labels as values are a GNU extension: the goto-driven
+ ** matcher is emitted as the fallback for other compilers.
+ **/
+void private_toComputedGotoStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toComputedGotoStream_dfa);
+
+	/* Variable declarations. */
+	int isDead;
+	unsigned int k;
+	char* deadLabel;
+	DFAStateId sinkId;
+	const DFAState* state;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+	DFASelfLoop lBuffer, *loop = &lBuffer;
+	DFAFate* fates;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	say(MSG_REPORT_VAR("Byte Classes", "%u", classes->nClasses));
+	fates = toFates_dfa(NULL, dfa, signature);
+
+	/* Labels as values are not ISO C, -ansi and -std=c99 get the fallback. */
+	fprintf(stream, "#if defined(__GNUC__) && !defined(__STRICT_ANSI__)\n");
+	private_toSkipHeaderStream_dfa(dfa, stream, signature);
+	private_toSignatureStream_dfa(dfa, stream, signature);
+
+	/* Map every byte to its class. */
+	private_toClassMapStream_dfa(classes, stream);
+
+	/* One row of label addresses per state, the dead state rejects. */
+	deadLabel = private_toFreeLabel_dfa(dfa, DFA_DEAD_LABEL);
+	isDead = 0;
+	fprintf(stream, "\tstatic void* const dispatch[%u][%u] = {\n", dfa->states->nStates, classes->nClasses);
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+	{
+		ASSERT_DFASTATE(state);
+		fprintf(stream, "\t\t/* %s */ {", state->name);
+		for (k = 0; k < classes->nClasses; k++) {
+			sinkId = dfa->transitions[state->id][classes->representatives[k]];
+			if (sinkId == DFA_NO_STATE || fates[sinkId] == DFA_FATE_DEAD) {
+				fprintf(stream, k ? ",&&%s" : "&&%s", deadLabel);
+				isDead = 1;
+				continue;
+			}
+			ASSERT_FITS_IN_BOUND(sinkId, dfa->states->nStates);
+			fprintf(stream, k ? ",&&%s" : "&&%s", dfa->states->array[sinkId].name);
+		}
+		fprintf(stream, state + 1 < dfa->states->array + dfa->states->nStates ? "},\n" : "}\n");
+	}
+	fprintf(stream, "\t};\n");
+
+	if (signature == DFA_SIGNATURE_BUFFER)
+		fprintf(stream, "\tunsigned char c;\n\tconst unsigned char* end;\n\tif (!buf)\n\t\treturn 0;\n\tend = buf + len;\n");
+	else
+		fprintf(stream, "\tunsigned char c;\n\tif (!str)\n\t\treturn 0;\n");
+
+	/* Go to the initial state. */
+	fprintf(stream, "\tgoto %s;\n", dfa->states->array[dfa->initialStateId].name);
+
+	/* Insert every state. */
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+	{
+		say(MSG_REPORT_VAR("Implementing", "%s", state->name));
+		if (fates[state->id] == DFA_FATE_DEAD && state->id != dfa->initialStateId)
+			continue;
+		if (fates[state->id] != DFA_FATE_OPEN) {
+			fprintf(stream, "%s: return %d;\n", state->name, fates[state->id] == DFA_FATE_UNIVERSAL);
+			continue;
+		}
+		if (signature == DFA_SIGNATURE_BUFFER) {
+			fprintf(stream, "%s: ", state->name);
+			private_toSkipStream_dfa(stream, toSelfLoop_dfa(loop, dfa, state->id));
+			fprintf(stream, "if (buf == end)\n\t\treturn %d;\n\tc = *buf++;\n", state->isAccept);
+		} else
+			fprintf(stream, "%s: if (!(c = (unsigned char)*str++))\n\t\treturn %d;\n", state->name, state->isAccept);
+		fprintf(stream, "\tgoto *dispatch[%u][classOf[c]];\n", state->id);
+	}
+	if (isDead)
+		fprintf(stream, "%s: return 0;\n", deadLabel);
+	fprintf(stream, "}\n#else\n");
+	free(deadLabel);
+	free(fates);
+
+	/* Portable fallback. */
+	private_toGotoStream_dfa(dfa, stream, signature);
+	fprintf(stream, "\n#endif");
+}
+
+/** \brief Writes a constant C matcher if the initial state of a DeterministicFiniteAutomaton is dead or universal.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \returns 1 if the matcher was written, 0 if the initial state is open.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+int private_toConstantStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toConstantStream_dfa);
+
+	/* Variable declaration. */
+	DFAFate* fates;
+	DFAFate initialFate;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	fates = toFates_dfa(NULL, dfa, signature);
+	initialFate = fates[dfa->initialStateId];
+	free(fates);
+	if (initialFate == DFA_FATE_OPEN)
+		return 0;
+
+	say(MSG_REPORT_VAR("Constant Matcher", "%d", initialFate == DFA_FATE_UNIVERSAL));
+	private_toSignatureStream_dfa(dfa, stream, signature);
+	if (signature == DFA_SIGNATURE_BATCH)
+		fprintf(stream, "\tsize_t i;\n\t(void)bufs;\n\t(void)lens;\n\tfor (i = 0; i < n; i++)\n\t\tresults[i] = %d;\n}", initialFate == DFA_FATE_UNIVERSAL);
+	else if (signature == DFA_SIGNATURE_BUFFER)
+		fprintf(stream, "\t(void)buf;\n\t(void)len;\n\treturn %d;\n}", initialFate == DFA_FATE_UNIVERSAL);
+	else
+		fprintf(stream, "\t(void)str;\n\treturn %d;\n}", initialFate == DFA_FATE_UNIVERSAL);
+
+	return 1;
+}
+
+/** \brief Writes a goto-driven C matcher of a DeterministicFiniteAutomaton to a string.
+ ** \param str The string, of at least BUFFER_LARGE_SIZE characters
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param signature The signature of the generated function
+ ** \returns A pointer to the string.
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Batches get a table-driven matcher instead. Only suitable for small
+ ** automata, use toStream_dfa() for the others.
+ **/
+char* toC_dfa(char* str, const DeterministicFiniteAutomaton* dfa, const DFASignature signature)
+{
+	DECLARE_FUNCTION(toC_dfa);
+
+	/* Variable declaration. */
+	FILE* stream;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+
+	unless (str)
+		SAFE_MALLOC(str, char, BUFFER_LARGE_SIZE);
+
+	stream = fmemopen(str, BUFFER_LARGE_SIZE, "w");
+	ASSERT_NOT_NULL(stream);
+	toStream_dfa(dfa, stream, DFA_BACKEND_GOTO, signature);
+	fflush(stream);
+	errorIf(ferror(stream), MSG_ERROR_OVERFLOW(str, BUFFER_LARGE_SIZE));
+	fclose(stream);
+
+	ASSERT_NOT_NULL(str);
+	ASSERT_NOT_EMPTY(str);
+	ASSERT_NOT_TOO_LONG(str, BUFFER_LARGE_SIZE);
+
+	return str;
+}
+
+/** \brief Returns the narrowest unsigned C type that can hold every state index.
+ ** \param nStates The number of states, including the dead state
+ ** \returns The name of the type.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+const char* private_stateType_dfa(const unsigned long nStates)
+{
+	if (nStates <= 256UL)
+		return "unsigned char";
+	else if (nStates <= 65536UL)
+		return "unsigned short";
+	else
+		return "unsigned int";
+}
+
+/** \brief Redirects a transition of a table-driven matcher to the terminal states.
+ ** \param sinkId The sink of the transition, or DFA_NO_STATE
+ ** \param fates The DFAFate of every state
+ ** \param deadId The id of the dead state
+ ** \param universalId The id of the universal state
+ ** \returns The dead state for missing and dead sinks, the universal state for universal sinks, the sink otherwise.
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+DFAStateId private_terminalOf_dfa(const DFAStateId sinkId, const DFAFate* fates, const DFAStateId deadId, const DFAStateId universalId)
+{
+	if (sinkId == DFA_NO_STATE || fates[sinkId] == DFA_FATE_DEAD)
+		return deadId;
+	else if (fates[sinkId] == DFA_FATE_UNIVERSAL)
+		return universalId;
+	else
+		return sinkId;
+}
+
+/** \brief Writes a table-driven C matcher of a DeterministicFiniteAutomaton to a stream.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** Missing transitions, symbols outside the alphabet and dead states lead to
+ ** an extra dead state, appended after the last state of the DFA, universal
+ ** states to an extra universal state appended after it. The scan stops on
+ ** either. The table has one column per byte class instead of one column per
+ ** byte.
+ **/
+void private_toTableStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toTableStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int k;
+	DFAStateId deadId, universalId, initialId, sinkId;
+	const char* type;
+	const DFAState* state;
+	DFAFate* fates;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	fates = toFates_dfa(NULL, dfa, signature);
+
+	/* The universal state comes right after the dead state, if any state is universal. */
+	deadId = dfa->states->nStates;
+	universalId = DFA_NO_STATE;
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+		if (fates[state->id] == DFA_FATE_UNIVERSAL)
+			universalId = deadId + 1;
+	initialId = private_terminalOf_dfa(dfa->initialStateId, fates, deadId, universalId);
+	type = private_stateType_dfa(deadId + (universalId == DFA_NO_STATE ? 1UL : 2UL));
+
+	say(MSG_REPORT_VAR("Table Type", "%s", type));
+	say(MSG_REPORT_VAR("Byte Classes", "%u", classes->nClasses));
+	private_toSignatureStream_dfa(dfa, stream, signature);
+
+	/* Map every byte to its class. */
+	private_toClassMapStream_dfa(classes, stream);
+
+	/* Accepting states. */
+	fprintf(stream, "\tstatic const unsigned char accept[%u] = {", universalId == DFA_NO_STATE ? deadId + 1 : universalId + 1);
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+		fprintf(stream, "%d,", state->isAccept ? 1 : 0);
+	fprintf(stream, universalId == DFA_NO_STATE ? "0};\n" : "0,1};\n");
+
+	/* Transition table, one row per state and one column per byte class. */
+	fprintf(stream, "\tstatic const %s table[%u][%u] = {\n", type, universalId == DFA_NO_STATE ? deadId + 1 : universalId + 1, classes->nClasses);
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+	{
+		ASSERT_DFASTATE(state);
+		say(MSG_REPORT_VAR("Implementing", "%s", state->name));
+		fprintf(stream, "\t\t/* %s */ {", state->name);
+		for (k = 0; k < classes->nClasses; k++) {
+			sinkId = private_terminalOf_dfa(dfa->transitions[state->id][classes->representatives[k]], fates, deadId, universalId);
+			fprintf(stream, k ? ",%u" : "%u", sinkId);
+		}
+		fprintf(stream, "},\n");
+	}
+
+	/* The dead and universal states loop to themselves. */
+	fprintf(stream, "\t\t/* dead */ {");
+	for (k = 0; k < classes->nClasses; k++)
+		fprintf(stream, k ? ",%u" : "%u", deadId);
+	if (universalId != DFA_NO_STATE) {
+		fprintf(stream, "},\n\t\t/* universal */ {");
+		for (k = 0; k < classes->nClasses; k++)
+			fprintf(stream, k ? ",%u" : "%u", universalId);
+	}
+	fprintf(stream, "}\n\t};\n");
+
+	/* Lanes of buffers advancing in lockstep, refilled as they finish. */
+	if (signature == DFA_SIGNATURE_BATCH) {
+		fprintf(stream, "\tconst unsigned char* ptr[%u];\n\tsize_t remaining[%u];\n\tsize_t index[%u];\n\tunsigned int s[%u];\n", DFA_BATCH_WIDTH, DFA_BATCH_WIDTH, DFA_BATCH_WIDTH, DFA_BATCH_WIDTH);
+		fprintf(stream, "\tsize_t i, m, next = 0;\n\tunsigned int l, nLanes = 0;\n");
+		fprintf(stream, "\tfor (;;) {\n");
+		fprintf(stream, "\t\tfor (; nLanes < %u && next < n; nLanes++, next++) {\n", DFA_BATCH_WIDTH);
+		fprintf(stream, "\t\t\tptr[nLanes] = bufs[next];\n\t\t\tremaining[nLanes] = lens[next];\n\t\t\tindex[nLanes] = next;\n\t\t\ts[nLanes] = %u;\n\t\t}\n", initialId);
+		fprintf(stream, "\t\tif (!nLanes)\n\t\t\treturn;\n");
+		fprintf(stream, "\t\tfor (m = remaining[0], l = 1; l < nLanes; l++)\n\t\t\tif (remaining[l] < m)\n\t\t\t\tm = remaining[l];\n");
+		fprintf(stream, "\t\tfor (i = 0; i < m; i++)\n\t\t\tfor (l = 0; l < nLanes; l++)\n\t\t\t\ts[l] = table[s[l]][classOf[ptr[l][i]]];\n");
+		fprintf(stream, "\t\tfor (l = 0; l < nLanes; l++) {\n\t\t\tptr[l] += m;\n\t\t\tremaining[l] -= m;\n\t\t}\n");
+		fprintf(stream, "\t\tfor (l = 0; l < nLanes; ) {\n");
+		fprintf(stream, "\t\t\tif (remaining[l] && s[l] < %u) {\n\t\t\t\tl++;\n\t\t\t\tcontinue;\n\t\t\t}\n", deadId);
+		fprintf(stream, "\t\t\tresults[index[l]] = accept[s[l]];\n\t\t\tnLanes--;\n");
+		fprintf(stream, "\t\t\tptr[l] = ptr[nLanes];\n\t\t\tremaining[l] = remaining[nLanes];\n\t\t\tindex[l] = index[nLanes];\n\t\t\ts[l] = s[nLanes];\n");
+		fprintf(stream, "\t\t}\n\t}\n}");
+		free(fates);
+		return;
+	}
+
+	/* One class lookup and one table load per input byte, until a terminal state. */
+	fprintf(stream, "\tunsigned int s = %u;\n", initialId);
+	if (signature == DFA_SIGNATURE_BUFFER) {
+		fprintf(stream, "\tconst unsigned char* end;\n");
+		fprintf(stream, "\tif (!buf)\n\t\treturn 0;\n");
+		fprintf(stream, "\tfor (end = buf + len; buf < end && s < %u; buf++)\n\t\ts = table[s][classOf[*buf]];\n", deadId);
+	} else {
+		fprintf(stream, "\tunsigned char c;\n");
+		fprintf(stream, "\tif (!str)\n\t\treturn 0;\n");
+		fprintf(stream, "\twhile (s < %u && (c = (unsigned char)*str++))\n\t\ts = table[s][classOf[c]];\n", deadId);
+	}
+	fprintf(stream, "\treturn accept[s];\n}");
+	free(fates);
+}
+
+/** \brief Writes a C matcher of a DeterministicFiniteAutomaton that advances every state at once with byte shuffles.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param signature The signature of the generated function, DFA_SIGNATURE_STRING or DFA_SIGNATURE_BUFFER
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The rows are those of the table backend, padded to DFA_SHUFFLE_STATES with
+ ** rows that map to themselves. Each byte class becomes a vector holding the
+ ** successor of every row, and a vector holding the row reached from every
+ ** row is composed with it by one pshufb per byte. Composition is associative:
+ ** buffers are cut into blocks of DFA_SHUFFLE_BLOCK bytes, each split into
+ ** DFA_SHUFFLE_LANES parts scanned side by side and composed at the end, and
+ ** the scan stops between blocks on a terminal state. Pshufb needs SSSE3, the
+ ** table-driven matcher is emitted as the fallback; it is also emitted alone
+ ** if the rows do not fit in a vector.
+ **/
+void private_toShuffleStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toShuffleStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int i, k, nRows;
+	DFAStateId deadId, universalId, initialId, sinkId;
+	const DFAState* state;
+	DFAFate* fates;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	fates = toFates_dfa(NULL, dfa, signature);
+
+	/* Same rows as the table backend. */
+	deadId = dfa->states->nStates;
+	universalId = DFA_NO_STATE;
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+		if (fates[state->id] == DFA_FATE_UNIVERSAL)
+			universalId = deadId + 1;
+	initialId = private_terminalOf_dfa(dfa->initialStateId, fates, deadId, universalId);
+	nRows = universalId == DFA_NO_STATE ? deadId + 1 : universalId + 1;
+	if (nRows > DFA_SHUFFLE_STATES) {
+		warning(MSG_REPORT_VAR("Too Many States For Shuffles", "%u", nRows));
+		free(fates);
+		private_toTableStream_dfa(dfa, stream, signature);
+		return;
+	}
+
+	say(MSG_REPORT_VAR("Byte Classes", "%u", classes->nClasses));
+	fprintf(stream, "#if defined(__SSSE3__)\n#include <tmmintrin.h>\n");
+	private_toSignatureStream_dfa(dfa, stream, signature);
+
+	/* Map every byte to its class. */
+	private_toClassMapStream_dfa(classes, stream);
+
+	/* Accepting rows. */
+	fprintf(stream, "\tstatic const unsigned char accept[%u] = {", DFA_SHUFFLE_STATES);
+	for (i = 0; i < DFA_SHUFFLE_STATES; i++)
+		fprintf(stream, i ? ",%d" : "%d", i < dfa->states->nStates ? dfa->states->array[i].isAccept : (DFAStateId)i == universalId);
+	fprintf(stream, "};\n");
+
+	/* One vector per byte class, giving the successor of every row. */
+	fprintf(stream, "\tstatic const unsigned char shuffles[%u][%u] = {\n", classes->nClasses, DFA_SHUFFLE_STATES);
+	for (k = 0; k < classes->nClasses; k++) {
+		fprintf(stream, "\t\t{");
+		for (i = 0; i < DFA_SHUFFLE_STATES; i++) {
+			sinkId = i < dfa->states->nStates ? private_terminalOf_dfa(dfa->transitions[i][classes->representatives[k]], fates, deadId, universalId) : i;
+			fprintf(stream, i ? ",%u" : "%u", sinkId);
+		}
+		fprintf(stream, k + 1 < classes->nClasses ? "},\n" : "}\n");
+	}
+	fprintf(stream, "\t};\n");
+
+	if (signature == DFA_SIGNATURE_BUFFER) {
+		fprintf(stream, "\t__m128i lanes[%u];\n\tunsigned char map[%u];\n", DFA_SHUFFLE_LANES, DFA_SHUFFLE_STATES);
+		fprintf(stream, "\tconst unsigned char* stop;\n\tconst unsigned char* end;\n\tsize_t i, laneSize;\n\tunsigned int l, s = %u;\n", initialId);
+		fprintf(stream, "\tif (!buf)\n\t\treturn 0;\n");
+		fprintf(stream, "\tfor (end = buf + len; buf < end && s < %u; buf = stop) {\n", deadId);
+		fprintf(stream, "\t\tstop = (size_t)(end - buf) > %u ? buf + %u : end;\n", DFA_SHUFFLE_BLOCK, DFA_SHUFFLE_BLOCK);
+		fprintf(stream, "\t\tlaneSize = (size_t)(stop - buf) / %u;\n", DFA_SHUFFLE_LANES);
+		fprintf(stream, "\t\tfor (l = 0; l < %u; l++)\n\t\t\tlanes[l] = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);\n", DFA_SHUFFLE_LANES);
+		fprintf(stream, "\t\tfor (i = 0; i < laneSize; i++)\n\t\t\tfor (l = 0; l < %u; l++)\n", DFA_SHUFFLE_LANES);
+		fprintf(stream, "\t\t\t\tlanes[l] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)shuffles[classOf[buf[l * laneSize + i]]]), lanes[l]);\n");
+		fprintf(stream, "\t\tfor (l = 1; l < %u; l++)\n\t\t\tlanes[0] = _mm_shuffle_epi8(lanes[l], lanes[0]);\n", DFA_SHUFFLE_LANES);
+		fprintf(stream, "\t\tfor (i = %u * laneSize; buf + i < stop; i++)\n", DFA_SHUFFLE_LANES);
+		fprintf(stream, "\t\t\tlanes[0] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)shuffles[classOf[buf[i]]]), lanes[0]);\n");
+		fprintf(stream, "\t\t_mm_storeu_si128((__m128i*)map, lanes[0]);\n\t\ts = map[s];\n\t}\n\treturn accept[s];\n}\n");
+	} else {
+		fprintf(stream, "\t__m128i v = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);\n\tunsigned char map[%u];\n\tunsigned char c;\n", DFA_SHUFFLE_STATES);
+		fprintf(stream, "\tif (!str)\n\t\treturn 0;\n");
+		fprintf(stream, "\twhile ((c = (unsigned char)*str++))\n\t\tv = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)shuffles[classOf[c]]), v);\n");
+		fprintf(stream, "\t_mm_storeu_si128((__m128i*)map, v);\n\treturn accept[map[%u]];\n}\n", initialId);
+	}
+	fprintf(stream, "#else\n");
+	free(fates);
+
+	/* Portable fallback. */
+	private_toTableStream_dfa(dfa, stream, signature);
+	fprintf(stream, "\n#endif");
+}
+
+/** \brief Writes a DeterministicFiniteAutomaton to a stream as a C function.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \param backend The shape of the generated code
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void toStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream, const DFABackend backend, const DFASignature signature)
+{
+	DECLARE_FUNCTION(toStream_dfa);
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	/* Nothing to read if the initial state decides. */
+	if (private_toConstantStream_dfa(dfa, stream, signature)) {
+		fflush(stream);
+		return;
+	}
+
+	/* Only the table backend matches batches. */
+	switch (signature == DFA_SIGNATURE_BATCH ? DFA_BACKEND_TABLE : backend) {
+		case DFA_BACKEND_TABLE:
+			private_toTableStream_dfa(dfa, stream, signature);
+			break;
+		case DFA_BACKEND_COMPUTED_GOTO:
+			private_toComputedGotoStream_dfa(dfa, stream, signature);
+			break;
+		case DFA_BACKEND_SHUFFLE:
+			private_toShuffleStream_dfa(dfa, stream, signature);
+			break;
+		case DFA_BACKEND_GOTO:
+		default:
+			private_toGotoStream_dfa(dfa, stream, signature);
+			break;
+	}
+
+	/* Flush the stream. */
+	fflush(stream);
+}
+
+/** \brief Writes a DeterministicFiniteAutomaton to a C file with a specified filename.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param filename Name of the output file
+ ** \param backend The shape of the generated code
+ ** \param signature The signature of the generated function
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void toFile_dfa(const DeterministicFiniteAutomaton* dfa, const char* filename, const DFABackend backend, const DFASignature signature)
+{
+	DECLARE_FUNCTION(toFile_dfa);
+
+	/* Variable declaration. */
+	FILE* fp;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(filename);
+	ASSERT_NOT_EMPTY(filename);
+
+	/* Open the file for writing. */
+	SAFE_FOPEN(fp, filename, "w");
+
+	/* Write the automaton to the file stream. */
+	toStream_dfa(dfa, fp, backend, signature);
+
+	/* Close the file. */
+	fclose(fp);
+}
+
+/** \brief Writes the rows of the table backend for one signature to a stream, as a C++ namespace of constexpr tables.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param classes The byte classes of the DFA
+ ** \param stream The target stream
+ ** \param signature DFA_SIGNATURE_STRING or DFA_SIGNATURE_BUFFER
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The fates depend on the signature, since NUL ends a string but not a
+ ** buffer, so each matcher gets its own namespace, string or buffer.
+ **/
+void private_toHppRowsStream_dfa(const DeterministicFiniteAutomaton* dfa, const DFAByteClasses* classes, FILE* stream, const DFASignature signature)
+{
+	DECLARE_FUNCTION(private_toHppRowsStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int k;
+	DFAStateId deadId, universalId, sinkId;
+	const DFAState* state;
+	DFAFate* fates;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	ASSERT_NOT_NULL(stream);
+
+	fates = toFates_dfa(NULL, dfa, signature);
+
+	/* The universal state comes right after the dead state, if any state is universal. */
+	deadId = dfa->states->nStates;
+	universalId = DFA_NO_STATE;
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+		if (fates[state->id] == DFA_FATE_UNIVERSAL)
+			universalId = deadId + 1;
+
+	fprintf(stream, "\tnamespace %s {\n", signature == DFA_SIGNATURE_BUFFER ? "buffer" : "string");
+	fprintf(stream, "\t\tconstexpr std::size_t nStates = %u;\n", universalId == DFA_NO_STATE ? deadId + 1 : universalId + 1);
+	fprintf(stream, "\t\ttypedef state_of<nStates>::type state;\n\t\tconstexpr state initial = %u;\n\t\tconstexpr state dead = %u;\n", private_terminalOf_dfa(dfa->initialStateId, fates, deadId, universalId), deadId);
+
+	/* Accepting states. */
+	fprintf(stream, "\t\tconstexpr bool accept[nStates] = {");
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+		fprintf(stream, "%s,", state->isAccept ? "true" : "false");
+	fprintf(stream, universalId == DFA_NO_STATE ? "false};\n" : "false,true};\n");
+
+	/* Transition table, one row per state and one column per byte class. */
+	fprintf(stream, "\t\tconstexpr state table[nStates][nClasses] = {\n");
+	for (state = dfa->states->array; state < dfa->states->array + dfa->states->nStates; state++)
+	{
+		ASSERT_DFASTATE(state);
+		fprintf(stream, "\t\t\t/* %s */ {", state->name);
+		for (k = 0; k < classes->nClasses; k++) {
+			sinkId = private_terminalOf_dfa(dfa->transitions[state->id][classes->representatives[k]], fates, deadId, universalId);
+			fprintf(stream, k ? ",%u" : "%u", sinkId);
+		}
+		fprintf(stream, "},\n");
+	}
+
+	/* The dead and universal states loop to themselves. */
+	fprintf(stream, "\t\t\t/* dead */ {");
+	for (k = 0; k < classes->nClasses; k++)
+		fprintf(stream, k ? ",%u" : "%u", deadId);
+	if (universalId != DFA_NO_STATE) {
+		fprintf(stream, "},\n\t\t\t/* universal */ {");
+		for (k = 0; k < classes->nClasses; k++)
+			fprintf(stream, k ? ",%u" : "%u", universalId);
+	}
+	fprintf(stream, "}\n\t\t};\n\t}\n");
+	free(fates);
+}
+
+/** \brief Writes a DeterministicFiniteAutomaton to a stream as a C++ header of constexpr tables and matchers.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param stream The target stream
+ ** \memberof DeterministicFiniteAutomaton
+ **
+ ** The tables live in the namespace <name>_dfa, with the rows of the table
+ ** backend for each signature: missing transitions, symbols outside the
+ ** alphabet and dead states lead to an extra dead state, universal states
+ ** to an extra universal state, and the scan stops on either. The state type
+ ** is picked by a specialization of state_of on the number of rows. The two
+ ** matchers, one for NUL-terminated strings and one for buffers, are
+ ** constexpr (C++14) so that they fold into constant expressions and
+ ** static_assert, and inline into their callers otherwise.
+ **/
+void toHppStream_dfa(const DeterministicFiniteAutomaton* dfa, FILE* stream)
+{
+	DECLARE_FUNCTION(toHppStream_dfa);
+
+	/* Variable declarations. */
+	unsigned int b;
+	const char* c;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(stream);
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	say(MSG_REPORT_VAR("Function", "%s", dfa->name));
+	say(MSG_REPORT_VAR("Byte Classes", "%u", classes->nClasses));
+
+	/* Include guard. */
+	fprintf(stream, "#ifndef ");
+	for (c = dfa->name; *c; c++)
+		fputc(toupper((unsigned char)*c), stream);
+	fprintf(stream, "_HPP\n#define ");
+	for (c = dfa->name; *c; c++)
+		fputc(toupper((unsigned char)*c), stream);
+	fprintf(stream, "_HPP\n#include <cstddef>\n#include <cstdint>\n\nnamespace %s_dfa {\n", dfa->name);
+
+	/* The narrowest state type, chosen at compile time. */
+	fprintf(stream, "\ttemplate <std::size_t N, bool = (N <= 0x100), bool = (N <= 0x10000)>\n\tstruct state_of { typedef std::uint_least32_t type; };\n");
+	fprintf(stream, "\ttemplate <std::size_t N>\n\tstruct state_of<N, false, true> { typedef std::uint_least16_t type; };\n");
+	fprintf(stream, "\ttemplate <std::size_t N>\n\tstruct state_of<N, true, true> { typedef std::uint_least8_t type; };\n\n");
+	fprintf(stream, "\tconstexpr std::size_t nClasses = %u;\n", classes->nClasses);
+
+	/* Map every byte to its class. */
+	fprintf(stream, "\tconstexpr unsigned char classOf[%u] = {", DFA_MAX_SYMBOLS);
+	for (b = 0; b < DFA_MAX_SYMBOLS; b++)
+		fprintf(stream, b ? ",%u" : "%u", classes->classOf[b]);
+	fprintf(stream, "};\n\n");
+
+	private_toHppRowsStream_dfa(dfa, classes, stream, DFA_SIGNATURE_STRING);
+	fprintf(stream, "\n");
+	private_toHppRowsStream_dfa(dfa, classes, stream, DFA_SIGNATURE_BUFFER);
+	fprintf(stream, "}\n\n");
+
+	/* One class lookup and one table load per input byte, until a terminal state. */
+	fprintf(stream, "constexpr bool %s(const char* str) noexcept\n{\n", dfa->name);
+	fprintf(stream, "\t%s_dfa::string::state s = %s_dfa::string::initial;\n\tif (!str)\n\t\treturn false;\n", dfa->name, dfa->name);
+	fprintf(stream, "\tfor (; s < %s_dfa::string::dead && *str; str++)\n", dfa->name);
+	fprintf(stream, "\t\ts = %s_dfa::string::table[s][%s_dfa::classOf[static_cast<unsigned char>(*str)]];\n", dfa->name, dfa->name);
+	fprintf(stream, "\treturn %s_dfa::string::accept[s];\n}\n\n", dfa->name);
+	fprintf(stream, "constexpr bool %s(const char* buf, std::size_t len) noexcept\n{\n", dfa->name);
+	fprintf(stream, "\t%s_dfa::buffer::state s = %s_dfa::buffer::initial;\n\tif (!buf)\n\t\treturn false;\n", dfa->name, dfa->name);
+	fprintf(stream, "\tfor (std::size_t i = 0; s < %s_dfa::buffer::dead && i < len; i++)\n", dfa->name);
+	fprintf(stream, "\t\ts = %s_dfa::buffer::table[s][%s_dfa::classOf[static_cast<unsigned char>(buf[i])]];\n", dfa->name, dfa->name);
+	fprintf(stream, "\treturn %s_dfa::buffer::accept[s];\n}\n#endif\n", dfa->name);
+
+	/* Flush the stream. */
+	fflush(stream);
+}
+
+/** \brief Writes a DeterministicFiniteAutomaton to a C++ header with a specified filename.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param filename Name of the output file
+ ** \memberof DeterministicFiniteAutomaton
+ **/
+void toHppFile_dfa(const DeterministicFiniteAutomaton* dfa, const char* filename)
+{
+	DECLARE_FUNCTION(toHppFile_dfa);
+
+	/* Variable declaration. */
+	FILE* fp;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(filename);
+	ASSERT_NOT_EMPTY(filename);
+
+	/* Open the file for writing. */
+	SAFE_FOPEN(fp, filename, "w");
+
+	/* Write the automaton to the file stream. */
+	toHppStream_dfa(dfa, fp);
+
+	/* Close the file. */
+	fclose(fp);
 }
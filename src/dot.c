@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "arena.h"
 #include "debug.h"
 #include "dot.h"
 #include "stdioplus.h"
@@ -98,20 +99,28 @@ Graph* beautify_dot(Graph* G)
 
 /** \brief Initializes a given Graph or creates it from scratch.
  ** \param G The Graph
+ ** \param arena The Arena the Graph allocates from
  ** \returns A pointer to the Graph.
  ** \memberof Graph
  **/
-Graph* initialize_dot(Graph* G)
+Graph* initialize_dot(Graph* G, Arena* arena)
 {
 	DECLARE_FUNCTION(initialize_dot);
 
 	char* check;
 
-	unless (G)
-		SAFE_MALLOC(G, Graph, 1);
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	unless (G) {
+		SAFE_ARENA_MALLOC(G, arena, Graph, 1);
+	}
+	G->arena = arena;
 
  	/* Start with no nodes and no clusters. */
+	G->nodes = NULL;
 	G->size = 0;
+	G->capacity = 0;
 	G->nClusters = 0;
 
 	/* Initialize the default name. */
@@ -194,6 +203,18 @@ Node* insertNode_dot(Graph* G, const SubGraphId clusterId)
 	ASSERT_GRAPH(G);
 	ASSERT_FITS_IN_BOUND(clusterId, G->nClusters);
 
+	/* Make room for one more node. */
+	if (G->size == G->capacity) {
+		SAFE_ARENA_REALLOC(
+			G->nodes,
+			G->arena,
+			Node,
+			G->capacity,
+			(G->capacity ? 2 * G->capacity : DOT_INITIAL_NODES)
+		);
+		G->capacity = G->capacity ? 2 * G->capacity : DOT_INITIAL_NODES;
+	}
+
 	/* Initialize the node pointer. */
 	nid = G->size;
 	node = G->nodes + nid;
@@ -212,13 +233,15 @@ Node* insertNode_dot(Graph* G, const SubGraphId clusterId)
 	ASSERT_NOT_EMPTY(check);
 
 	/* Initialize the default name. */
+	SAFE_ARENA_MALLOC(check, G->arena, char, DOT_MAX_NAME_SIZE);
 	check = fromPattern
 	(
-		node->name,
+		check,
 		DOT_MAX_NAME_SIZE,
 		DOT_DEFAULT_NODE_NAME(nid)
 	);
 	ASSERT_NOT_NULL(check);
+	node->name = check;
 
 	/* Initialize the default label. */
 	check = fromPattern
@@ -229,8 +252,10 @@ Node* insertNode_dot(Graph* G, const SubGraphId clusterId)
 	);
 	ASSERT_NOT_NULL(check);
 
-	/* Initialize the number of edges in Node. */
+	/* Initialize the edges of Node. */
+	node->edges = NULL;
 	node->nEdges = 0;
+	node->edgeCapacity = 0;
 
 	/* Register the node to the given cluster. */
 	unless (clusterId < 0) {
@@ -281,9 +306,21 @@ Edge* insertEdge_dot(Graph* G, const NodeId from, const NodeId to)
 	sink = G->nodes + to;
 	ASSERT_NODE(sink);
 
+	/* Make room for one more edge. */
+	if (source->nEdges == source->edgeCapacity) {
+		SAFE_ARENA_REALLOC(
+			source->edges,
+			G->arena,
+			Edge,
+			source->edgeCapacity,
+			(source->edgeCapacity ? 2 * source->edgeCapacity : DOT_INITIAL_EDGES)
+		);
+		source->edgeCapacity = source->edgeCapacity ? 2 * source->edgeCapacity : DOT_INITIAL_EDGES;
+	}
+
 	/* Initialize the edge pointer. */
 	edge = source->edges + source->nEdges;
-	ASSERT_EDGE(edge);
+	ASSERT_NOT_NULL(edge);
 
 	/* Initialize the label. */
 	check = fromPattern
@@ -351,12 +388,14 @@ void toStream_dot(const Graph* G, FILE* stream)
 	NodeId nid;
 	EdgeId eid;
 	unsigned int size, i;
-	char isNodeProcessed[DOT_MAX_NODES] = {0};
+	char* isNodeProcessed;
 
 	/* Checks. */
 	ASSERT_GRAPH(G);
 	ASSERT_NOT_NULL(stream);
 
+	SAFE_CALLOC(isNodeProcessed, char, (G->size + 1));
+
 	/* Write the header and put the start symbol. */
 	fprintf(stream, DOT_HEADER(G));
 
@@ -448,6 +487,8 @@ void toStream_dot(const Graph* G, FILE* stream)
 	/* Put the end symbol. */
 	fprintf(stream, "%c\n", DOT_END_SYMBOL);
 
+	free(isNodeProcessed);
+
 	/* Flush the stream. */
 	fflush(stream);
 }
@@ -1,14 +1,16 @@
 /** \file hash.c
  ** \brief Implements the hash() function
  **/
+#include <stddef.h>
 #include "debug.h"
+#include "hash.h"
 
 DECLARE_SOURCE("HASH");
 
 /** \brief Calculates the hash of a given string
  ** \param str A constant string
  ** \returns An unsigned long integer
- ** \related HashTable
+ ** \related InternTable
  **
  ** This hash function is faster than many of its alternatives.
  **/
@@ -28,3 +30,26 @@ unsigned long hash(const char* str)
 
 	return hash;
 }
+
+/** \brief Calculates the hash of a given slice
+ ** \param str The beginning of the slice
+ ** \param len The length of the slice
+ ** \returns An unsigned long integer, equal to hash() of the same string
+ ** \related InternTable
+ **/
+unsigned long hashSlice(const char* str, const size_t len)
+{
+	DECLARE_FUNCTION(hashSlice);
+
+	/* Variable declarations. */
+	unsigned long hash;
+	const char* end;
+
+	/* Check. */
+	ASSERT_NOT_NULL(str);
+
+	/* hash = hash * 33 + c */
+	for (hash = 5381, end = str + len; str < end; hash = ((hash << 5) + hash) + *str++);
+
+	return hash;
+}
@@ -0,0 +1,186 @@
+/** \file intern.c
+ ** \brief Implements InternTable and its member functions.
+ **/
+#include <string.h>
+#include "arena.h"
+#include "debug.h"
+#include "hash.h"
+#include "intern.h"
+#include "unless.h"
+
+DECLARE_SOURCE("INTERN");
+
+/** \brief Returns the first slot of a hash in an InternTable.
+ **/
+#define INTERN_HOME(table,hashValue) (((hashValue) ^ ((hashValue) >> 16)) & ((table)->capacity - 1))
+
+/** \brief Returns the slot of a string in an InternTable, or the empty slot it would go to.
+ ** \related InternTable
+ **/
+InternId* private_find_it(const InternTable* table, const char* str, const size_t len, const unsigned long hashValue)
+{
+	/* Variable declaration. */
+	unsigned int slot;
+
+	for (
+		slot = INTERN_HOME(table, hashValue);
+		table->slots[slot] != INTERN_NONE;
+		slot = (slot + 1) & (table->capacity - 1)
+	) {
+		if (
+			table->hashes[table->slots[slot]] == hashValue
+			&& !strncmp(table->strings[table->slots[slot]], str, len)
+			&& table->strings[table->slots[slot]][len] == '\0'
+		)
+			break;
+	}
+
+	return table->slots + slot;
+}
+
+/** \brief Doubles the number of slots of an InternTable.
+ ** \related InternTable
+ **/
+void private_grow_it(InternTable* table)
+{
+	DECLARE_FUNCTION(private_grow_it);
+
+	/* Variable declarations. */
+	InternId id;
+	unsigned int slot;
+
+	/* The old slots stay in the Arena until it is finalized. */
+	table->capacity *= 2;
+	SAFE_ARENA_MALLOC(table->slots, table->arena, InternId, table->capacity);
+	memset(table->slots, 0xFF, table->capacity * sizeof(InternId));
+
+	for (id = 0; id < table->nStrings; id++) {
+		for (
+			slot = INTERN_HOME(table, table->hashes[id]);
+			table->slots[slot] != INTERN_NONE;
+			slot = (slot + 1) & (table->capacity - 1)
+		);
+		table->slots[slot] = id;
+	}
+}
+
+/** \brief Initializes a given InternTable or creates it from scratch.
+ ** \param table The InternTable
+ ** \param arena The Arena holding the strings and the slots
+ ** \returns A pointer to the InternTable.
+ ** \memberof InternTable
+ **/
+InternTable* initialize_it(InternTable* table, Arena* arena)
+{
+	DECLARE_FUNCTION(initialize_it);
+
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	unless (table) {
+		SAFE_ARENA_MALLOC(table, arena, InternTable, 1);
+	}
+	table->arena = arena;
+
+	table->strings = NULL;
+	table->hashes = NULL;
+	table->nStrings = 0;
+	table->stringCapacity = 0;
+
+	/* INTERN_NONE is all ones, so every slot starts empty. */
+	table->capacity = INTERN_INITIAL_CAPACITY;
+	SAFE_ARENA_MALLOC(table->slots, arena, InternId, table->capacity);
+	memset(table->slots, 0xFF, table->capacity * sizeof(InternId));
+
+	ASSERT_INTERNTABLE(table);
+	return table;
+}
+
+/** \brief Returns the InternId of a slice, interning it if it is new.
+ ** \param table The InternTable
+ ** \param str The beginning of the slice
+ ** \param len The length of the slice
+ ** \returns The InternId, equal to the previous number of strings if the slice is new.
+ ** \memberof InternTable
+ **/
+InternId intern_it(InternTable* table, const char* str, const size_t len)
+{
+	DECLARE_FUNCTION(intern_it);
+
+	/* Variable declarations. */
+	unsigned long hashValue;
+	InternId* slot;
+
+	/* Checks. */
+	ASSERT_INTERNTABLE(table);
+	ASSERT_NOT_NULL(str);
+
+	hashValue = hashSlice(str, len);
+	slot = private_find_it(table, str, len, hashValue);
+	unless (*slot == INTERN_NONE)
+		return *slot;
+
+	/* A new string. */
+	if (table->nStrings == table->stringCapacity) {
+		SAFE_ARENA_REALLOC(
+			table->strings,
+			table->arena,
+			const char*,
+			table->stringCapacity,
+			(table->stringCapacity ? 2 * table->stringCapacity : INTERN_INITIAL_CAPACITY)
+		);
+		SAFE_ARENA_REALLOC(
+			table->hashes,
+			table->arena,
+			unsigned long,
+			table->stringCapacity,
+			(table->stringCapacity ? 2 * table->stringCapacity : INTERN_INITIAL_CAPACITY)
+		);
+		table->stringCapacity = table->stringCapacity ? 2 * table->stringCapacity : INTERN_INITIAL_CAPACITY;
+	}
+	table->strings[table->nStrings] = fromSlice_arena(table->arena, str, len);
+	table->hashes[table->nStrings] = hashValue;
+	*slot = table->nStrings++;
+
+	/* Keep at least half of the slots empty. */
+	if (2 * table->nStrings > table->capacity)
+		private_grow_it(table);
+
+	ASSERT_INTERNTABLE(table);
+	return table->nStrings - 1;
+}
+
+/** \brief Returns the InternId of a slice without interning it.
+ ** \param table The InternTable
+ ** \param str The beginning of the slice
+ ** \param len The length of the slice
+ ** \returns The InternId, INTERN_NONE if the slice was never interned.
+ ** \memberof InternTable
+ **/
+InternId find_it(const InternTable* table, const char* str, const size_t len)
+{
+	DECLARE_FUNCTION(find_it);
+
+	/* Checks. */
+	ASSERT_INTERNTABLE(table);
+	ASSERT_NOT_NULL(str);
+
+	return *private_find_it(table, str, len, hashSlice(str, len));
+}
+
+/** \brief Returns the string of an InternId.
+ ** \param table The InternTable
+ ** \param id The InternId
+ ** \returns The string, valid as long as the Arena of the InternTable.
+ ** \memberof InternTable
+ **/
+const char* toString_it(const InternTable* table, const InternId id)
+{
+	DECLARE_FUNCTION(toString_it);
+
+	/* Checks. */
+	ASSERT_INTERNTABLE(table);
+	ASSERT_FITS_IN_BOUND(id, table->nStrings);
+
+	return table->strings[id];
+}
@@ -0,0 +1,266 @@
+/** \file jit.c
+ ** \brief Implements DFAJit and its member functions.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "dfa.h"
+#include "jit.h"
+#include "match.h"
+#include "stdlibplus.h"
+#include "unless.h"
+#ifdef DFA_JIT_X86_64
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+DECLARE_SOURCE("JIT");
+
+#ifdef DFA_JIT_X86_64
+/** \brief The size of the code entering the initial state.
+ **/
+#define DFA_JIT_PROLOGUE_SIZE 24
+
+/** \brief The size of the code of one open state.
+ **/
+#define DFA_JIT_BLOCK_SIZE 30
+
+/** \brief The size of the code returning 0 then 1.
+ **/
+#define DFA_JIT_EXITS_SIZE 9
+
+/** \brief Writes a little-endian 32-bit displacement and moves past it.
+ ** \param ptr The target
+ ** \param value The displacement
+ ** \returns A pointer past the displacement.
+ ** \memberof DFAJit
+ **/
+unsigned char* private_put32_dfaj(unsigned char* ptr, const long value)
+{
+	/* Variable declaration. */
+	unsigned int i;
+
+	for (i = 0; i < 4; i++)
+		*ptr++ = (unsigned char)(((unsigned long)value >> (8 * i)) & 0xFF);
+	return ptr;
+}
+
+/** \brief Writes the machine code of a DeterministicFiniteAutomaton to an executable mapping.
+ ** \param jit The DFAJit
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns 1 on success, 0 if no executable mapping could be made.
+ ** \memberof DFAJit
+ **
+ ** The mapping holds the prologue, one block per open state, the two exits,
+ ** then the byte to class map and the jump tables, 8-byte aligned. It is
+ ** written while writable only, then made executable only. The function
+ ** follows the System V calling convention: buf in rdi and len in rsi, rsi
+ ** then holds the end of the buffer and r8 the byte to class map.
+ **/
+int private_compile_dfaj(DFAJit* jit, const DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(private_compile_dfaj);
+
+	/* Variable declarations. */
+	unsigned int i, k, nOpen;
+	DFAStateId sinkId;
+	size_t exitsAt, classOfAt, tablesAt, target;
+	size_t* blockAt;
+	unsigned char* code;
+	unsigned char* ptr;
+	unsigned long address;
+#ifndef MAP_ANON
+	int fd;
+#endif
+	DFAFate* fates;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+
+	toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	fates = toFates_dfa(NULL, dfa, DFA_SIGNATURE_BUFFER);
+
+	/* Lay out the open states, terminal states have no block. */
+	SAFE_MALLOC(blockAt, size_t, dfa->states->nStates);
+	nOpen = 0;
+	for (i = 0; i < dfa->states->nStates; i++)
+		blockAt[i] = fates[i] == DFA_FATE_OPEN ? DFA_JIT_PROLOGUE_SIZE + DFA_JIT_BLOCK_SIZE * nOpen++ : 0;
+	exitsAt = DFA_JIT_PROLOGUE_SIZE + DFA_JIT_BLOCK_SIZE * nOpen;
+	classOfAt = (exitsAt + DFA_JIT_EXITS_SIZE + 7) / 8 * 8;
+	tablesAt = classOfAt + DFA_MAX_SYMBOLS;
+	jit->size = tablesAt + 8 * (size_t)classes->nClasses * nOpen;
+	say(MSG_REPORT_VAR("JIT Bytes", "%lu", (unsigned long)jit->size));
+
+	/* Without anonymous mappings, private mappings of /dev/zero do the same. */
+#ifdef MAP_ANON
+	code = mmap(NULL, jit->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+#else
+	fd = open("/dev/zero", O_RDWR);
+	code = fd < 0 ? MAP_FAILED : mmap(NULL, jit->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (fd >= 0)
+		close(fd);
+#endif
+	if (code == MAP_FAILED) {
+		warning(MSG_REPORT_VAR("Cannot Map JIT Bytes", "%lu", (unsigned long)jit->size));
+		free(blockAt);
+		free(fates);
+		return 0;
+	}
+	memset(code, 0xCC, jit->size);
+
+	/* Prologue: reject NULL, compute the end, load the class map and enter the initial state. */
+	ptr = code;
+	*ptr++ = 0x48; *ptr++ = 0x85; *ptr++ = 0xFF;									/* test rdi, rdi */
+	*ptr++ = 0x0F; *ptr++ = 0x84;													/* jz exit0 */
+	ptr = private_put32_dfaj(ptr, (long)exitsAt - (long)(ptr + 4 - code));
+	*ptr++ = 0x48; *ptr++ = 0x01; *ptr++ = 0xFE;									/* add rsi, rdi */
+	*ptr++ = 0x4C; *ptr++ = 0x8D; *ptr++ = 0x05;									/* lea r8, [rip + classOf] */
+	ptr = private_put32_dfaj(ptr, (long)classOfAt - (long)(ptr + 4 - code));
+	switch (fates[dfa->initialStateId]) {
+		case DFA_FATE_DEAD:
+			target = exitsAt;
+			break;
+		case DFA_FATE_UNIVERSAL:
+			target = exitsAt + 3;
+			break;
+		default:
+			target = blockAt[dfa->initialStateId];
+			break;
+	}
+	*ptr++ = 0xE9;																	/* jmp initial */
+	ptr = private_put32_dfaj(ptr, (long)target - (long)(ptr + 4 - code));
+	ASSERT_ZERO(((size_t)(ptr - code) - DFA_JIT_PROLOGUE_SIZE));
+
+	/* One block per open state: stop at the end, else jump through the table of the class. */
+	for (i = 0; i < dfa->states->nStates; i++) {
+		if (fates[i] != DFA_FATE_OPEN)
+			continue;
+		ASSERT_ZERO(((size_t)(ptr - code) - blockAt[i]));
+		*ptr++ = 0x48; *ptr++ = 0x39; *ptr++ = 0xF7;								/* cmp rdi, rsi */
+		*ptr++ = 0x0F; *ptr++ = 0x83;												/* jae exit */
+		ptr = private_put32_dfaj(ptr, (long)(exitsAt + (dfa->states->array[i].isAccept ? 3 : 0)) - (long)(ptr + 4 - code));
+		*ptr++ = 0x0F; *ptr++ = 0xB6; *ptr++ = 0x07;								/* movzx eax, byte [rdi] */
+		*ptr++ = 0x48; *ptr++ = 0xFF; *ptr++ = 0xC7;								/* inc rdi */
+		*ptr++ = 0x41; *ptr++ = 0x0F; *ptr++ = 0xB6; *ptr++ = 0x04; *ptr++ = 0x00;	/* movzx eax, byte [r8 + rax] */
+		*ptr++ = 0x48; *ptr++ = 0x8D; *ptr++ = 0x0D;								/* lea rcx, [rip + table] */
+		ptr = private_put32_dfaj(ptr, (long)(tablesAt + 8 * (size_t)classes->nClasses * ((blockAt[i] - DFA_JIT_PROLOGUE_SIZE) / DFA_JIT_BLOCK_SIZE)) - (long)(ptr + 4 - code));
+		*ptr++ = 0xFF; *ptr++ = 0x24; *ptr++ = 0xC1;								/* jmp [rcx + rax * 8] */
+	}
+
+	/* Exits. */
+	*ptr++ = 0x31; *ptr++ = 0xC0; *ptr++ = 0xC3;									/* exit0: xor eax, eax; ret */
+	*ptr++ = 0xB8; ptr = private_put32_dfaj(ptr, 1); *ptr++ = 0xC3;					/* exit1: mov eax, 1; ret */
+	ASSERT_ZERO(((size_t)(ptr - code) - exitsAt - DFA_JIT_EXITS_SIZE));
+
+	/* Data: the class map, then the absolute addresses of the jump tables. */
+	memcpy(code + classOfAt, classes->classOf, DFA_MAX_SYMBOLS);
+	ptr = code + tablesAt;
+	for (i = 0; i < dfa->states->nStates; i++) {
+		if (fates[i] != DFA_FATE_OPEN)
+			continue;
+		for (k = 0; k < classes->nClasses; k++) {
+			sinkId = dfa->transitions[i][classes->representatives[k]];
+			if (sinkId == DFA_NO_STATE || fates[sinkId] == DFA_FATE_DEAD)
+				target = exitsAt;
+			else if (fates[sinkId] == DFA_FATE_UNIVERSAL)
+				target = exitsAt + 3;
+			else
+				target = blockAt[sinkId];
+			address = (unsigned long)(code + target);
+			ptr = private_put32_dfaj(ptr, (long)(address & 0xFFFFFFFFUL));
+			ptr = private_put32_dfaj(ptr, (long)((address >> 16) >> 16));
+		}
+	}
+	free(blockAt);
+	free(fates);
+
+	if (mprotect(code, jit->size, PROT_READ | PROT_EXEC)) {
+		warning(MSG_REPORT("Cannot Make JIT Bytes Executable"));
+		munmap(code, jit->size);
+		return 0;
+	}
+
+	/* ISO C has no conversion from object to function pointers. */
+	jit->code = code;
+	memcpy(&jit->function, &code, sizeof(jit->function));
+	return 1;
+}
+#endif
+
+/** \brief Compiles a DeterministicFiniteAutomaton into a DFAJit.
+ ** \param jit The DFAJit
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DFAJit.
+ ** \memberof DFAJit
+ **
+ ** Falls back to a DFAMatcher off x86-64 or if the code cannot be mapped.
+ **/
+DFAJit* initialize_dfaj(DFAJit* jit, const DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(initialize_dfaj);
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_ZERO(dfa->states->nStates);
+
+	unless (jit)
+		SAFE_MALLOC(jit, DFAJit, 1);
+
+	jit->function = NULL;
+	jit->code = NULL;
+	jit->size = 0;
+	jit->matcher.table = NULL;
+#ifdef DFA_JIT_X86_64
+	unless (private_compile_dfaj(jit, dfa))
+		initialize_dfam(&jit->matcher, dfa);
+#else
+	initialize_dfam(&jit->matcher, dfa);
+#endif
+
+	ASSERT_DFAJIT(jit);
+	return jit;
+}
+
+/** \brief Releases the code or the fallback DFAMatcher of a DFAJit.
+ ** \param jit The DFAJit
+ ** \memberof DFAJit
+ **
+ ** The DFAJit itself is NOT freed.
+ **/
+void finalize_dfaj(DFAJit* jit)
+{
+	DECLARE_FUNCTION(finalize_dfaj);
+
+	/* Check. */
+	ASSERT_DFAJIT(jit);
+
+#ifdef DFA_JIT_X86_64
+	if (jit->code)
+		munmap(jit->code, jit->size);
+#endif
+	if (jit->matcher.table)
+		finalize_dfam(&jit->matcher);
+	jit->function = NULL;
+	jit->code = NULL;
+	jit->size = 0;
+}
+
+/** \brief Checks whether a DFAJit accepts a whole buffer.
+ ** \param jit The DFAJit
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \returns 1 if the buffer is accepted, 0 otherwise.
+ ** \memberof DFAJit
+ **/
+int match_dfaj(const DFAJit* jit, const char* buf, const size_t len)
+{
+	DECLARE_FUNCTION(match_dfaj);
+
+	/* Checks. */
+	ASSERT_DFAJIT(jit);
+	ASSERT_NOT_NULL(buf);
+
+	if (jit->function)
+		return jit->function((const unsigned char*)buf, len);
+	return match_dfam(&jit->matcher, buf, len);
+}
@@ -0,0 +1,219 @@
+/** \file lazy.c
+ ** \brief Implements LazyDFA and its member functions.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "dfa.h"
+#include "lazy.h"
+#include "nfa.h"
+#include "stdlibplus.h"
+#include "unless.h"
+
+DECLARE_SOURCE("LAZY");
+
+/** \brief Adds a set of NFA states to the cache of a LazyDFA, with none of its transitions built.
+ ** \param lazy The LazyDFA
+ ** \param set The set, which must be closed
+ ** \returns The id of the state.
+ ** \memberof LazyDFA
+ **
+ ** The cache must have room for one more state. A set already there keeps its row.
+ **/
+DFAStateId private_insert_ldfa(LazyDFA* lazy, const unsigned long* set)
+{
+	DECLARE_FUNCTION(private_insert_ldfa);
+
+	/* Variable declarations. */
+	unsigned int k, nSets;
+	DFAStateId id;
+	DFAStateId* row;
+
+	nSets = lazy->cache->nSets;
+	id = intern_nfas(lazy->cache, set);
+	if (id == nSets) {
+		ASSERT_FITS_IN_BOUND(id, lazy->maxStates);
+		lazy->isAccept[id] = (unsigned char)isAccept_nfai(lazy->index, set);
+		row = lazy->table + (size_t)id * lazy->index->nClasses;
+
+		/* Class 0 leads nowhere from every state. */
+		row[0] = DFA_NO_STATE;
+		for (k = 1; k < lazy->index->nClasses; k++)
+			row[k] = LAZY_DFA_UNKNOWN;
+	}
+
+	return id;
+}
+
+/** \brief Empties the cache of a LazyDFA, keeping the initial state and the current one.
+ ** \param lazy The LazyDFA
+ ** \param currentId The id of the current state, set to its new id
+ ** \memberof LazyDFA
+ **/
+void private_flush_ldfa(LazyDFA* lazy, DFAStateId* currentId)
+{
+	/* Variable declaration. */
+	unsigned long* saved;
+
+	/* The first half of the scratch holds the target being built. */
+	saved = lazy->scratch + lazy->index->nWords;
+	memcpy(saved, lazy->cache->sets + (size_t)*currentId * lazy->index->nWords, lazy->index->nWords * sizeof(unsigned long));
+
+	clear_nfas(lazy->cache);
+	private_insert_ldfa(lazy, lazy->initial);
+	*currentId = private_insert_ldfa(lazy, saved);
+	lazy->nFlushes++;
+}
+
+/** \brief Builds a transition of a LazyDFA.
+ ** \param lazy The LazyDFA
+ ** \param sourceId The id of the state the transition leaves, updated if the cache is flushed
+ ** \param k The byte class of the transition
+ ** \returns The id of the state the transition enters, DFA_NO_STATE for the empty set.
+ ** \memberof LazyDFA
+ **/
+DFAStateId private_step_ldfa(LazyDFA* lazy, DFAStateId* sourceId, const unsigned int k)
+{
+	/* Variable declarations. */
+	DFAStateId sinkId;
+	unsigned long* target;
+
+	lazy->nMisses++;
+	target = lazy->scratch;
+	move_nfai(lazy->index, lazy->cache->sets + (size_t)*sourceId * lazy->index->nWords, k, target);
+	if (isEmpty_nfai(lazy->index, target)) {
+		sinkId = DFA_NO_STATE;
+	} else {
+		sinkId = find_nfas(lazy->cache, target);
+		if (sinkId == DFA_NO_STATE) {
+			if (lazy->cache->nSets == lazy->maxStates)
+				private_flush_ldfa(lazy, sourceId);
+			sinkId = private_insert_ldfa(lazy, target);
+		}
+	}
+	lazy->table[(size_t)*sourceId * lazy->index->nClasses + k] = sinkId;
+
+	return sinkId;
+}
+
+/** \brief Initializes a LazyDFA from a NondeterministicFiniteAutomaton.
+ ** \param lazy The LazyDFA
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param budget The bytes the cache may take, 0 for LAZY_DFA_BUDGET
+ ** \returns A pointer to the LazyDFA.
+ ** \memberof LazyDFA
+ **
+ ** Only the initial state is built. Every state takes its set, its hash, its row,
+ ** its acceptance and up to four slots; the cache holds as many as fit the
+ ** budget, and at least LAZY_DFA_MIN_STATES.
+ **/
+LazyDFA* initialize_ldfa(LazyDFA* lazy, const NondeterministicFiniteAutomaton* nfa, const size_t budget)
+{
+	DECLARE_FUNCTION(initialize_ldfa);
+
+	/* Variable declaration. */
+	size_t stateSize;
+
+	/* Check. */
+	ASSERT_NFA(nfa);
+
+	unless (lazy)
+		SAFE_MALLOC(lazy, LazyDFA, 1);
+
+	initialize_nfai(lazy->index, nfa);
+	stateSize = (lazy->index->nWords + 1) * sizeof(unsigned long) + (lazy->index->nClasses + 4) * sizeof(DFAStateId) + 1;
+	lazy->maxStates = (unsigned int)((budget ? budget : LAZY_DFA_BUDGET) / stateSize);
+	if (lazy->maxStates < LAZY_DFA_MIN_STATES)
+		lazy->maxStates = LAZY_DFA_MIN_STATES;
+	say(MSG_REPORT_VAR("Cached States", "%u", lazy->maxStates));
+
+	initialize_nfas(lazy->cache, lazy->index->nWords, lazy->maxStates);
+	SAFE_MALLOC(lazy->table, DFAStateId, ((size_t)lazy->maxStates * lazy->index->nClasses));
+	SAFE_MALLOC(lazy->isAccept, unsigned char, lazy->maxStates);
+	SAFE_CALLOC(lazy->initial, unsigned long, (lazy->index->nWords + 1));
+	SAFE_MALLOC(lazy->scratch, unsigned long, (2 * lazy->index->nWords + 1));
+	lazy->nHits = 0;
+	lazy->nMisses = 0;
+	lazy->nFlushes = 0;
+
+	/* The closure of the initial NFA state is state 0, after every flush too. */
+	NFA_ADD_STATE(lazy->initial, lazy->index->initialStateId);
+	close_nfai(lazy->index, lazy->initial);
+	private_insert_ldfa(lazy, lazy->initial);
+
+	ASSERT_LAZYDFA(lazy);
+	return lazy;
+}
+
+/** \brief Releases the cache of a LazyDFA and reports its counters.
+ ** \param lazy The LazyDFA
+ ** \memberof LazyDFA
+ **
+ ** The LazyDFA itself is NOT freed.
+ **/
+void finalize_ldfa(LazyDFA* lazy)
+{
+	DECLARE_FUNCTION(finalize_ldfa);
+
+	/* Check. */
+	ASSERT_LAZYDFA(lazy);
+
+	say(MSG_REPORT_VAR("Cache Hits", "%lu", lazy->nHits));
+	say(MSG_REPORT_VAR("Cache Misses", "%lu", lazy->nMisses));
+	say(MSG_REPORT_VAR("Cache Flushes", "%lu", lazy->nFlushes));
+
+	finalize_nfas(lazy->cache);
+	finalize_nfai(lazy->index);
+	free(lazy->table);
+	free(lazy->isAccept);
+	free(lazy->initial);
+	free(lazy->scratch);
+	lazy->table = NULL;
+	lazy->isAccept = NULL;
+	lazy->initial = NULL;
+	lazy->scratch = NULL;
+}
+
+/** \brief Checks whether a LazyDFA accepts a whole buffer, building the states it needs.
+ ** \param lazy The LazyDFA
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \returns 1 if the buffer is accepted, 0 otherwise.
+ ** \memberof LazyDFA
+ **
+ ** The scan stops at the first byte leading to the empty set.
+ **/
+int match_ldfa(LazyDFA* lazy, const char* buf, const size_t len)
+{
+	DECLARE_FUNCTION(match_ldfa);
+
+	/* Variable declarations. */
+	unsigned int k;
+	unsigned long nHits;
+	DFAStateId stateId, sinkId;
+	const unsigned char* ptr;
+	const unsigned char* end;
+
+	/* Checks. */
+	ASSERT_LAZYDFA(lazy);
+	ASSERT_NOT_NULL(buf);
+
+	stateId = 0;
+	nHits = 0;
+	for (ptr = (const unsigned char*)buf, end = ptr + len; ptr < end; ptr++) {
+		k = lazy->index->classOf[*ptr];
+		sinkId = lazy->table[(size_t)stateId * lazy->index->nClasses + k];
+		if (sinkId == LAZY_DFA_UNKNOWN)
+			sinkId = private_step_ldfa(lazy, &stateId, k);
+		else
+			nHits++;
+		if (sinkId == DFA_NO_STATE) {
+			lazy->nHits += nHits;
+			return 0;
+		}
+		stateId = sinkId;
+	}
+	lazy->nHits += nHits;
+
+	return lazy->isAccept[stateId];
+}
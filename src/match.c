@@ -0,0 +1,701 @@
+/** \file match.c
+ ** \brief Implements DFAMatcher and the runtime matching functions.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef _POSIX_THREADS
+	#include <pthread.h>
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSSE3__)
+	#include <tmmintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+#include "debug.h"
+#include "dfa.h"
+#include "match.h"
+#include "stdlibplus.h"
+#include "unless.h"
+
+DECLARE_SOURCE("MATCH");
+
+/** \brief Compiles a DeterministicFiniteAutomaton into a DFAMatcher.
+ ** \param matcher The DFAMatcher
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \returns A pointer to the DFAMatcher.
+ ** \memberof DFAMatcher
+ **/
+DFAMatcher* initialize_dfam(DFAMatcher* matcher, const DeterministicFiniteAutomaton* dfa)
+{
+	DECLARE_FUNCTION(initialize_dfam);
+
+	/* Variable declarations. */
+	unsigned int i, k;
+	DFAStateId sinkId;
+	DFAFate* fates;
+	DFAByteClasses cBuffer, *classes = &cBuffer;
+
+	/* Check. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_ZERO(dfa->states->nStates);
+
+	unless (matcher)
+		SAFE_MALLOC(matcher, DFAMatcher, 1);
+
+	classes = toByteClasses_dfa(classes, dfa);
+	ASSERT_DFABYTECLASSES(classes);
+	memcpy(matcher->classOf, classes->classOf, sizeof(matcher->classOf));
+	fates = toFates_dfa(NULL, dfa, DFA_SIGNATURE_BUFFER);
+
+	/* Two more rows for the universal and the dead states. */
+	matcher->nClasses = classes->nClasses;
+	matcher->nStates = dfa->states->nStates + 2;
+	matcher->universalStateId = dfa->states->nStates;
+	matcher->deadStateId = dfa->states->nStates + 1;
+	SAFE_MALLOC(matcher->table, DFAStateId, matcher->nStates * matcher->nClasses);
+	SAFE_MALLOC(matcher->isAccept, unsigned char, matcher->nStates);
+	SAFE_MALLOC(matcher->loops, DFASelfLoop, matcher->nStates);
+
+	for (i = 0; i < dfa->states->nStates; i++) {
+		matcher->isAccept[i] = dfa->states->array[i].isAccept ? 1 : 0;
+		toSelfLoop_dfa(matcher->loops + i, dfa, i);
+		for (k = 0; k < matcher->nClasses; k++) {
+			sinkId = dfa->transitions[i][classes->representatives[k]];
+			if (sinkId == DFA_NO_STATE || fates[sinkId] == DFA_FATE_DEAD)
+				sinkId = matcher->deadStateId;
+			else if (fates[sinkId] == DFA_FATE_UNIVERSAL)
+				sinkId = matcher->universalStateId;
+			matcher->table[i * matcher->nClasses + k] = sinkId;
+		}
+	}
+	for (i = matcher->universalStateId; i <= matcher->deadStateId; i++) {
+		matcher->isAccept[i] = i == matcher->universalStateId;
+		matcher->loops[i].nRanges = 0;
+		for (k = 0; k < matcher->nClasses; k++)
+			matcher->table[i * matcher->nClasses + k] = i;
+	}
+
+	/* Start in a terminal state if the initial state is one. */
+	switch (fates[dfa->initialStateId]) {
+		case DFA_FATE_DEAD:
+			matcher->initialStateId = matcher->deadStateId;
+			break;
+		case DFA_FATE_UNIVERSAL:
+			matcher->initialStateId = matcher->universalStateId;
+			break;
+		default:
+			matcher->initialStateId = dfa->initialStateId;
+			break;
+	}
+	free(fates);
+
+	/* One shuffle vector per class, states past nStates map to themselves. */
+	matcher->shuffles = NULL;
+#if defined(__SSSE3__)
+	if (matcher->nStates <= DFA_SHUFFLE_STATES) {
+		SAFE_MALLOC(matcher->shuffles, unsigned char, (matcher->nClasses * DFA_SHUFFLE_STATES));
+		for (k = 0; k < matcher->nClasses; k++)
+			for (i = 0; i < DFA_SHUFFLE_STATES; i++)
+				matcher->shuffles[k * DFA_SHUFFLE_STATES + i] = (unsigned char)(i < matcher->nStates ? matcher->table[i * matcher->nClasses + k] : i);
+	}
+#endif
+
+	ASSERT_DFAMATCHER(matcher);
+	return matcher;
+}
+
+/** \brief Releases the tables of a DFAMatcher.
+ ** \param matcher The DFAMatcher
+ ** \memberof DFAMatcher
+ **
+ ** The DFAMatcher itself is NOT freed.
+ **/
+void finalize_dfam(DFAMatcher* matcher)
+{
+	DECLARE_FUNCTION(finalize_dfam);
+
+	/* Check. */
+	ASSERT_DFAMATCHER(matcher);
+
+	free(matcher->table);
+	free(matcher->isAccept);
+	free(matcher->loops);
+	free(matcher->shuffles);
+	matcher->table = NULL;
+	matcher->isAccept = NULL;
+	matcher->loops = NULL;
+	matcher->shuffles = NULL;
+}
+
+/** \brief Skips the bytes of a buffer that stay in a self-loop.
+ ** \param loop The DFASelfLoop, with at least one range
+ ** \param ptr The first byte to test
+ ** \param end The end of the buffer
+ ** \returns A pointer to the first byte leaving the self-loop, or end.
+ ** \memberof DFAMatcher
+ **
+ ** Tests 32 bytes at a time with AVX2 or 16 with SSE2, when the compiler targets them.
+ **/
+const unsigned char* private_skip_dfam(const DFASelfLoop* loop, const unsigned char* ptr, const unsigned char* end)
+{
+	/* Variable declarations. */
+	unsigned int r;
+#if defined(__AVX2__)
+	unsigned int mask;
+	__m256i v, stay;
+#elif defined(__SSE2__)
+	unsigned int mask;
+	__m128i v, stay;
+#endif
+
+#if defined(__AVX2__)
+	while (end - ptr >= 32) {
+		v = _mm256_loadu_si256((const __m256i*)ptr);
+		stay = _mm256_setzero_si256();
+		for (r = 0; r < loop->nRanges; r++)
+			stay = _mm256_or_si256(stay, _mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8(v, _mm256_set1_epi8((char)loop->lows[r])), _mm256_set1_epi8((char)loop->widths[r])), _mm256_setzero_si256()));
+		mask = ~(unsigned int)_mm256_movemask_epi8(stay);
+		if (mask)
+			return ptr + __builtin_ctz(mask);
+		ptr += 32;
+	}
+#elif defined(__SSE2__)
+	while (end - ptr >= 16) {
+		v = _mm_loadu_si128((const __m128i*)ptr);
+		stay = _mm_setzero_si128();
+		for (r = 0; r < loop->nRanges; r++)
+			stay = _mm_or_si128(stay, _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(v, _mm_set1_epi8((char)loop->lows[r])), _mm_set1_epi8((char)loop->widths[r])), _mm_setzero_si128()));
+		mask = ~(unsigned int)_mm_movemask_epi8(stay) & 0xFFFFu;
+		if (mask)
+			return ptr + __builtin_ctz(mask);
+		ptr += 16;
+	}
+#endif
+
+	/* Scalar tail. */
+	for (; ptr < end; ptr++) {
+		for (r = 0; r < loop->nRanges && (unsigned char)(*ptr - loop->lows[r]) > loop->widths[r]; r++);
+		if (r == loop->nRanges)
+			return ptr;
+	}
+	return ptr;
+}
+
+#if defined(__SSSE3__)
+/** \brief Computes the state a DFAMatcher reaches at the end of a slice, from every state.
+ ** \param matcher The DFAMatcher, with shuffles
+ ** \param map Filled with the state reached from every state, DFA_SHUFFLE_STATES entries
+ ** \param ptr The first byte of the slice
+ ** \param end The end of the slice
+ ** \memberof DFAMatcher
+ **
+ ** A vector holds the state reached from each of the 16 states, every byte
+ ** composes it with the shuffle vector of its class. Composition is
+ ** associative, so the slice is cut into DFA_SHUFFLE_LANES parts scanned side
+ ** by side, whose maps are composed at the end; the shuffles of different
+ ** lanes do not depend on each other and overlap in the CPU.
+ **/
+void private_compose_dfam(const DFAMatcher* matcher, unsigned char* map, const unsigned char* ptr, const unsigned char* end)
+{
+	/* Variable declarations. */
+	__m128i lanes[DFA_SHUFFLE_LANES];
+	const __m128i* shuffles;
+	const unsigned char* classOf;
+	size_t i, laneSize;
+	unsigned int l;
+
+	shuffles = (const __m128i*)matcher->shuffles;
+	classOf = matcher->classOf;
+	laneSize = (size_t)(end - ptr) / DFA_SHUFFLE_LANES;
+	for (l = 0; l < DFA_SHUFFLE_LANES; l++)
+		lanes[l] = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	for (i = 0; i < laneSize; i++)
+		for (l = 0; l < DFA_SHUFFLE_LANES; l++)
+			lanes[l] = _mm_shuffle_epi8(_mm_loadu_si128(shuffles + classOf[ptr[l * laneSize + i]]), lanes[l]);
+
+	/* Compose the lanes in order, then run the remainder. */
+	for (l = 1; l < DFA_SHUFFLE_LANES; l++)
+		lanes[0] = _mm_shuffle_epi8(lanes[l], lanes[0]);
+	for (ptr += DFA_SHUFFLE_LANES * laneSize; ptr < end; ptr++)
+		lanes[0] = _mm_shuffle_epi8(_mm_loadu_si128(shuffles + classOf[*ptr]), lanes[0]);
+
+	_mm_storeu_si128((__m128i*)map, lanes[0]);
+}
+#endif
+
+/** \brief Runs a DFAMatcher over a slice of a buffer from a given state.
+ ** \param matcher The DFAMatcher
+ ** \param s The state to start from
+ ** \param ptr The first byte of the slice
+ ** \param end The end of the slice
+ ** \returns The state reached at the end of the slice, or the first terminal state reached.
+ ** \memberof DFAMatcher
+ **
+ ** With shuffles, the slice is composed DFA_SHUFFLE_BLOCK bytes at a time and
+ ** terminal states are only noticed between blocks.
+ **/
+DFAStateId private_run_dfam(const DFAMatcher* matcher, DFAStateId s, const unsigned char* ptr, const unsigned char* end)
+{
+	/* Variable declarations. */
+	const DFAStateId* table;
+	const unsigned char* classOf;
+	const DFASelfLoop* loops;
+	unsigned int nClasses;
+	DFAStateId terminal;
+#if defined(__SSSE3__)
+	unsigned char map[DFA_SHUFFLE_STATES];
+	const unsigned char* stop;
+#endif
+
+	table = matcher->table;
+	classOf = matcher->classOf;
+	nClasses = matcher->nClasses;
+	loops = matcher->loops;
+	terminal = matcher->universalStateId;
+#if defined(__SSSE3__)
+	if (matcher->shuffles) {
+		while (ptr < end && s < terminal) {
+			if (loops[s].nRanges) {
+				ptr = private_skip_dfam(loops + s, ptr, end);
+				if (ptr == end)
+					break;
+			}
+			stop = (size_t)(end - ptr) > DFA_SHUFFLE_BLOCK ? ptr + DFA_SHUFFLE_BLOCK : end;
+			private_compose_dfam(matcher, map, ptr, stop);
+			s = map[s];
+			ptr = stop;
+		}
+		return s;
+	}
+#endif
+	for (; ptr < end && s < terminal; ptr++) {
+		if (loops[s].nRanges) {
+			ptr = private_skip_dfam(loops + s, ptr, end);
+			if (ptr == end)
+				break;
+		}
+		s = table[s * nClasses + classOf[*ptr]];
+	}
+
+	return s;
+}
+
+/** \brief Checks whether a DFAMatcher accepts a whole buffer.
+ ** \param matcher The DFAMatcher
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \returns 1 if the buffer is accepted, 0 otherwise.
+ ** \memberof DFAMatcher
+ **
+ ** The scan stops as soon as a terminal state is reached.
+ **/
+int match_dfam(const DFAMatcher* matcher, const char* buf, const size_t len)
+{
+	DECLARE_FUNCTION(match_dfam);
+
+	/* Checks. */
+	ASSERT_DFAMATCHER(matcher);
+	ASSERT_NOT_NULL(buf);
+
+	return matcher->isAccept[private_run_dfam(matcher, matcher->initialStateId, (const unsigned char*)buf, (const unsigned char*)buf + len)];
+}
+
+/** \brief A slice of a buffer matched speculatively, from every state at once.
+ **
+ ** Once done, map gives the state reached at the end of the slice for every start state.
+ **/
+typedef struct DFAChunkBody {
+	const DFAMatcher* matcher;
+	const unsigned char* begin;
+	const unsigned char* end;
+	DFAStateId* map;
+} DFAChunk;
+
+/** \brief Runs a DFAMatcher over a chunk from every start state.
+ ** \param arg The DFAChunk, as a void pointer to serve as a thread entry point
+ ** \returns NULL.
+ ** \memberof DFAMatcher
+ **
+ ** Start states that reach the same state are merged every DFA_PARALLEL_MERGE_SIZE
+ ** bytes, so most automata fall back to a single run after a short prefix.
+ ** With shuffles, the whole chunk is composed at once instead.
+ **/
+void* private_speculate_dfam(void* arg)
+{
+	DECLARE_FUNCTION(private_speculate_dfam);
+
+	/* Variable declarations. */
+	const DFAChunk* chunk;
+	const DFAMatcher* matcher;
+	const unsigned char* ptr;
+	const unsigned char* stop;
+	DFAStateId* map;
+	DFAStateId* active;
+	DFAStateId* slotOf;
+	DFAStateId* remap;
+	unsigned int nStarts, nActive, nMerged, j, q;
+#if defined(__SSSE3__)
+	unsigned char shuffled[DFA_SHUFFLE_STATES];
+#endif
+
+	chunk = (const DFAChunk*)arg;
+	matcher = chunk->matcher;
+	ptr = chunk->begin;
+	map = chunk->map;
+
+#if defined(__SSSE3__)
+	/* The shuffles run every start state at once. */
+	if (matcher->shuffles) {
+		private_compose_dfam(matcher, shuffled, chunk->begin, chunk->end);
+		for (q = 0; q < matcher->nStates; q++)
+			map[q] = shuffled[q];
+		return NULL;
+	}
+#endif
+
+	/* Terminal states never leave, every other state starts a run. */
+	nStarts = matcher->universalStateId;
+	SAFE_MALLOC(active, DFAStateId, nStarts);
+	SAFE_MALLOC(slotOf, DFAStateId, matcher->nStates);
+	SAFE_MALLOC(remap, DFAStateId, nStarts);
+	for (q = 0; q < matcher->nStates; q++) {
+		map[q] = q;
+		slotOf[q] = DFA_NO_STATE;
+	}
+	for (q = 0; q < nStarts; q++)
+		active[q] = q;
+	nActive = nStarts;
+
+	/* While running, map gives the index in active of the run of each start state. */
+	while (ptr < chunk->end) {
+		stop = (size_t)(chunk->end - ptr) > DFA_PARALLEL_MERGE_SIZE ? ptr + DFA_PARALLEL_MERGE_SIZE : chunk->end;
+		for (j = 0; j < nActive; j++)
+			active[j] = private_run_dfam(matcher, active[j], ptr, stop);
+		ptr = stop;
+
+		/* Merge the runs that reached the same state. */
+		nMerged = 0;
+		for (j = 0; j < nActive; j++) {
+			if (slotOf[active[j]] == DFA_NO_STATE) {
+				slotOf[active[j]] = nMerged;
+				active[nMerged++] = active[j];
+			}
+			remap[j] = slotOf[active[j]];
+		}
+		for (j = 0; j < nMerged; j++)
+			slotOf[active[j]] = DFA_NO_STATE;
+		if (nMerged < nActive)
+			for (q = 0; q < nStarts; q++)
+				map[q] = remap[map[q]];
+		nActive = nMerged;
+	}
+
+	for (q = 0; q < nStarts; q++)
+		map[q] = active[map[q]];
+
+	free(active);
+	free(slotOf);
+	free(remap);
+
+	return NULL;
+}
+
+/** \brief Checks whether a DFAMatcher accepts a whole buffer, splitting the work across threads.
+ ** \param matcher The DFAMatcher
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \param nThreads The number of threads, 0 for one per online processor
+ ** \returns 1 if the buffer is accepted, 0 otherwise.
+ ** \memberof DFAMatcher
+ **
+ ** The first chunk runs from the initial state. Every other chunk runs
+ ** speculatively from every state and yields a map from start state to end
+ ** state, the final state is the composition of all those maps. Buffers too
+ ** small to give each thread DFA_PARALLEL_MIN_CHUNK bytes use fewer threads.
+ ** Without POSIX threads, the chunks run one after the other.
+ **/
+int matchParallel_dfam(const DFAMatcher* matcher, const char* buf, const size_t len, unsigned int nThreads)
+{
+	DECLARE_FUNCTION(matchParallel_dfam);
+
+	/* Variable declarations. */
+	unsigned int i;
+	size_t chunkSize;
+	DFAStateId s;
+	DFAChunk* chunks;
+#ifdef _POSIX_THREADS
+	pthread_t* threads;
+	int* isStarted;
+#endif
+
+	/* Checks. */
+	ASSERT_DFAMATCHER(matcher);
+	ASSERT_NOT_NULL(buf);
+
+#ifdef _POSIX_THREADS
+	unless (nThreads) {
+		long nProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+		nThreads = nProcessors > 0 ? (unsigned int)nProcessors : 1;
+	}
+#endif
+	if (len / DFA_PARALLEL_MIN_CHUNK < nThreads)
+		nThreads = (unsigned int)(len / DFA_PARALLEL_MIN_CHUNK);
+	if (nThreads <= 1)
+		return match_dfam(matcher, buf, len);
+	say(MSG_REPORT_VAR("Threads", "%u", nThreads));
+
+	/* Cut the buffer into equal chunks, the last one takes the remainder. */
+	SAFE_MALLOC(chunks, DFAChunk, nThreads);
+	chunkSize = len / nThreads;
+	for (i = 0; i < nThreads; i++) {
+		chunks[i].matcher = matcher;
+		chunks[i].begin = (const unsigned char*)buf + i * chunkSize;
+		chunks[i].end = (i + 1 < nThreads) ? chunks[i].begin + chunkSize : (const unsigned char*)buf + len;
+		chunks[i].map = NULL;
+		if (i) {
+			SAFE_MALLOC(chunks[i].map, DFAStateId, matcher->nStates);
+		}
+	}
+
+#ifdef _POSIX_THREADS
+	SAFE_MALLOC(threads, pthread_t, nThreads);
+	SAFE_CALLOC(isStarted, int, nThreads);
+	for (i = 1; i < nThreads; i++)
+		isStarted[i] = !pthread_create(threads + i, NULL, private_speculate_dfam, chunks + i);
+#endif
+
+	/* The first chunk knows its start state. */
+	s = private_run_dfam(matcher, matcher->initialStateId, chunks[0].begin, chunks[0].end);
+
+	/* Compose the maps of the other chunks. */
+	for (i = 1; i < nThreads; i++) {
+#ifdef _POSIX_THREADS
+		if (isStarted[i])
+			pthread_join(threads[i], NULL);
+		else
+			private_speculate_dfam(chunks + i);
+#else
+		private_speculate_dfam(chunks + i);
+#endif
+		s = chunks[i].map[s];
+		free(chunks[i].map);
+	}
+
+#ifdef _POSIX_THREADS
+	free(threads);
+	free(isStarted);
+#endif
+	free(chunks);
+
+	return matcher->isAccept[s];
+}
+
+/** \brief Finds the longest prefix of a buffer that a DFAMatcher accepts.
+ ** \param matcher The DFAMatcher
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \returns The length of the prefix, DFA_NO_MATCH if no prefix is accepted.
+ ** \memberof DFAMatcher
+ **
+ ** The scan stops as soon as a terminal state is reached.
+ **/
+size_t longestPrefix_dfam(const DFAMatcher* matcher, const char* buf, const size_t len)
+{
+	DECLARE_FUNCTION(longestPrefix_dfam);
+
+	/* Variable declarations. */
+	size_t i, longest;
+	const unsigned char* ubuf;
+	DFAStateId s;
+
+	/* Checks. */
+	ASSERT_DFAMATCHER(matcher);
+	ASSERT_NOT_NULL(buf);
+
+	ubuf = (const unsigned char*)buf;
+	s = matcher->initialStateId;
+	longest = matcher->isAccept[s] ? 0 : DFA_NO_MATCH;
+	for (i = 0; i < len && s < matcher->universalStateId; ) {
+		s = matcher->table[s * matcher->nClasses + matcher->classOf[ubuf[i++]]];
+		if (matcher->isAccept[s])
+			longest = i;
+	}
+
+	/* Every longer prefix is accepted too. */
+	if (s == matcher->universalStateId)
+		longest = len;
+
+	return longest;
+}
+
+/** \brief Finds every prefix of a buffer that a DFAMatcher accepts.
+ ** \param matcher The DFAMatcher
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \param positions The lengths of the accepted prefixes, in increasing order
+ ** \param capacity The capacity of positions
+ ** \returns The number of accepted prefixes, which may exceed the capacity.
+ ** \memberof DFAMatcher
+ **
+ ** Only the first capacity positions are written, positions may be NULL if capacity is 0.
+ **/
+size_t findAll_dfam(const DFAMatcher* matcher, const char* buf, const size_t len, size_t* positions, const size_t capacity)
+{
+	DECLARE_FUNCTION(findAll_dfam);
+
+	/* Variable declarations. */
+	size_t i, count;
+	const unsigned char* ubuf;
+	DFAStateId s;
+
+	/* Checks. */
+	ASSERT_DFAMATCHER(matcher);
+	ASSERT_NOT_NULL(buf);
+	if (capacity) {
+		ASSERT_NOT_NULL(positions);
+	}
+
+	ubuf = (const unsigned char*)buf;
+	s = matcher->initialStateId;
+	count = 0;
+	if (matcher->isAccept[s]) {
+		if (capacity)
+			positions[0] = 0;
+		count++;
+	}
+	for (i = 0; i < len && s < matcher->universalStateId; ) {
+		s = matcher->table[s * matcher->nClasses + matcher->classOf[ubuf[i++]]];
+		if (matcher->isAccept[s]) {
+			if (count < capacity)
+				positions[count] = i;
+			count++;
+		}
+	}
+
+	/* Every longer prefix is accepted too. */
+	if (s == matcher->universalStateId) {
+		for (i++; i <= len; i++) {
+			if (count < capacity)
+				positions[count] = i;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/** \brief Checks whether a DFAMatcher accepts each buffer of a batch.
+ ** \param matcher The DFAMatcher
+ ** \param bufs The buffers, which may contain NUL bytes
+ ** \param lens The lengths of the buffers
+ ** \param n The number of buffers
+ ** \param results Filled with 1 for every accepted buffer and 0 for the others
+ ** \memberof DFAMatcher
+ **
+ ** Up to DFA_BATCH_WIDTH buffers advance in lockstep, so that the table loads
+ ** of different buffers, which do not depend on each other, overlap in the
+ ** CPU. Every round advances all lanes by the shortest remaining length, then
+ ** retires the finished lanes and refills them with the next buffers.
+ **/
+void matchBatch_dfam(const DFAMatcher* matcher, const char* const* bufs, const size_t* lens, const size_t n, unsigned char* results)
+{
+	DECLARE_FUNCTION(matchBatch_dfam);
+
+	/* Variable declarations. */
+	const unsigned char* ptr[DFA_BATCH_WIDTH];
+	size_t remaining[DFA_BATCH_WIDTH];
+	size_t index[DFA_BATCH_WIDTH];
+	DFAStateId s[DFA_BATCH_WIDTH];
+	const DFAStateId* table;
+	const unsigned char* classOf;
+	unsigned int nClasses, l, nLanes;
+	size_t i, m, next;
+
+	/* Checks. */
+	ASSERT_DFAMATCHER(matcher);
+	if (n) {
+		ASSERT_NOT_NULL(bufs);
+		ASSERT_NOT_NULL(lens);
+		ASSERT_NOT_NULL(results);
+	}
+
+	table = matcher->table;
+	classOf = matcher->classOf;
+	nClasses = matcher->nClasses;
+	next = 0;
+	nLanes = 0;
+	for (;;) {
+		/* Refill the lanes. */
+		for (; nLanes < DFA_BATCH_WIDTH && next < n; nLanes++, next++) {
+			ptr[nLanes] = (const unsigned char*)bufs[next];
+			remaining[nLanes] = lens[next];
+			index[nLanes] = next;
+			s[nLanes] = matcher->initialStateId;
+		}
+		unless (nLanes)
+			break;
+
+		/* Advance every lane by the shortest remaining length. */
+		for (m = remaining[0], l = 1; l < nLanes; l++)
+			if (remaining[l] < m)
+				m = remaining[l];
+		for (i = 0; i < m; i++)
+			for (l = 0; l < nLanes; l++)
+				s[l] = table[s[l] * nClasses + classOf[ptr[l][i]]];
+
+		for (l = 0; l < nLanes; l++) {
+			ptr[l] += m;
+			remaining[l] -= m;
+		}
+
+		/* Retire the lanes that are done, moving the last lane in their place. */
+		for (l = 0; l < nLanes; ) {
+			if (remaining[l] && s[l] < matcher->universalStateId) {
+				l++;
+				continue;
+			}
+			results[index[l]] = matcher->isAccept[s[l]];
+			nLanes--;
+			ptr[l] = ptr[nLanes];
+			remaining[l] = remaining[nLanes];
+			index[l] = index[nLanes];
+			s[l] = s[nLanes];
+		}
+	}
+}
+
+/** \brief Checks whether a DeterministicFiniteAutomaton accepts a whole buffer.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param buf The buffer, which may contain NUL bytes
+ ** \param len The length of the buffer
+ ** \returns 1 if the buffer is accepted, 0 otherwise.
+ ** \related DFAMatcher
+ **
+ ** Walks the transitions of the DFA directly; a DFAMatcher is faster for repeated matching.
+ **/
+int match_dfa(const DeterministicFiniteAutomaton* dfa, const char* buf, const size_t len)
+{
+	DECLARE_FUNCTION(match_dfa);
+
+	/* Variable declarations. */
+	const unsigned char* ptr;
+	const unsigned char* end;
+	DFAStateId s;
+
+	/* Checks. */
+	ASSERT_DFA(dfa);
+	ASSERT_NOT_NULL(buf);
+	ASSERT_NOT_ZERO(dfa->states->nStates);
+
+	s = dfa->initialStateId;
+	for (ptr = (const unsigned char*)buf, end = ptr + len; ptr < end; ptr++) {
+		s = dfa->transitions[s][*ptr];
+		if (s == DFA_NO_STATE)
+			return 0;
+	}
+
+	return dfa->states->array[s].isAccept;
+}
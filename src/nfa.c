@@ -0,0 +1,1481 @@
+/** \file nfa.c
+ ** \brief Implements NondeterministicFiniteAutomaton and its member functions.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "constants.h"
+#include "debug.h"
+#include "dfa.h"
+#include "intern.h"
+#include "nfa.h"
+#include "stdlibplus.h"
+#include "stringplus.h"
+#include "unless.h"
+#include "xml.h"
+
+DECLARE_SOURCE("NFA");
+
+/** \brief Checks whether a byte set holds a byte.
+ **/
+#define NFA_HAS_BYTE(bytes,b) ((bytes)[(b) >> 3] & (1u << ((b) & 7)))
+
+/** \brief Adds a byte to a byte set.
+ **/
+#define NFA_ADD_BYTE(bytes,b) ((bytes)[(b) >> 3] |= (unsigned char)(1u << ((b) & 7)))
+
+/** \brief Initializes a given NondeterministicFiniteAutomaton or creates it from scratch.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \returns A pointer to the NondeterministicFiniteAutomaton.
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** Nothing is allocated until the first state is inserted.
+ **/
+NondeterministicFiniteAutomaton* initialize_nfa(NondeterministicFiniteAutomaton* nfa)
+{
+	DECLARE_FUNCTION(initialize_nfa);
+
+	/* Variable declaration. */
+	char* check;
+
+	unless (nfa)
+		SAFE_MALLOC(nfa, NondeterministicFiniteAutomaton, 1);
+
+	check = fromPattern(nfa->name, DFA_MAX_NAME_SIZE, DFA_DEFAULT_NAME);
+	ASSERT_NOT_NULL(check);
+	ASSERT_NOT_EMPTY(check);
+
+	nfa->alphabet[0] = '\0';
+	nfa->isAccept = NULL;
+	nfa->nStates = 0;
+	nfa->stateCapacity = 0;
+	nfa->initialStateId = 0;
+	nfa->edges = NULL;
+	nfa->nEdges = 0;
+	nfa->edgeCapacity = 0;
+
+	ASSERT_NFA(nfa);
+	return nfa;
+}
+
+/** \brief Releases the states and the edges of a NondeterministicFiniteAutomaton.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** The NondeterministicFiniteAutomaton itself is NOT freed, it is left with no states.
+ **/
+void finalize_nfa(NondeterministicFiniteAutomaton* nfa)
+{
+	DECLARE_FUNCTION(finalize_nfa);
+
+	/* Check. */
+	ASSERT_NFA(nfa);
+
+	free(nfa->isAccept);
+	free(nfa->edges);
+	nfa->isAccept = NULL;
+	nfa->nStates = 0;
+	nfa->stateCapacity = 0;
+	nfa->edges = NULL;
+	nfa->nEdges = 0;
+	nfa->edgeCapacity = 0;
+}
+
+/** \brief Inserts a state with no edges to a NondeterministicFiniteAutomaton.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param isAccept Whether the state accepts
+ ** \returns The id of the state, equal to the previous number of states.
+ ** \memberof NondeterministicFiniteAutomaton
+ **/
+NFAStateId insertState_nfa(NondeterministicFiniteAutomaton* nfa, const int isAccept)
+{
+	DECLARE_FUNCTION(insertState_nfa);
+
+	/* Check. */
+	ASSERT_NFA(nfa);
+
+	if (nfa->nStates == nfa->stateCapacity) {
+		nfa->stateCapacity = nfa->stateCapacity ? 2 * nfa->stateCapacity : NFA_INITIAL_CAPACITY;
+		SAFE_REALLOC(nfa->isAccept, unsigned char, nfa->stateCapacity);
+	}
+	nfa->isAccept[nfa->nStates] = isAccept ? 1 : 0;
+
+	return nfa->nStates++;
+}
+
+/** \brief Inserts an edge to a NondeterministicFiniteAutomaton.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param sourceId The state the edge leaves
+ ** \param sinkId The state the edge enters
+ ** \param bytes The set of bytes of the edge, NFA_SET_SIZE bytes, NULL for an epsilon edge
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** NUL is dropped from the set, the way it is kept out of DFA alphabets.
+ **/
+void insertEdge_nfa(NondeterministicFiniteAutomaton* nfa, const NFAStateId sourceId, const NFAStateId sinkId, const unsigned char* bytes)
+{
+	DECLARE_FUNCTION(insertEdge_nfa);
+
+	/* Variable declaration. */
+	NFAEdge* edge;
+
+	/* Checks. */
+	ASSERT_NFA(nfa);
+	ASSERT_FITS_IN_BOUND(sourceId, nfa->nStates);
+	ASSERT_FITS_IN_BOUND(sinkId, nfa->nStates);
+
+	if (nfa->nEdges == nfa->edgeCapacity) {
+		nfa->edgeCapacity = nfa->edgeCapacity ? 2 * nfa->edgeCapacity : NFA_INITIAL_CAPACITY;
+		SAFE_REALLOC(nfa->edges, NFAEdge, nfa->edgeCapacity);
+	}
+	edge = nfa->edges + nfa->nEdges++;
+	edge->sourceId = sourceId;
+	edge->sinkId = sinkId;
+	edge->isEpsilon = bytes == NULL;
+	if (bytes) {
+		memcpy(edge->bytes, bytes, NFA_SET_SIZE);
+		edge->bytes[0] &= 0xFE;
+	} else
+		memset(edge->bytes, 0, NFA_SET_SIZE);
+}
+
+/** \brief A piece of a Thompson NFA, with one entry and one exit and no edge leaving the exit.
+ **/
+typedef struct NFAFragmentBody {
+	NFAStateId startId;
+	NFAStateId endId;
+} NFAFragment;
+
+/** \brief A recursive descent parser building a Thompson NFA from a regex.
+ **/
+typedef struct NFARegexParserBody {
+	NondeterministicFiniteAutomaton* nfa;
+	const char* ptr;
+} NFARegexParser;
+
+NFAFragment private_alternation_nfar(NFARegexParser*);
+
+/** \brief Inserts a fragment of two states joined by one edge.
+ ** \param parser The NFARegexParser
+ ** \param bytes The set of bytes of the edge, NULL for an epsilon edge
+ ** \returns The NFAFragment.
+ ** \memberof NFARegexParser
+ **/
+NFAFragment private_fragment_nfar(NFARegexParser* parser, const unsigned char* bytes)
+{
+	/* Variable declaration. */
+	NFAFragment fragment;
+
+	fragment.startId = insertState_nfa(parser->nfa, 0);
+	fragment.endId = insertState_nfa(parser->nfa, 0);
+	insertEdge_nfa(parser->nfa, fragment.startId, fragment.endId, bytes);
+	return fragment;
+}
+
+/** \brief Adds every byte but NUL from a range to a byte set, or to its complement.
+ ** \param bytes The byte set
+ ** \param first The first byte of the range
+ ** \param last The last byte of the range
+ ** \param isComplement Whether to add the bytes outside the range instead
+ ** \memberof NFARegexParser
+ **/
+void private_addRange_nfar(unsigned char* bytes, const unsigned int first, const unsigned int last, const int isComplement)
+{
+	/* Variable declaration. */
+	unsigned int b;
+
+	for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+		if ((b >= first && b <= last) != isComplement)
+			NFA_ADD_BYTE(bytes, b);
+}
+
+/** \brief Parses the escape sequence after a backslash and adds its bytes to a byte set.
+ ** \param parser The NFARegexParser, right after the backslash
+ ** \param bytes The byte set
+ ** \returns The byte of the escape sequence, or -1 for a class such as \\d.
+ ** \memberof NFARegexParser
+ **
+ ** Knows \\d, \\w, \\s and their complements \\D, \\W, \\S, the control
+ ** characters \\n, \\t, \\r, \\f, \\v and \\xHH; any other byte stands for
+ ** itself.
+ **/
+int private_escape_nfar(NFARegexParser* parser, unsigned char* bytes)
+{
+	DECLARE_FUNCTION(private_escape_nfar);
+
+	/* Variable declarations. */
+	unsigned int b, i;
+	unsigned char set[NFA_SET_SIZE];
+	char c;
+
+	c = *parser->ptr++;
+	switch (c) {
+		case '\0':
+			error(MSG_ERROR_SYNTAX("Trailing backslash in regex"));
+			return -1;
+		case 'd':
+		case 'D':
+		case 'w':
+		case 'W':
+		case 's':
+		case 'S':
+			memset(set, 0, NFA_SET_SIZE);
+			if (c == 'd' || c == 'D')
+				private_addRange_nfar(set, '0', '9', 0);
+			if (c == 'w' || c == 'W') {
+				private_addRange_nfar(set, '0', '9', 0);
+				private_addRange_nfar(set, 'A', 'Z', 0);
+				private_addRange_nfar(set, 'a', 'z', 0);
+				NFA_ADD_BYTE(set, '_');
+			}
+			if (c == 's' || c == 'S') {
+				private_addRange_nfar(set, '\t', '\r', 0);
+				NFA_ADD_BYTE(set, ' ');
+			}
+			for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+				if (!NFA_HAS_BYTE(set, b) != !(c == 'D' || c == 'W' || c == 'S'))
+					NFA_ADD_BYTE(bytes, b);
+			return -1;
+		case 'n':
+			b = '\n';
+			break;
+		case 't':
+			b = '\t';
+			break;
+		case 'r':
+			b = '\r';
+			break;
+		case 'f':
+			b = '\f';
+			break;
+		case 'v':
+			b = '\v';
+			break;
+		case 'x':
+			for (b = 0, i = 0; i < 2; i++, parser->ptr++) {
+				c = *parser->ptr;
+				errorUnless((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'), MSG_ERROR_SYNTAX("Expected two hexadecimal digits after \\x in regex"));
+				b = 16 * b + (unsigned int)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+			}
+			errorUnless(b, MSG_ERROR_SYNTAX("NUL in regex"));
+			break;
+		default:
+			b = (unsigned char)c;
+			break;
+	}
+	NFA_ADD_BYTE(bytes, b);
+
+	return (int)b;
+}
+
+/** \brief Parses a bracketed character class into a byte set.
+ ** \param parser The NFARegexParser, right after the opening bracket
+ ** \param bytes The byte set, empty
+ ** \memberof NFARegexParser
+ **
+ ** A leading ^ complements the class, a leading ] stands for itself, and
+ ** a - between two bytes makes a range.
+ **/
+void private_class_nfar(NFARegexParser* parser, unsigned char* bytes)
+{
+	DECLARE_FUNCTION(private_class_nfar);
+
+	/* Variable declarations. */
+	unsigned char set[NFA_SET_SIZE];
+	unsigned int b;
+	int isComplement, first, last;
+
+	memset(set, 0, NFA_SET_SIZE);
+	isComplement = *parser->ptr == '^';
+	if (isComplement)
+		parser->ptr++;
+	do {
+		errorUnless(*parser->ptr, MSG_ERROR_SYNTAX("Unterminated [ in regex"));
+		if (*parser->ptr == '\\') {
+			parser->ptr++;
+			first = private_escape_nfar(parser, set);
+		} else {
+			first = (unsigned char)*parser->ptr++;
+			NFA_ADD_BYTE(set, first);
+		}
+
+		/* A range, unless the - closes the class. */
+		if (first >= 0 && parser->ptr[0] == '-' && parser->ptr[1] && parser->ptr[1] != ']') {
+			parser->ptr++;
+			if (*parser->ptr == '\\') {
+				parser->ptr++;
+				last = private_escape_nfar(parser, set);
+				errorUnless(last >= 0, MSG_ERROR_SYNTAX("Class as the end of a range in regex"));
+			} else
+				last = (unsigned char)*parser->ptr++;
+			errorUnless(first <= last, MSG_ERROR_SYNTAX("Reversed range in regex"));
+			private_addRange_nfar(set, (unsigned int)first, (unsigned int)last, 0);
+		}
+	} while (*parser->ptr != ']');
+	parser->ptr++;
+
+	for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+		if (!NFA_HAS_BYTE(set, b) != !isComplement)
+			NFA_ADD_BYTE(bytes, b);
+}
+
+/** \brief Parses a group, a class, a dot, an escape sequence or a literal byte.
+ ** \param parser The NFARegexParser
+ ** \returns The NFAFragment.
+ ** \memberof NFARegexParser
+ **/
+NFAFragment private_atom_nfar(NFARegexParser* parser)
+{
+	DECLARE_FUNCTION(private_atom_nfar);
+
+	/* Variable declarations. */
+	NFAFragment fragment;
+	unsigned char bytes[NFA_SET_SIZE];
+
+	memset(bytes, 0, NFA_SET_SIZE);
+	switch (*parser->ptr) {
+		case '(':
+			parser->ptr++;
+			if (parser->ptr[0] == '?' && parser->ptr[1] == ':')
+				parser->ptr += 2;
+			fragment = private_alternation_nfar(parser);
+			errorUnless(*parser->ptr == ')', MSG_ERROR_SYNTAX("Unmatched ( in regex"));
+			parser->ptr++;
+			return fragment;
+		case '[':
+			parser->ptr++;
+			private_class_nfar(parser, bytes);
+			break;
+		case '.':
+			parser->ptr++;
+			private_addRange_nfar(bytes, 1, DFA_MAX_SYMBOLS - 1, 0);
+			break;
+		case '\\':
+			parser->ptr++;
+			private_escape_nfar(parser, bytes);
+			break;
+		case '*':
+		case '+':
+		case '?':
+		case '{':
+			error(MSG_ERROR_SYNTAX("Nothing to repeat in regex"));
+			break;
+		default:
+			NFA_ADD_BYTE(bytes, (unsigned char)*parser->ptr);
+			parser->ptr++;
+			break;
+	}
+
+	return private_fragment_nfar(parser, bytes);
+}
+
+/** \brief Copies the states and the edges of a fragment.
+ ** \param parser The NFARegexParser
+ ** \param fragment The NFAFragment
+ ** \param firstStateId The first state of the fragment
+ ** \param lastStateId The state after the last state of the fragment
+ ** \param firstEdge The first edge of the fragment
+ ** \param lastEdge The edge after the last edge of the fragment
+ ** \returns The copy.
+ ** \memberof NFARegexParser
+ **
+ ** The states and the edges of a fragment are contiguous, since they are
+ ** all inserted while parsing it, and no edge leaves them.
+ **/
+NFAFragment private_copy_nfar(NFARegexParser* parser, const NFAFragment fragment, const NFAStateId firstStateId, const NFAStateId lastStateId, const unsigned int firstEdge, const unsigned int lastEdge)
+{
+	/* Variable declarations. */
+	NondeterministicFiniteAutomaton* nfa;
+	NFAFragment copy;
+	NFAEdge edge;
+	NFAStateId offset, q;
+	unsigned int e;
+
+	nfa = parser->nfa;
+	offset = nfa->nStates - firstStateId;
+	for (q = firstStateId; q < lastStateId; q++)
+		insertState_nfa(nfa, 0);
+	for (e = firstEdge; e < lastEdge; e++) {
+		edge = nfa->edges[e];
+		insertEdge_nfa(nfa, edge.sourceId + offset, edge.sinkId + offset, edge.isEpsilon ? NULL : edge.bytes);
+	}
+
+	copy.startId = fragment.startId + offset;
+	copy.endId = fragment.endId + offset;
+	return copy;
+}
+
+/** \brief Repeats a fragment between a minimum and a maximum number of times.
+ ** \param parser The NFARegexParser
+ ** \param fragment The NFAFragment, used as the first copy
+ ** \param firstStateId The first state of the fragment
+ ** \param firstEdge The first edge of the fragment
+ ** \param min The minimum number of times
+ ** \param max The maximum number of times, ignored if isBounded is 0
+ ** \param isBounded Whether there is a maximum
+ ** \returns The NFAFragment of the repetition.
+ ** \memberof NFARegexParser
+ **
+ ** The min copies are chained, then either a loop or max - min copies that
+ ** may each be skipped to the exit.
+ **/
+NFAFragment private_repeat_nfar(NFARegexParser* parser, const NFAFragment fragment, const NFAStateId firstStateId, const unsigned int firstEdge, const unsigned long min, const unsigned long max, const int isBounded)
+{
+	/* Variable declarations. */
+	NondeterministicFiniteAutomaton* nfa;
+	NFAFragment repeat, part;
+	NFAStateId lastStateId, tailId;
+	unsigned int lastEdge;
+	unsigned long i;
+
+	nfa = parser->nfa;
+	lastStateId = nfa->nStates;
+	lastEdge = nfa->nEdges;
+	repeat.startId = insertState_nfa(nfa, 0);
+	repeat.endId = insertState_nfa(nfa, 0);
+	tailId = repeat.startId;
+
+	for (i = 0; i < min; i++) {
+		part = i ? private_copy_nfar(parser, fragment, firstStateId, lastStateId, firstEdge, lastEdge) : fragment;
+		insertEdge_nfa(nfa, tailId, part.startId, NULL);
+		tailId = part.endId;
+	}
+	if (!isBounded) {
+		part = min ? private_copy_nfar(parser, fragment, firstStateId, lastStateId, firstEdge, lastEdge) : fragment;
+		insertEdge_nfa(nfa, tailId, part.startId, NULL);
+		insertEdge_nfa(nfa, tailId, repeat.endId, NULL);
+		insertEdge_nfa(nfa, part.endId, part.startId, NULL);
+		tailId = part.endId;
+	} else {
+		for (i = min; i < max; i++) {
+			part = i ? private_copy_nfar(parser, fragment, firstStateId, lastStateId, firstEdge, lastEdge) : fragment;
+			insertEdge_nfa(nfa, tailId, repeat.endId, NULL);
+			insertEdge_nfa(nfa, tailId, part.startId, NULL);
+			tailId = part.endId;
+		}
+	}
+	insertEdge_nfa(nfa, tailId, repeat.endId, NULL);
+
+	return repeat;
+}
+
+/** \brief Parses a decimal repetition count.
+ ** \param parser The NFARegexParser
+ ** \returns The count.
+ ** \memberof NFARegexParser
+ **/
+unsigned long private_count_nfar(NFARegexParser* parser)
+{
+	DECLARE_FUNCTION(private_count_nfar);
+
+	/* Variable declaration. */
+	unsigned long count;
+
+	errorUnless(*parser->ptr >= '0' && *parser->ptr <= '9', MSG_ERROR_SYNTAX("Expected a repetition count in regex"));
+	for (count = 0; *parser->ptr >= '0' && *parser->ptr <= '9'; parser->ptr++) {
+		count = 10 * count + (unsigned long)(*parser->ptr - '0');
+		errorUnless(count <= NFA_MAX_REPEAT, MSG_ERROR_SYNTAX("Repetition count above NFA_MAX_REPEAT in regex"));
+	}
+
+	return count;
+}
+
+/** \brief Parses an atom followed by any number of *, +, ?, {n}, {n,} or {n,m}.
+ ** \param parser The NFARegexParser
+ ** \returns The NFAFragment.
+ ** \memberof NFARegexParser
+ **/
+NFAFragment private_quantified_nfar(NFARegexParser* parser)
+{
+	DECLARE_FUNCTION(private_quantified_nfar);
+
+	/* Variable declarations. */
+	NFAFragment fragment;
+	NFAStateId firstStateId;
+	unsigned int firstEdge;
+	unsigned long min, max;
+	int isBounded;
+
+	firstStateId = parser->nfa->nStates;
+	firstEdge = parser->nfa->nEdges;
+	fragment = private_atom_nfar(parser);
+	max = 0;
+	for (;;) {
+		switch (*parser->ptr) {
+			case '*':
+				min = 0;
+				isBounded = 0;
+				break;
+			case '+':
+				min = 1;
+				isBounded = 0;
+				break;
+			case '?':
+				min = 0;
+				max = 1;
+				isBounded = 1;
+				break;
+			case '{':
+				parser->ptr++;
+				min = max = private_count_nfar(parser);
+				isBounded = 1;
+				if (*parser->ptr == ',') {
+					parser->ptr++;
+					isBounded = *parser->ptr != '}';
+					if (isBounded)
+						max = private_count_nfar(parser);
+				}
+				errorUnless(*parser->ptr == '}', MSG_ERROR_SYNTAX("Unterminated { in regex"));
+				errorUnless(!isBounded || min <= max, MSG_ERROR_SYNTAX("Reversed repetition counts in regex"));
+				break;
+			default:
+				return fragment;
+		}
+		parser->ptr++;
+		fragment = private_repeat_nfar(parser, fragment, firstStateId, firstEdge, min, max, isBounded);
+	}
+}
+
+/** \brief Parses a possibly empty sequence of quantified atoms.
+ ** \param parser The NFARegexParser
+ ** \returns The NFAFragment.
+ ** \memberof NFARegexParser
+ **/
+NFAFragment private_concatenation_nfar(NFARegexParser* parser)
+{
+	/* Variable declarations. */
+	NFAFragment fragment, part;
+
+	fragment = private_fragment_nfar(parser, NULL);
+	while (*parser->ptr && *parser->ptr != '|' && *parser->ptr != ')') {
+		part = private_quantified_nfar(parser);
+		insertEdge_nfa(parser->nfa, fragment.endId, part.startId, NULL);
+		fragment.endId = part.endId;
+	}
+
+	return fragment;
+}
+
+/** \brief Parses concatenations separated by |.
+ ** \param parser The NFARegexParser
+ ** \returns The NFAFragment.
+ ** \memberof NFARegexParser
+ **/
+NFAFragment private_alternation_nfar(NFARegexParser* parser)
+{
+	/* Variable declarations. */
+	NFAFragment fragment, part;
+
+	fragment = private_concatenation_nfar(parser);
+	unless (*parser->ptr == '|')
+		return fragment;
+
+	part = fragment;
+	fragment.startId = insertState_nfa(parser->nfa, 0);
+	fragment.endId = insertState_nfa(parser->nfa, 0);
+	for (;;) {
+		insertEdge_nfa(parser->nfa, fragment.startId, part.startId, NULL);
+		insertEdge_nfa(parser->nfa, part.endId, fragment.endId, NULL);
+		unless (*parser->ptr == '|')
+			break;
+		parser->ptr++;
+		part = private_concatenation_nfar(parser);
+	}
+
+	return fragment;
+}
+
+/** \brief Builds a NondeterministicFiniteAutomaton from a regex with Thompson's construction.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param pattern The regex
+ ** \returns A pointer to the NondeterministicFiniteAutomaton.
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** The regex matches whole inputs. It knows alternation with |, grouping
+ ** with ( ) or (?: ), the quantifiers *, +, ?, {n}, {n,} and {n,m} up to
+ ** NFA_MAX_REPEAT, bracketed classes with ranges and ^, the dot for any byte
+ ** but NUL, and backslash escapes. Syntax errors are fatal.
+ **/
+NondeterministicFiniteAutomaton* fromRegex_nfa(NondeterministicFiniteAutomaton* nfa, const char* pattern)
+{
+	DECLARE_FUNCTION(fromRegex_nfa);
+
+	/* Variable declarations. */
+	NFARegexParser pBuffer, *parser = &pBuffer;
+	NFAFragment fragment;
+
+	/* Check. */
+	ASSERT_NOT_NULL(pattern);
+
+	nfa = initialize_nfa(nfa);
+	ASSERT_NFA(nfa);
+	say(MSG_REPORT_VAR("Regex", "%s", pattern));
+
+	parser->nfa = nfa;
+	parser->ptr = pattern;
+	fragment = private_alternation_nfar(parser);
+	errorUnless(*parser->ptr == '\0', MSG_ERROR_SYNTAX("Unmatched ) in regex"));
+
+	nfa->initialStateId = fragment.startId;
+	nfa->isAccept[fragment.endId] = 1;
+	say(MSG_REPORT_VAR("NFA States", "%u", nfa->nStates));
+	say(MSG_REPORT_VAR("NFA Edges", "%u", nfa->nEdges));
+
+	ASSERT_NFA(nfa);
+	return nfa;
+}
+
+/** \brief The part of a <nfa> element that the NFA reader is in.
+ **/
+typedef enum NFASectionBody {
+	NFA_SECTION_NONE,
+	NFA_SECTION_STATES,
+	NFA_SECTION_INITIAL_STATE,
+	NFA_SECTION_TRANSITIONS,
+	NFA_SECTION_UNKNOWN
+} NFASection;
+
+/** \brief The state of a NondeterministicFiniteAutomaton being built from the events of the Xml reader.
+ **
+ ** The depth is 1 inside <nfa>, 2 inside a section, 3 inside <accept>, <reject> or a
+ ** source state and 4 inside a sink state. The symbols of a sink state gather in
+ ** bytes and make one edge at its end tag, an epsilon edge if there are none.
+ ** The n-th interned name is the name of the n-th state.
+ **/
+typedef struct NFAReaderBody {
+	NondeterministicFiniteAutomaton* nfa;
+	Arena arena[1];
+	InternTable names[1];
+	unsigned int depth;
+	unsigned int nSections;
+	unsigned int nInitialStates;
+	NFASection section;
+	int isAccept;
+	int isSkipping;
+	int isAlphabetPredefined;
+	NFAStateId sourceId;
+	NFAStateId sinkId;
+	int hasBytes;
+	unsigned char bytes[NFA_SET_SIZE];
+} NFAReader;
+
+/** \brief Returns the id of a state, given its name as a slice.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+NFAStateId private_stateId_nfax(const NFAReader* reader, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_stateId_nfax);
+
+	/* Variable declarations. */
+	char name[DFA_MAX_NAME_SIZE];
+	InternId id;
+
+	id = find_it(reader->names, tag, len);
+	if (id == INTERN_NONE) {
+		fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+		error(MSG_ERROR_UNRECOGNIZED_STR(name));
+	}
+	ASSERT_FITS_IN_BOUND(id, reader->nfa->nStates);
+
+	return id;
+}
+
+/** \brief Handles a start tag of a <nfa> element.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+void private_startTag_nfax(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_startTag_nfax);
+
+	/* Variable declarations. */
+	char name[DFA_MAX_NAME_SIZE];
+	char* check;
+	NFAStateId id;
+	NFAReader* reader = context;
+
+	switch (reader->depth++) {
+		case 0:
+			errorUnless(len == 3 && !strncmp(tag, "nfa", len), MSG_ERROR_SYNTAX("Expected <nfa>"));
+			break;
+		case 1:
+			reader->nSections++;
+			if (len == 6 && !strncmp(tag, "states", len)) {
+				reader->section = NFA_SECTION_STATES;
+			} else if (len == 12 && !strncmp(tag, "initialState", len)) {
+				errorUnless(reader->nfa->nStates, MSG_ERROR_SYNTAX("<states> must come before <initialState>"));
+				reader->section = NFA_SECTION_INITIAL_STATE;
+			} else if (len == 11 && !strncmp(tag, "transitions", len)) {
+				errorUnless(reader->nfa->nStates, MSG_ERROR_SYNTAX("<states> must come before <transitions>"));
+				reader->section = NFA_SECTION_TRANSITIONS;
+				say(MSG_REPORT("Processing transitions..."));
+			} else {
+				check = fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+				warning(MSG_REPORT_VAR("Unrecognized NFA Child", "%s", check));
+				reader->section = NFA_SECTION_UNKNOWN;
+			}
+			break;
+		case 2:
+			if (reader->section == NFA_SECTION_STATES) {
+				reader->isAccept = (len == 6 && !strncmp(tag, "accept", len));
+				reader->isSkipping = !reader->isAccept && !(len == 6 && !strncmp(tag, "reject", len));
+				if (reader->isSkipping)
+				{
+					check = fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+					warning(MSG_REPORT_VAR("Skipping unrecognized State Type (accept/reject)", "%s", check));
+				}
+			} else if (reader->section == NFA_SECTION_INITIAL_STATE) {
+				reader->nInitialStates++;
+				reader->nfa->initialStateId = private_stateId_nfax(reader, tag, len);
+			} else if (reader->section == NFA_SECTION_TRANSITIONS) {
+				reader->sourceId = private_stateId_nfax(reader, tag, len);
+			}
+			break;
+		case 3:
+			if (reader->section == NFA_SECTION_STATES && !reader->isSkipping) {
+				check = fromPattern(name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)len, tag);
+				id = intern_it(reader->names, tag, len);
+				errorUnless(id == reader->nfa->nStates, MSG_ERROR_SYNTAX("Duplicate NFA state"));
+				insertState_nfa(reader->nfa, reader->isAccept);
+				if (reader->isAccept)
+					say(MSG_REPORT_VAR("Accept State", "%s", check));
+				else
+					say(MSG_REPORT_VAR("Reject State", "%s", check));
+			} else if (reader->section == NFA_SECTION_TRANSITIONS) {
+				reader->sinkId = private_stateId_nfax(reader, tag, len);
+				reader->hasBytes = 0;
+				memset(reader->bytes, 0, NFA_SET_SIZE);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/** \brief Handles an attribute of a <nfa> element.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+void private_attribute_nfax(void* context, const char* name, const size_t nameLen, const char* value, const size_t valueLen)
+{
+	DECLARE_FUNCTION(private_attribute_nfax);
+
+	/* Variable declarations. */
+	char* check;
+	NFAReader* reader = context;
+
+	/* Only the attributes of the root matter. */
+	unless (reader->depth == 1)
+		return;
+
+	if (nameLen == 4 && !strncmp(name, "name", nameLen)) {
+		check = fromPattern(reader->nfa->name, DFA_MAX_NAME_SIZE - 1, "%.*s", (int)valueLen, value);
+		ASSERT_NOT_NULL(check);
+		ASSERT_NOT_EMPTY(check);
+		say(MSG_REPORT_VAR("name", "%s", reader->nfa->name));
+	} else if (nameLen == 8 && !strncmp(name, "alphabet", nameLen)) {
+		reader->isAlphabetPredefined = 1;
+		check = fromPattern(reader->nfa->alphabet, DFA_MAX_SYMBOLS - 1, "%.*s", (int)valueLen, value);
+		ASSERT_NOT_NULL(check);
+		ASSERT_NOT_EMPTY(check);
+		say(MSG_REPORT_VAR("alphabet", "%s", reader->nfa->alphabet));
+	}
+}
+
+/** \brief Handles the symbols of a transition.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+void private_text_nfax(void* context, const char* text, const size_t len)
+{
+	DECLARE_FUNCTION(private_text_nfax);
+
+	/* Variable declarations. */
+	const char* with;
+	NFAReader* reader = context;
+
+	unless (reader->depth == 4 && reader->section == NFA_SECTION_TRANSITIONS)
+		return;
+
+	for (with = text; with < text + len; with++) {
+		/* The alphabet, if predefined, holds every symbol. */
+		errorIf(reader->isAlphabetPredefined && !strchr(reader->nfa->alphabet, *with), MSG_ERROR_SYNTAX("Encountered symbol outside the alphabet!"));
+		NFA_ADD_BYTE(reader->bytes, (unsigned char)*with);
+		reader->hasBytes = 1;
+	}
+}
+
+/** \brief Handles an end tag of a <nfa> element.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+void private_endTag_nfax(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_endTag_nfax);
+
+	/* Variable declaration. */
+	NFAReader* reader = context;
+
+	(void)tag;
+	(void)len;
+
+	switch (--reader->depth) {
+		case 0:
+			errorUnless(reader->nSections == 3, MSG_ERROR_SYNTAX("NFA must have exactly 3 children, <states>, <initialState>, <transitions>"));
+			break;
+		case 1:
+			if (reader->section == NFA_SECTION_INITIAL_STATE)
+				errorUnless(reader->nInitialStates == 1, MSG_ERROR_SYNTAX("There has to be EXACTLY one initial state!"));
+			reader->section = NFA_SECTION_NONE;
+			break;
+		case 3:
+			if (reader->section == NFA_SECTION_TRANSITIONS)
+				insertEdge_nfa(reader->nfa, reader->sourceId, reader->sinkId, reader->hasBytes ? reader->bytes : NULL);
+			break;
+		default:
+			break;
+	}
+}
+
+/** \brief The XmlHandler building a NondeterministicFiniteAutomaton.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+const XmlHandler private_reader_nfa = {
+	NULL,
+	private_startTag_nfax,
+	private_attribute_nfax,
+	private_text_nfax,
+	private_endTag_nfax
+};
+
+/** \brief Initializes a NFAReader for a NondeterministicFiniteAutomaton.
+ ** \related NondeterministicFiniteAutomaton
+ **/
+NFAReader* private_initialize_nfax(NFAReader* reader, NondeterministicFiniteAutomaton* nfa)
+{
+	DECLARE_FUNCTION(private_initialize_nfax);
+
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	ASSERT_NFA(nfa);
+
+	reader->nfa = nfa;
+	initialize_arena(reader->arena);
+	initialize_it(reader->names, reader->arena);
+	reader->depth = 0;
+	reader->nSections = 0;
+	reader->nInitialStates = 0;
+	reader->section = NFA_SECTION_NONE;
+	reader->isAccept = 0;
+	reader->isSkipping = 0;
+	reader->isAlphabetPredefined = 0;
+	reader->sourceId = NFA_NO_STATE;
+	reader->sinkId = NFA_NO_STATE;
+	reader->hasBytes = 0;
+
+	return reader;
+}
+
+/** \brief Finalizes a NFAReader, once all the events have been read.
+ ** \related NondeterministicFiniteAutomaton
+ **
+ ** The state names are forgotten, the NFA only knows its states by id.
+ **/
+void private_finalize_nfax(NFAReader* reader)
+{
+	DECLARE_FUNCTION(private_finalize_nfax);
+
+	/* Check. */
+	ASSERT_NOT_NULL(reader);
+
+	errorUnless(reader->nSections, MSG_ERROR_SYNTAX("Expected <nfa>"));
+	finalize_arena(reader->arena);
+	say(MSG_REPORT_VAR("NFA States", "%u", reader->nfa->nStates));
+	say(MSG_REPORT_VAR("NFA Edges", "%u", reader->nfa->nEdges));
+}
+
+/** \brief Creates a NondeterministicFiniteAutomaton from a FILE stream, without building an Xml tree.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param stream The stream
+ ** \returns A pointer to the NondeterministicFiniteAutomaton.
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** The format is that of a <dfa>, with <nfa> as the root. A source state may
+ ** hold the same sink state more than once and several sinks may share a
+ ** symbol; a sink state with no symbols, like <q1/>, is an epsilon edge.
+ ** The <states> must come before the <initialState> and the <transitions>.
+ **/
+NondeterministicFiniteAutomaton* fromStream_nfa(NondeterministicFiniteAutomaton* nfa, FILE* stream)
+{
+	DECLARE_FUNCTION(fromStream_nfa);
+
+	/* Variable declaration. */
+	NFAReader reader;
+
+	/* Check. */
+	ASSERT_NOT_NULL(stream);
+
+	nfa = initialize_nfa(nfa);
+	ASSERT_NFA(nfa);
+
+	private_initialize_nfax(&reader, nfa);
+	parseStream_xml(stream, &private_reader_nfa, &reader);
+	private_finalize_nfax(&reader);
+
+	ASSERT_NFA(nfa);
+	return nfa;
+}
+
+/** \brief Creates a NondeterministicFiniteAutomaton from a file, without building an Xml tree.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param filename The filename
+ ** \returns A pointer to the NondeterministicFiniteAutomaton.
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** The file is memory-mapped when possible, see parseFile_xml.
+ **/
+NondeterministicFiniteAutomaton* fromFile_nfa(NondeterministicFiniteAutomaton* nfa, const char* filename)
+{
+	DECLARE_FUNCTION(fromFile_nfa);
+
+	/* Variable declaration. */
+	NFAReader reader;
+
+	/* Checks. */
+	ASSERT_NOT_NULL(filename);
+	ASSERT_NOT_EMPTY(filename);
+	ASSERT_NOT_TOO_LONG(filename, BUFFER_SIZE);
+
+	nfa = initialize_nfa(nfa);
+	ASSERT_NFA(nfa);
+
+	private_initialize_nfax(&reader, nfa);
+	parseFile_xml(filename, &private_reader_nfa, &reader);
+	private_finalize_nfax(&reader);
+
+	ASSERT_NFA(nfa);
+	return nfa;
+}
+
+/** \brief Indexes the edges of a NondeterministicFiniteAutomaton by byte class.
+ ** \param index The NFAIndex
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \returns A pointer to the NFAIndex.
+ ** \memberof NFAIndex
+ **
+ ** The bytes are first split into classes that no edge tells apart, so that
+ ** every set of states moves once per class instead of once per byte. NUL and
+ ** the bytes of no edge stay in class 0, which leads nowhere.
+ **/
+NFAIndex* initialize_nfai(NFAIndex* index, const NondeterministicFiniteAutomaton* nfa)
+{
+	DECLARE_FUNCTION(initialize_nfai);
+
+	/* Variable declarations. */
+	unsigned int classSize[DFA_MAX_SYMBOLS];
+	unsigned int count[DFA_MAX_SYMBOLS];
+	unsigned int splitOf[DFA_MAX_SYMBOLS];
+	unsigned int representative[DFA_MAX_SYMBOLS];
+	unsigned int b, e, j, c, k, nByteEdges;
+	unsigned int* edgeOf;
+	NFAStateId q;
+	const NFAEdge* edge;
+
+	/* Checks. */
+	ASSERT_NFA(nfa);
+	ASSERT_FITS_IN_BOUND(nfa->initialStateId, nfa->nStates);
+
+	unless (index)
+		SAFE_MALLOC(index, NFAIndex, 1);
+
+	/* Split the bytes into classes, one edge at a time. */
+	memset(index->classOf, 0, sizeof(index->classOf));
+	classSize[0] = DFA_MAX_SYMBOLS;
+	index->nClasses = 1;
+	for (edge = nfa->edges; edge < nfa->edges + nfa->nEdges; edge++) {
+		if (edge->isEpsilon)
+			continue;
+		for (k = 0; k < index->nClasses; k++) {
+			count[k] = 0;
+			splitOf[k] = DFA_MAX_SYMBOLS;
+		}
+		for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+			if (NFA_HAS_BYTE(edge->bytes, b))
+				count[index->classOf[b]]++;
+
+		/* Only the classes the edge covers in part split. */
+		for (k = 0, c = index->nClasses; k < c; k++) {
+			if (count[k] && count[k] < classSize[k]) {
+				splitOf[k] = index->nClasses;
+				classSize[k] -= count[k];
+				classSize[index->nClasses++] = count[k];
+			}
+		}
+		for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+			if (NFA_HAS_BYTE(edge->bytes, b) && splitOf[index->classOf[b]] != DFA_MAX_SYMBOLS)
+				index->classOf[b] = (unsigned char)splitOf[index->classOf[b]];
+	}
+	for (b = DFA_MAX_SYMBOLS; b-- > 0; )
+		representative[index->classOf[b]] = b;
+	say(MSG_REPORT_VAR("Byte Classes", "%u", index->nClasses));
+
+	index->nStates = nfa->nStates;
+	index->nWords = (nfa->nStates + NFA_WORD_BITS - 1) / NFA_WORD_BITS;
+	index->initialStateId = nfa->initialStateId;
+	SAFE_CALLOC(index->accepting, unsigned long, index->nWords);
+	for (q = 0; q < nfa->nStates; q++)
+		if (nfa->isAccept[q])
+			NFA_ADD_STATE(index->accepting, q);
+
+	/* Count the byte edges and the epsilon edges of every state. */
+	SAFE_CALLOC(index->byteStart, unsigned int, (nfa->nStates + 1));
+	SAFE_CALLOC(index->epsilonStart, unsigned int, (nfa->nStates + 1));
+	for (edge = nfa->edges; edge < nfa->edges + nfa->nEdges; edge++) {
+		if (edge->isEpsilon)
+			index->epsilonStart[edge->sourceId + 1]++;
+		else
+			index->byteStart[edge->sourceId + 1]++;
+	}
+	for (q = 0; q < nfa->nStates; q++) {
+		index->byteStart[q + 1] += index->byteStart[q];
+		index->epsilonStart[q + 1] += index->epsilonStart[q];
+	}
+	nByteEdges = index->byteStart[nfa->nStates];
+	SAFE_MALLOC(index->byteSinks, NFAStateId, (nByteEdges + 1));
+	SAFE_MALLOC(index->classStart, unsigned int, (nByteEdges + 1));
+	SAFE_MALLOC(index->epsilonSinks, NFAStateId, (index->epsilonStart[nfa->nStates] + 1));
+	SAFE_MALLOC(index->stack, NFAStateId, (nfa->nStates + 1));
+	SAFE_MALLOC(edgeOf, unsigned int, (nByteEdges + 1));
+
+	/* Place the edges, the stack counts the edges of every state placed so far. */
+	for (q = 0; q < nfa->nStates; q++)
+		index->stack[q] = 0;
+	for (e = 0; e < nfa->nEdges; e++) {
+		edge = nfa->edges + e;
+		if (edge->isEpsilon)
+			index->epsilonSinks[index->epsilonStart[edge->sourceId] + index->stack[edge->sourceId]++] = edge->sinkId;
+	}
+	for (q = 0; q < nfa->nStates; q++)
+		index->stack[q] = 0;
+	for (e = 0; e < nfa->nEdges; e++) {
+		edge = nfa->edges + e;
+		unless (edge->isEpsilon)
+			edgeOf[index->byteStart[edge->sourceId] + index->stack[edge->sourceId]++] = e;
+	}
+
+	/* The classes of every byte edge. */
+	index->classStart[0] = 0;
+	for (j = 0; j < nByteEdges; j++) {
+		edge = nfa->edges + edgeOf[j];
+		index->byteSinks[j] = edge->sinkId;
+		index->classStart[j + 1] = index->classStart[j];
+		for (k = 1; k < index->nClasses; k++)
+			if (NFA_HAS_BYTE(edge->bytes, representative[k]))
+				index->classStart[j + 1]++;
+	}
+	SAFE_MALLOC(index->classes, unsigned int, (index->classStart[nByteEdges] + 1));
+	for (j = 0; j < nByteEdges; j++) {
+		edge = nfa->edges + edgeOf[j];
+		for (c = index->classStart[j], k = 1; k < index->nClasses; k++)
+			if (NFA_HAS_BYTE(edge->bytes, representative[k]))
+				index->classes[c++] = k;
+	}
+	free(edgeOf);
+
+	ASSERT_NFAINDEX(index);
+	return index;
+}
+
+/** \brief Releases the arrays of a NFAIndex.
+ ** \param index The NFAIndex
+ ** \memberof NFAIndex
+ **
+ ** The NFAIndex itself is NOT freed.
+ **/
+void finalize_nfai(NFAIndex* index)
+{
+	DECLARE_FUNCTION(finalize_nfai);
+
+	/* Check. */
+	ASSERT_NFAINDEX(index);
+
+	free(index->accepting);
+	free(index->byteStart);
+	free(index->byteSinks);
+	free(index->classStart);
+	free(index->classes);
+	free(index->epsilonStart);
+	free(index->epsilonSinks);
+	free(index->stack);
+	index->accepting = NULL;
+	index->byteStart = NULL;
+	index->byteSinks = NULL;
+	index->classStart = NULL;
+	index->classes = NULL;
+	index->epsilonStart = NULL;
+	index->epsilonSinks = NULL;
+	index->stack = NULL;
+}
+
+/** \brief Adds to a set of NFA states every state reachable from it through epsilon edges.
+ ** \param index The NFAIndex
+ ** \param set The set, nWords words
+ ** \memberof NFAIndex
+ **/
+void close_nfai(NFAIndex* index, unsigned long* set)
+{
+	/* Variable declarations. */
+	unsigned int w, j, nStack;
+	unsigned long word;
+	NFAStateId q;
+
+	nStack = 0;
+	for (w = 0; w < index->nWords; w++)
+		for (word = set[w], q = w * NFA_WORD_BITS; word; word >>= 1, q++)
+			if (word & 1)
+				index->stack[nStack++] = q;
+	while (nStack) {
+		q = index->stack[--nStack];
+		for (j = index->epsilonStart[q]; j < index->epsilonStart[q + 1]; j++) {
+			unless (NFA_HAS_STATE(set, index->epsilonSinks[j])) {
+				NFA_ADD_STATE(set, index->epsilonSinks[j]);
+				index->stack[nStack++] = index->epsilonSinks[j];
+			}
+		}
+	}
+}
+
+/** \brief Moves a closed set of NFA states along the byte edges of one class, then closes the result.
+ ** \param index The NFAIndex
+ ** \param set The set, nWords words
+ ** \param k The byte class
+ ** \param target The result, nWords words, empty if no edge of the class leaves the set
+ ** \memberof NFAIndex
+ **/
+void move_nfai(NFAIndex* index, const unsigned long* set, const unsigned int k, unsigned long* target)
+{
+	/* Variable declarations. */
+	unsigned int w, j, c;
+	unsigned long word;
+	NFAStateId q;
+
+	memset(target, 0, index->nWords * sizeof(unsigned long));
+	for (w = 0; w < index->nWords; w++) {
+		for (word = set[w], q = w * NFA_WORD_BITS; word; word >>= 1, q++) {
+			unless (word & 1)
+				continue;
+			for (j = index->byteStart[q]; j < index->byteStart[q + 1]; j++) {
+				for (c = index->classStart[j]; c < index->classStart[j + 1] && index->classes[c] < k; c++);
+				if (c < index->classStart[j + 1] && index->classes[c] == k)
+					NFA_ADD_STATE(target, index->byteSinks[j]);
+			}
+		}
+	}
+	close_nfai(index, target);
+}
+
+/** \brief Checks whether a set of NFA states holds an accepting state.
+ ** \param index The NFAIndex
+ ** \param set The set, nWords words
+ ** \returns 1 if it does, 0 otherwise.
+ ** \memberof NFAIndex
+ **/
+int isAccept_nfai(const NFAIndex* index, const unsigned long* set)
+{
+	/* Variable declaration. */
+	unsigned int w;
+
+	for (w = 0; w < index->nWords; w++)
+		if (set[w] & index->accepting[w])
+			return 1;
+	return 0;
+}
+
+/** \brief Checks whether a set of NFA states is empty.
+ ** \param index The NFAIndex
+ ** \param set The set, nWords words
+ ** \returns 1 if it is, 0 otherwise.
+ ** \memberof NFAIndex
+ **/
+int isEmpty_nfai(const NFAIndex* index, const unsigned long* set)
+{
+	/* Variable declaration. */
+	unsigned int w;
+
+	for (w = 0; w < index->nWords; w++)
+		if (set[w])
+			return 0;
+	return 1;
+}
+
+/** \brief Initializes an empty NFASubsets.
+ ** \param subsets The NFASubsets
+ ** \param nWords The number of words of every set
+ ** \param capacity The number of sets to make room for, more are made room for on demand
+ ** \returns A pointer to the NFASubsets.
+ ** \memberof NFASubsets
+ **
+ ** The slots are made room for so that capacity sets fit without a rehash.
+ **/
+NFASubsets* initialize_nfas(NFASubsets* subsets, const unsigned int nWords, const unsigned int capacity)
+{
+	DECLARE_FUNCTION(initialize_nfas);
+
+	/* Check. */
+	ASSERT_NOT_ZERO(capacity);
+
+	unless (subsets)
+		SAFE_MALLOC(subsets, NFASubsets, 1);
+
+	subsets->nWords = nWords;
+	subsets->nSets = 0;
+	subsets->setCapacity = capacity;
+	SAFE_MALLOC(subsets->sets, unsigned long, ((size_t)capacity * nWords + 1));
+	SAFE_MALLOC(subsets->hashes, unsigned long, capacity);
+	for (subsets->capacity = 2 * NFA_INITIAL_CAPACITY; subsets->capacity < 2 * capacity; subsets->capacity *= 2);
+	SAFE_MALLOC(subsets->slots, DFAStateId, subsets->capacity);
+	memset(subsets->slots, 0xFF, subsets->capacity * sizeof(DFAStateId));
+
+	ASSERT_NFASUBSETS(subsets);
+	return subsets;
+}
+
+/** \brief Releases the sets of a NFASubsets.
+ ** \param subsets The NFASubsets
+ ** \memberof NFASubsets
+ **
+ ** The NFASubsets itself is NOT freed.
+ **/
+void finalize_nfas(NFASubsets* subsets)
+{
+	DECLARE_FUNCTION(finalize_nfas);
+
+	/* Check. */
+	ASSERT_NFASUBSETS(subsets);
+
+	free(subsets->sets);
+	free(subsets->hashes);
+	free(subsets->slots);
+	subsets->sets = NULL;
+	subsets->hashes = NULL;
+	subsets->slots = NULL;
+	subsets->nSets = 0;
+	subsets->setCapacity = 0;
+}
+
+/** \brief Forgets every set of a NFASubsets, keeping the room made for them.
+ ** \param subsets The NFASubsets
+ ** \memberof NFASubsets
+ **/
+void clear_nfas(NFASubsets* subsets)
+{
+	DECLARE_FUNCTION(clear_nfas);
+
+	/* Check. */
+	ASSERT_NFASUBSETS(subsets);
+
+	subsets->nSets = 0;
+	memset(subsets->slots, 0xFF, subsets->capacity * sizeof(DFAStateId));
+}
+
+/** \brief Hashes a set of NFA states.
+ ** \param subsets The NFASubsets
+ ** \param set The set, nWords words
+ ** \returns The hash value.
+ ** \memberof NFASubsets
+ **/
+unsigned long private_hash_nfas(const NFASubsets* subsets, const unsigned long* set)
+{
+	/* Variable declarations. */
+	unsigned long hashValue;
+	unsigned int w;
+
+	for (hashValue = 5381, w = 0; w < subsets->nWords; w++)
+		hashValue = (hashValue ^ set[w] ^ (set[w] >> 29) ^ (set[w] >> 13)) * 2654435761UL;
+	return hashValue ^ (hashValue >> 16);
+}
+
+/** \brief Returns the slot of a set of NFA states, or the empty slot where it would go.
+ ** \param subsets The NFASubsets
+ ** \param set The set, nWords words
+ ** \param hashValue The hash value of the set
+ ** \returns The slot.
+ ** \memberof NFASubsets
+ **/
+unsigned int private_slot_nfas(const NFASubsets* subsets, const unsigned long* set, const unsigned long hashValue)
+{
+	/* Variable declarations. */
+	unsigned int slot;
+	DFAStateId id;
+
+	for (slot = hashValue & (subsets->capacity - 1); subsets->slots[slot] != DFA_NO_STATE; slot = (slot + 1) & (subsets->capacity - 1)) {
+		id = subsets->slots[slot];
+		if (subsets->hashes[id] == hashValue && !memcmp(subsets->sets + (size_t)id * subsets->nWords, set, subsets->nWords * sizeof(unsigned long)))
+			break;
+	}
+	return slot;
+}
+
+/** \brief Returns the id of a set of NFA states.
+ ** \param subsets The NFASubsets
+ ** \param set The set, nWords words
+ ** \returns The id, DFA_NO_STATE if the set is not there.
+ ** \memberof NFASubsets
+ **/
+DFAStateId find_nfas(const NFASubsets* subsets, const unsigned long* set)
+{
+	return subsets->slots[private_slot_nfas(subsets, set, private_hash_nfas(subsets, set))];
+}
+
+/** \brief Returns the id of a set of NFA states, adding it if it is new.
+ ** \param subsets The NFASubsets
+ ** \param set The set, nWords words
+ ** \returns The id, equal to the previous number of sets if the set is new.
+ ** \memberof NFASubsets
+ **/
+DFAStateId intern_nfas(NFASubsets* subsets, const unsigned long* set)
+{
+	DECLARE_FUNCTION(intern_nfas);
+
+	/* Variable declarations. */
+	unsigned long hashValue;
+	unsigned int slot;
+	DFAStateId id, other;
+
+	hashValue = private_hash_nfas(subsets, set);
+	slot = private_slot_nfas(subsets, set, hashValue);
+	if (subsets->slots[slot] != DFA_NO_STATE)
+		return subsets->slots[slot];
+
+	/* A new set. */
+	if (subsets->nSets == subsets->setCapacity) {
+		subsets->setCapacity *= 2;
+		SAFE_REALLOC(subsets->sets, unsigned long, ((size_t)subsets->setCapacity * subsets->nWords + 1));
+		SAFE_REALLOC(subsets->hashes, unsigned long, subsets->setCapacity);
+	}
+	id = subsets->nSets++;
+	memcpy(subsets->sets + (size_t)id * subsets->nWords, set, subsets->nWords * sizeof(unsigned long));
+	subsets->hashes[id] = hashValue;
+	subsets->slots[slot] = id;
+
+	/* Keep at least half of the slots empty. */
+	if (2 * subsets->nSets > subsets->capacity) {
+		free(subsets->slots);
+		subsets->capacity *= 2;
+		SAFE_MALLOC(subsets->slots, DFAStateId, subsets->capacity);
+		memset(subsets->slots, 0xFF, subsets->capacity * sizeof(DFAStateId));
+		for (other = 0; other < subsets->nSets; other++) {
+			for (slot = subsets->hashes[other] & (subsets->capacity - 1); subsets->slots[slot] != DFA_NO_STATE; slot = (slot + 1) & (subsets->capacity - 1));
+			subsets->slots[slot] = other;
+		}
+	}
+
+	return id;
+}
+
+/** \brief Builds a DeterministicFiniteAutomaton from a NondeterministicFiniteAutomaton with the subset construction.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ ** \memberof NondeterministicFiniteAutomaton
+ **
+ ** The edges are indexed by byte class in a NFAIndex. The sets are bitsets,
+ ** closed under epsilon edges and hash-consed in a NFASubsets, whose ids are
+ ** the ids of the DFA states; the empty set is left out, its transitions stay
+ ** missing. Only the reachable sets are built, in breadth-first order from
+ ** the closure of the initial state. The alphabet holds every byte of every
+ ** edge, and the alphabet of the NFA if it has one, so that a complement
+ ** also accepts its unused symbols.
+ **/
+DeterministicFiniteAutomaton* toDfa_nfa(DeterministicFiniteAutomaton* dfa, const NondeterministicFiniteAutomaton* nfa)
+{
+	DECLARE_FUNCTION(toDfa_nfa);
+
+	/* Variable declarations. */
+	unsigned int b, j, c, k, t, w, nWords, nTouched;
+	unsigned int* touched;
+	NFAStateId q;
+	DFAStateId d, sinkId;
+	unsigned long word;
+	unsigned long *targets, *target;
+	unsigned char* isTouched;
+	char* alphabetEnd;
+	DFAState* state;
+	NFAIndex iBuffer, *index = &iBuffer;
+	NFASubsets sBuffer, *subsets = &sBuffer;
+
+	/* Check. */
+	ASSERT_NFA(nfa);
+
+	dfa = initialize_dfa(dfa);
+	fromPattern(dfa->name, DFA_MAX_NAME_SIZE, "%s", nfa->name);
+	index = initialize_nfai(index, nfa);
+	nWords = index->nWords;
+
+	/* The alphabet. */
+	alphabetEnd = dfa->alphabet;
+	for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+		if (index->classOf[b] || strchr(nfa->alphabet, (int)b))
+			*alphabetEnd++ = (char)b;
+	if (alphabetEnd > dfa->alphabet)
+		*alphabetEnd = '\0';
+
+	subsets = initialize_nfas(subsets, nWords, NFA_INITIAL_CAPACITY);
+	SAFE_MALLOC(targets, unsigned long, ((size_t)index->nClasses * nWords));
+	SAFE_CALLOC(isTouched, unsigned char, index->nClasses);
+	SAFE_MALLOC(touched, unsigned int, index->nClasses);
+
+	/* The closure of the initial state is the initial state. */
+	memset(targets, 0, nWords * sizeof(unsigned long));
+	NFA_ADD_STATE(targets, nfa->initialStateId);
+	close_nfai(index, targets);
+	intern_nfas(subsets, targets);
+	state = insertState_dfa(dfa, NULL, 0);
+	state->isAccept = isAccept_nfai(index, targets);
+	dfa->initialStateId = 0;
+
+	for (d = 0; d < subsets->nSets; d++) {
+		/* Move every state of the set along its byte edges, class by class. */
+		nTouched = 0;
+		for (w = 0; w < nWords; w++) {
+			for (word = subsets->sets[(size_t)d * nWords + w], q = w * NFA_WORD_BITS; word; word >>= 1, q++) {
+				unless (word & 1)
+					continue;
+				for (j = index->byteStart[q]; j < index->byteStart[q + 1]; j++) {
+					for (c = index->classStart[j]; c < index->classStart[j + 1]; c++) {
+						k = index->classes[c];
+						target = targets + (size_t)k * nWords;
+						unless (isTouched[k]) {
+							isTouched[k] = 1;
+							touched[nTouched++] = k;
+							memset(target, 0, nWords * sizeof(unsigned long));
+						}
+						NFA_ADD_STATE(target, index->byteSinks[j]);
+					}
+				}
+			}
+		}
+
+		/* Close every target and find its DFA state. */
+		for (t = 0; t < nTouched; t++) {
+			k = touched[t];
+			isTouched[k] = 0;
+			target = targets + (size_t)k * nWords;
+			close_nfai(index, target);
+			sinkId = intern_nfas(subsets, target);
+			if (sinkId == dfa->states->nStates) {
+				state = insertState_dfa(dfa, NULL, 0);
+				state->isAccept = isAccept_nfai(index, target);
+			}
+			for (b = 1; b < DFA_MAX_SYMBOLS; b++)
+				if (index->classOf[b] == k)
+					dfa->transitions[d][b] = sinkId;
+		}
+	}
+	say(MSG_REPORT_VAR("DFA States", "%u", dfa->states->nStates));
+
+	free(targets);
+	free(isTouched);
+	free(touched);
+	finalize_nfas(subsets);
+	finalize_nfai(index);
+
+	ASSERT_DFA(dfa);
+	return dfa;
+}
@@ -2,11 +2,22 @@
  ** \brief Implements all the member functions of Xml
  **/
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef _POSIX_MAPPED_FILES
+	#include <sys/mman.h>
+#endif
+#include "arena.h"
 #include "constants.h"
 #include "debug.h"
-#include "list.h"
+#include "intern.h"
 #include "stdioplus.h"
+#include "stdlibplus.h"
+#include "stringplus.h"
 #include "unless.h"
 #include "until.h"
 #include "xml.h"
@@ -117,19 +128,20 @@ char* private_fromXmlString(char* str, const char* xmlstr)
 	}
 
 	len = ptr - str;
-	ASSERT_FITS_IN_BOUND(len, XML_MAX_CONTENT_SIZE);
+	ASSERT_FITS_IN_BOUND(len, BUFFER_SIZE);
 
 	return str;
 }
 
 /** \brief Initializes an XmlAttribute.
  ** \param attribute The XmlAttribute
+ ** \param arena The Arena holding the name and the value
  ** \param name The attribute name
  ** \param value The attribute value as XmlString
  ** \returns A pointer to the XmlAttribute.
  ** \memberof XmlAttribute
  **/
-XmlAttribute* initialize_xattr(XmlAttribute* attribute, const char* name, const char* value)
+XmlAttribute* initialize_xattr(XmlAttribute* attribute, Arena* arena, const char* name, const char* value)
 {
 	DECLARE_FUNCTION(initialize_xattr);
 
@@ -137,29 +149,23 @@ XmlAttribute* initialize_xattr(XmlAttribute* attribute, const char* name, const
 	char* check;
 
 	/* Checks. */
+	ASSERT_ARENA(arena);
 	ASSERT_NOT_NULL(name);
 	ASSERT_NOT_EMPTY(name);
-	ASSERT_NOT_TOO_LONG(name, XML_MAX_ATTRIBUTE_NAME_SIZE);
 	ASSERT_NOT_NULL(value);
-	ASSERT_NOT_EMPTY(value);
 	ASSERT_NOT_TOO_LONG(value, BUFFER_SIZE);
 
-	unless (attribute)
-		SAFE_MALLOC(attribute, XmlAttribute, 1);
+	unless (attribute) {
+		SAFE_ARENA_MALLOC(attribute, arena, XmlAttribute, 1);
+	}
 
-	check = fromPattern(
-		attribute->name,
-		XML_MAX_ATTRIBUTE_NAME_SIZE,
-		"%s",
-		name
-	);
-	ASSERT_NOT_NULL(check);
-	ASSERT_NOT_EMPTY(check);
+	attribute->name = fromSlice_arena(arena, name, strlen(name));
+	ASSERT_NOT_NULL(attribute->name);
 
+	/* An ordinary string is never longer than its Xml string. */
+	SAFE_ARENA_MALLOC(attribute->value, arena, char, (strlen(value) + 1));
 	check = private_fromXmlString(attribute->value, value);
 	ASSERT_NOT_NULL(check);
-	ASSERT_NOT_EMPTY(check);
-	ASSERT_NOT_TOO_LONG(check, XML_MAX_ATTRIBUTE_VAL_SIZE);
 
 	return attribute;
 }
@@ -192,52 +198,89 @@ char* toString_xattr(char* str, const XmlAttribute* attribute)
 	return str;
 }
 
-IMPLEMENT_ARRAY_FUNCTIONS_OF(XmlAttribute,XML_MAX_ATTRIBUTES,size,array,xattra,xattr)
-IMPLEMENT_LIST_FUNCTIONS_OF(XmlAttribute,XML_MAX_ATTRIBUTES,size,list,array,xattrl,xattr)
-
 /** \brief Initalizes an XmlNode.
  ** \param node The XmlNode
- ** \param parent The parent id
+ ** \param arena The Arena holding the children, contents and attributes
+ ** \param parent The parent XmlNode, NULL if there is none
  ** \returns A pointer to the XmlNode.
  ** \memberof XmlNode
  **/
-XmlNode* initialize_xmln(XmlNode* node, XmlNode* parent)
+XmlNode* initialize_xmln(XmlNode* node, Arena* arena, XmlNode* parent)
 {
 	DECLARE_FUNCTION(initialize_xmln);
 
-	/* Variable declarations. */
-	unsigned int i;
-	XmlAttributeArray* check;
+	/* Check. */
+	ASSERT_ARENA(arena);
 
-	unless (node)
-		SAFE_MALLOC(node, XmlNode, 1);
+	unless (node) {
+		SAFE_ARENA_MALLOC(node, arena, XmlNode, 1);
+	}
 
 	/* NULL parent means there is no parent. */
 	node->parent = parent;
 	if (parent) {
+		ASSERT_XMLNODE(parent);
+
+		/* Make room for one more child, and the content after it. */
+		if (parent->nChildren == parent->childCapacity) {
+			SAFE_ARENA_REALLOC(
+				parent->children,
+				arena,
+				XmlNode*,
+				parent->childCapacity,
+				(parent->childCapacity ? 2 * parent->childCapacity : XML_INITIAL_CHILDREN)
+			);
+			SAFE_ARENA_REALLOC(
+				parent->content,
+				arena,
+				char*,
+				(parent->childCapacity + 1),
+				(parent->childCapacity ? 2 * parent->childCapacity + 1 : XML_INITIAL_CHILDREN + 1)
+			);
+			parent->childCapacity = parent->childCapacity ? 2 * parent->childCapacity : XML_INITIAL_CHILDREN;
+		}
+
 		/* Register the child to the parent. */
 		parent->children[parent->nChildren++] = node;
+		parent->content[parent->nChildren] = NULL;
 		ASSERT_XMLNODE(parent);
 	}
 
 	/* Empty tag. */
-	node->tag[0] = '\0';
+	node->tag = NULL;
+	node->tagId = INTERN_NONE;
 
-	/* Empty contents. */
-	for (i = 0; i < XML_MAX_CHILDREN; i++)
-		node->content[i][0] = '\0';
-
-	/* No children. */
+	/* Empty content, no children and no attributes. */
+	SAFE_ARENA_MALLOC(node->content, arena, char*, 1);
+	node->content[0] = NULL;
+	node->children = NULL;
 	node->nChildren = 0;
-
-	/* Initialize attributes. */
-	check = initialize_xattra(node->attributes);
-	ASSERT_XMLATTRIBUTEARRAY(check);
+	node->childCapacity = 0;
+	node->attributes = NULL;
+	node->nAttributes = 0;
+	node->attributeCapacity = 0;
 
 	/* Return the node. */
 	return node;
 }
 
+/** \brief Returns a content of a given XmlNode.
+ ** \param node The XmlNode
+ ** \param i The index of the content, from 0 to nChildren
+ ** \returns The content, an empty string if there is none.
+ ** \memberof XmlNode
+ **/
+const char* getContent_xmln(const XmlNode* node, const unsigned int i)
+{
+	DECLARE_FUNCTION(getContent_xmln);
+
+	/* Checks. */
+	ASSERT_NOT_NULL(node);
+	ASSERT_FITS_IN_BOUND(i, node->nChildren + 1);
+
+	return node->content[i] ? node->content[i] : "";
+}
+
 /** \brief Returns a string representation of a given XmlNode.
  ** \param str The string
  ** \param xml The Xml
@@ -272,8 +315,8 @@ char* toString_xmln(char* str, const XmlNode* node)
 
 	/* Write attributes. */
 	for (
-		attribute = node->attributes->array;
-		attribute < node->attributes->array + node->attributes->size;
+		attribute = node->attributes;
+		attribute < node->attributes + node->nAttributes;
 		attribute++
 	) {
 		ASSERT_XMLATTRIBUTE(attribute);
@@ -294,7 +337,7 @@ char* toString_xmln(char* str, const XmlNode* node)
 
 	/* Write the content. */
 	for (i = 0; i < node->nChildren; i++) {
-		ptr = private_toXmlString(ptr, node->content[i]);
+		ptr = private_toXmlString(ptr, getContent_xmln(node, i));
 		ASSERT_NOT_NULL(ptr);
 		ptr += strlen(ptr);
 
@@ -307,7 +350,7 @@ char* toString_xmln(char* str, const XmlNode* node)
 
 		ptr += strlen(ptr);
 	}
-	ptr = private_toXmlString(ptr, node->content[i]);
+	ptr = private_toXmlString(ptr, getContent_xmln(node, i));
 	ASSERT_NOT_NULL(ptr);
 	ptr += strlen(ptr);
 
@@ -349,14 +392,14 @@ char* toContent_xmln(char* str, const XmlNode* node)
 	/* Check. */
 	ASSERT_XMLNODE(node);
 
-	ptr = fromPattern(str, BUFFER_SIZE, "%s", node->content[0]);
+	ptr = fromPattern(str, BUFFER_SIZE, "%s", getContent_xmln(node, 0));
 	ASSERT_NOT_NULL(ptr);
 	for (i = 0; i < node->nChildren; i++) {
 		ptr += strlen(ptr);
 		ptr = toContent_xmln(ptr, node->children[i]);
 		ASSERT_NOT_NULL(ptr);
 		ptr += strlen(ptr);
-		ptr = fromPattern(ptr, BUFFER_SIZE, "%s", node->content[i+1]);
+		ptr = fromPattern(ptr, BUFFER_SIZE, "%s", getContent_xmln(node, i+1));
 		ASSERT_NOT_NULL(ptr);
 	}
 
@@ -364,318 +407,735 @@ char* toContent_xmln(char* str, const XmlNode* node)
 	return str;
 }
 
-IMPLEMENT_ARRAY_FUNCTIONS_OF(XmlNode,XML_MAX_NODES,size,nodes,xmlna,xmln)
-IMPLEMENT_LIST_FUNCTIONS_OF(XmlNode,XML_MAX_NODES,size,nodes,nodes,xmlnl,xmln)
-
 /** \brief Initializes an Xml object.
  ** \param xml The Xml
+ ** \param arena The Arena holding the Xml tree
  ** \returns A pointer to the Xml.
  ** \memberof Xml
  **/
-Xml* initialize_xml(Xml* xml)
+Xml* initialize_xml(Xml* xml, Arena* arena)
 {
 	DECLARE_FUNCTION(initialize_xml);
 
-	/* Variable declaration. */
-	char* check;
-	XmlNodeArray* check2;
+	/* Check. */
+	ASSERT_ARENA(arena);
+
+	unless (xml) {
+		SAFE_ARENA_MALLOC(xml, arena, Xml, 1);
+	}
+	xml->arena = arena;
 
-	unless (xml)
-		SAFE_MALLOC(xml, Xml, 1);
+	xml->meta = fromSlice_arena(arena, XML_DEFAULT_META, strlen(XML_DEFAULT_META));
+	ASSERT_NOT_NULL(xml->meta);
 
-	check = fromPattern(xml->meta, XML_META_MAX_SIZE, "%s", XML_DEFAULT_META);
-	ASSERT_NOT_NULL(check);
-	ASSERT_NOT_EMPTY(check);
+	xml->root = NULL;
+	xml->nNodes = 0;
 
-	check2 = initialize_xmlna(xml->tree);
-	ASSERT_XMLNODEARRAY(check2);
+	initialize_it(xml->tags, arena);
+	ASSERT_INTERNTABLE(xml->tags);
 
 	return xml;
 }
 
-/** \brief Creates an Xml from an Xml string.
- ** \param xml The Xml
- ** \param xmlstr The Xml string
- ** \returns A pointer to the Xml.
- ** \memberof Xml
+/** \brief The state of the event-driven Xml reader between two chunks.
+ **/
+typedef struct XmlReaderBody {
+	const XmlHandler* handler;
+	void* context;
+	char* tags;
+	size_t tagsSize;
+	size_t tagsCapacity;
+	char* scratch;
+	size_t scratchCapacity;
+} XmlReader;
+
+/** \brief Initializes an XmlReader.
+ ** \param reader The XmlReader
+ ** \param handler The XmlHandler
+ ** \param context The context passed to every callback
+ ** \returns A pointer to the XmlReader.
+ ** \related Xml
  **/
-Xml* fromString_xml(Xml* xml, const char* xmlstr)
+XmlReader* private_initialize_xmlr(XmlReader* reader, const XmlHandler* handler, void* context)
 {
-	DECLARE_FUNCTION(fromString_xml);
+	DECLARE_FUNCTION(private_initialize_xmlr);
+
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	ASSERT_NOT_NULL(handler);
+
+	reader->handler = handler;
+	reader->context = context;
+	reader->tagsSize = 0;
+	reader->tagsCapacity = XML_INITIAL_TAGS_SIZE;
+	SAFE_MALLOC(reader->tags, char, reader->tagsCapacity);
+	reader->scratchCapacity = BUFFER_SIZE;
+	SAFE_MALLOC(reader->scratch, char, reader->scratchCapacity);
+
+	return reader;
+}
+
+/** \brief Releases the memory of an XmlReader and checks that every tag is closed.
+ ** \param reader The XmlReader
+ ** \related Xml
+ **/
+void private_finalize_xmlr(XmlReader* reader)
+{
+	DECLARE_FUNCTION(private_finalize_xmlr);
+
+	/* Check. */
+	ASSERT_NOT_NULL(reader);
+
+	errorIf(reader->tagsSize, MSG_ERROR_SYNTAX("Unclosed Tag"));
+
+	free(reader->tags);
+	free(reader->scratch);
+}
+
+/** \brief Converts an Xml slice to an ordinary slice, using the scratch buffer of an XmlReader if needed.
+ ** \param reader The XmlReader
+ ** \param xmlstr The Xml slice
+ ** \param xmllen The length of the Xml slice
+ ** \param len The length of the ordinary slice
+ ** \returns A pointer to the ordinary slice.
+ ** \related Xml
+ **/
+const char* private_unescape_xmlr(XmlReader* reader, const char* xmlstr, const size_t xmllen, size_t* len)
+{
+	DECLARE_FUNCTION(private_unescape_xmlr);
 
 	/* Variable declarations. */
-	unsigned int i, len;
-	char xmlContent[BUFFER_SIZE];
-	char xmlValue[BUFFER_SIZE];
-	char begin_quote;
-	const char* ptr;
-	XmlNode* node;
-	XmlNode* parent;
-	XmlAttribute* attribute;
+	const char* xmlptr;
+	const char* xmlend;
+	char* ptr;
 
 	/* Checks. */
+	ASSERT_NOT_NULL(reader);
 	ASSERT_NOT_NULL(xmlstr);
-	ASSERT_NOT_EMPTY(xmlstr);
-	ASSERT_NOT_TOO_LONG(xmlstr, BUFFER_LARGE_SIZE);
+	ASSERT_NOT_NULL(len);
 
-	xml = initialize_xml(xml);
-	ASSERT_XML(xml);
+	/* A slice without entities is already ordinary, so it is NOT copied. */
+	unless (memchr(xmlstr, XML_AMP_SYMBOL, xmllen)) {
+		*len = xmllen;
+		return xmlstr;
+	}
 
-	/* Skip spaces. */
-	for (ptr = xmlstr; (*ptr) && isspace(*ptr); ptr++);
-	ASSERT_NOT_EMPTY(ptr);
+	/* An ordinary slice is never longer than its Xml slice. */
+	if (reader->scratchCapacity < xmllen) {
+		reader->scratchCapacity = xmllen;
+		SAFE_REALLOC(reader->scratch, char, reader->scratchCapacity);
+	}
 
-	/* Must begin with XML_NODE_BEGIN. */
-	errorUnless(
-		*ptr == XML_NODE_BEGIN_SYMBOL,
-		MSG_ERROR_SYNTAX("Expected 'XML_NODE_BEGIN'")
-	);
+	xmlend = xmlstr + xmllen;
+	for (xmlptr = xmlstr, ptr = reader->scratch; xmlptr < xmlend; ptr++)
+	{
+		if (*xmlptr != XML_AMP_SYMBOL) {
+			*ptr = *(xmlptr++);
+		} else if (xmlend - xmlptr >= (long)strlen(XML_LT) && !strncmp(xmlptr, XML_LT, strlen(XML_LT))) {
+			*ptr = XML_NODE_BEGIN_SYMBOL;
+			xmlptr += strlen(XML_LT);
+		} else if (xmlend - xmlptr >= (long)strlen(XML_GT) && !strncmp(xmlptr, XML_GT, strlen(XML_GT))) {
+			*ptr = XML_NODE_END_SYMBOL;
+			xmlptr += strlen(XML_GT);
+		} else if (xmlend - xmlptr >= (long)strlen(XML_QUOTE) && !strncmp(xmlptr, XML_QUOTE, strlen(XML_QUOTE))) {
+			*ptr = XML_QUOTE_SYMBOL;
+			xmlptr += strlen(XML_QUOTE);
+		} else if (xmlend - xmlptr >= (long)strlen(XML_APOSTROPHE) && !strncmp(xmlptr, XML_APOSTROPHE, strlen(XML_APOSTROPHE))) {
+			*ptr = XML_APOSTROPHE_SYMBOL;
+			xmlptr += strlen(XML_APOSTROPHE);
+		} else if (xmlend - xmlptr >= (long)strlen(XML_AMP) && !strncmp(xmlptr, XML_AMP, strlen(XML_AMP))) {
+			*ptr = XML_AMP_SYMBOL;
+			xmlptr += strlen(XML_AMP);
+		} else {
+			*ptr = *(xmlptr++);
+		}
+	}
 
-	/* Skip the XML_NODE_BEGIN_SYMBOL. */
-	ptr++;
-	ASSERT_NOT_EMPTY(ptr);
+	*len = ptr - reader->scratch;
+	return reader->scratch;
+}
 
-	/* Skip all the meta nodes. */
-	until (*ptr != XML_META_SYMBOL) {
-		xml->meta[0] = XML_NODE_BEGIN_SYMBOL;
+/** \brief Finds the first occurrence of a string in a slice.
+ ** \param begin The beginning of the slice
+ ** \param end The end of the slice
+ ** \param str The string
+ ** \returns A pointer to the occurrence, NULL if there is none.
+ ** \related Xml
+ **/
+const char* private_find_xmlr(const char* begin, const char* end, const char* str)
+{
+	/* Variable declarations. */
+	size_t len;
+	const char* ptr;
 
-		/* Skip everything until XML_NODE_END. */
-		for (i = 1; (*ptr) && *ptr != XML_NODE_END_SYMBOL; i++, ptr++)
-			xml->meta[i] = *ptr;
-		ASSERT_NOT_EMPTY(ptr);
-		xml->meta[i++] = *ptr;
-		ASSERT_NOT_EMPTY(ptr);
-		xml->meta[i] = '\0';
-		ASSERT_NOT_TOO_LONG(xml->meta, XML_META_MAX_SIZE);
+	len = strlen(str);
+	for (ptr = begin; ptr + len <= end; ptr++)
+		if (*ptr == *str && !strncmp(ptr, str, len))
+			return ptr;
 
-		/* Skip the node end. */
-		ptr++;
-		ASSERT_NOT_EMPTY(ptr);
+	return NULL;
+}
 
-		/* Skip spaces. */
-    	for (; (*ptr) && isspace(*ptr); ptr++);
-		ASSERT_NOT_EMPTY(ptr);
+/** \brief Reports a start tag with its attributes.
+ ** \param reader The XmlReader
+ ** \param begin The first character after XML_NODE_BEGIN_SYMBOL
+ ** \param end The XML_NODE_END_SYMBOL of the tag
+ ** \related Xml
+ **/
+void private_startTag_xmlr(XmlReader* reader, const char* begin, const char* end)
+{
+	DECLARE_FUNCTION(private_startTag_xmlr);
+
+	/* Variable declarations. */
+	int isEmpty;
+	char quote;
+	size_t len, tagLen;
+	const char* ptr;
+	const char* name;
+	const char* nameEnd;
+	const char* value;
+	const XmlHandler* handler;
 
-		/* Must begin with XML_NODE_BEGIN. */
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	ASSERT_NOT_NULL(begin);
+	ASSERT_NOT_NULL(end);
+
+	handler = reader->handler;
+
+	/* An empty element ends with XML_NODE_STOP_SYMBOL. */
+	isEmpty = (end > begin && *(end - 1) == XML_NODE_STOP_SYMBOL);
+	if (isEmpty)
+		end--;
+
+	/* The tag. */
+	for (ptr = begin; ptr < end && !isspace((unsigned char)*ptr); ptr++);
+	errorIf(ptr == begin, MSG_ERROR_SYNTAX("Expected a Tag"));
+	len = tagLen = ptr - begin;
+	if (handler->startTag)
+		handler->startTag(reader->context, begin, tagLen);
+
+	/* Remember the tag to match it with its end tag. */
+	unless (isEmpty) {
+		while (reader->tagsSize + len + 1 > reader->tagsCapacity) {
+			reader->tagsCapacity *= 2;
+			SAFE_REALLOC(reader->tags, char, reader->tagsCapacity);
+		}
+		memcpy(reader->tags + reader->tagsSize, begin, len);
+		reader->tagsSize += len;
+		reader->tags[reader->tagsSize++] = '\0';
+	}
+
+	/* The attributes. */
+	for (;;) {
+		for (; ptr < end && isspace((unsigned char)*ptr); ptr++);
+		unless (ptr < end)
+			break;
+
+		name = ptr;
+		for (; ptr < end && *ptr != XML_EQUAL_SYMBOL && !isspace((unsigned char)*ptr); ptr++);
+		nameEnd = ptr;
+		for (; ptr < end && isspace((unsigned char)*ptr); ptr++);
+		errorUnless(ptr < end && *ptr == XML_EQUAL_SYMBOL, MSG_ERROR_SYNTAX("Expected '='"));
+		for (ptr++; ptr < end && isspace((unsigned char)*ptr); ptr++);
+
+		/* Must begin with a quote. */
 		errorUnless(
-			*ptr == XML_NODE_BEGIN_SYMBOL,
-			MSG_ERROR_SYNTAX("Expected 'XML_NODE_BEGIN'")
+			ptr < end && (*ptr == XML_QUOTE_SYMBOL || *ptr == XML_APOSTROPHE_SYMBOL),
+			MSG_ERROR_SYNTAX("Expected 'QUOTE'")
 		);
+		quote = *(ptr++);
+		for (value = ptr; ptr < end && *ptr != quote; ptr++);
+		errorUnless(ptr < end, MSG_ERROR_SYNTAX("Expected 'QUOTE'"));
+
+		if (handler->attribute) {
+			len = ptr - value;
+			value = private_unescape_xmlr(reader, value, len, &len);
+			handler->attribute(reader->context, name, nameEnd - name, value, len);
+		}
 
-		/* Skip the XML_NODE_BEGIN_SYMBOL. */
+		/* Skip the quote. */
 		ptr++;
-		ASSERT_NOT_EMPTY(ptr);
 	}
 
-	node = xml->tree->nodes;
-	parent = NULL;
-	while (node) {
-		/* Allocate a node from the Xml tree. */
-		node = getNew_xmlna(xml->tree);
-		ASSERT_XMLNODEARRAY(xml->tree);
-
-		/* Initialize the node. */
-		node = initialize_xmln(node, parent);
-		ASSERT_NOT_NULL(node);
-
-		/* Fill the tag information. */
-		i = 0;
-		while ((*ptr) && !isspace(*ptr) && *ptr != XML_NODE_END_SYMBOL && *ptr != XML_NODE_STOP_SYMBOL)
-			node->tag[i++] = *(ptr++);
-		node->tag[i] = '\0';
-		ASSERT_FITS_IN_BOUND(i, XML_MAX_TAG_SIZE);
-		ASSERT_NOT_EMPTY(ptr);
+	if (isEmpty && handler->endTag)
+		handler->endTag(reader->context, begin, tagLen);
+}
 
-		/* Skip spaces. */
-		for (; (*ptr) && isspace(*ptr); ptr++);
-		ASSERT_NOT_EMPTY(ptr);
+/** \brief Reports an end tag, after checking that it closes the last open tag.
+ ** \param reader The XmlReader
+ ** \param begin The first character of the tag
+ ** \param end The XML_NODE_END_SYMBOL of the tag
+ ** \related Xml
+ **/
+void private_endTag_xmlr(XmlReader* reader, const char* begin, const char* end)
+{
+	DECLARE_FUNCTION(private_endTag_xmlr);
 
-		/* Fill the attributes. */
-		until (*ptr == XML_NODE_STOP_SYMBOL || *ptr == XML_NODE_END_SYMBOL) {
-			attribute = getNew_xattra(node->attributes);
-			ASSERT_XMLATTRIBUTEARRAY(node->attributes);
-
-			/* Fill the attribute name. */
-			i = 0;
-			while ((*ptr) && *ptr != XML_EQUAL_SYMBOL)
-				attribute->name[i++] = *(ptr++);
-			attribute->name[i] = '\0';
-			ASSERT_FITS_IN_BOUND(i, XML_MAX_ATTRIBUTE_NAME_SIZE);
-			ASSERT_NOT_EMPTY(ptr);
-
-			/* Skip the equal sign. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
-
-			/* Must begin with a quote. */
-			begin_quote = *ptr;
-			errorUnless(
-				begin_quote == XML_QUOTE_SYMBOL || begin_quote == XML_APOSTROPHE_SYMBOL,
-				MSG_ERROR_SYNTAX("Expected 'QUOTE'")
-			);
+	/* Variable declarations. */
+	size_t len, top;
+
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	errorUnless(reader->tagsSize, MSG_ERROR_SYNTAX("Unexpected End Tag"));
+
+	/* Trim the trailing spaces. */
+	for (; end > begin && isspace((unsigned char)*(end - 1)); end--);
+	len = end - begin;
 
-			/* Skip the quote. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
-
-			/* Fill the attribute value. */
-			i = 0;
-			while ((*ptr) && *ptr != begin_quote)
-				xmlValue[i++] = *(ptr++);
-			xmlValue[i] = '\0';
-			ASSERT_NOT_EMPTY(ptr);
-			private_fromXmlString(attribute->value, xmlValue);
-			ASSERT_XMLATTRIBUTE(attribute);
-
-			/* Skip the quote. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
-
-			/* Skip spaces. */
-    		for (; (*ptr) && isspace(*ptr); ptr++);
-			ASSERT_NOT_EMPTY(ptr);
+	/* Pop the last open tag. */
+	for (top = reader->tagsSize - 1; top > 0 && reader->tags[top - 1]; top--);
+	errorUnless(
+		reader->tagsSize - 1 - top == len && !strncmp(reader->tags + top, begin, len),
+		MSG_ERROR_SYNTAX("Tag Mismatch")
+	);
+	reader->tagsSize = top;
+
+	if (reader->handler->endTag)
+		reader->handler->endTag(reader->context, begin, len);
+}
+
+/** \brief Reports the events of every complete token in a slice.
+ ** \param reader The XmlReader
+ ** \param begin The beginning of the slice
+ ** \param end The end of the slice
+ ** \param isFinal Nonzero if no more input follows the slice
+ ** \returns The number of characters consumed, the rest must be passed again with more input.
+ ** \related Xml
+ **/
+size_t private_parse_xmlr(XmlReader* reader, const char* begin, const char* end, const int isFinal)
+{
+	DECLARE_FUNCTION(private_parse_xmlr);
+
+	/* Variable declarations. */
+	char quote;
+	size_t len;
+	const char* ptr;
+	const char* next;
+	const char* text;
+	const XmlHandler* handler;
+
+	/* Checks. */
+	ASSERT_NOT_NULL(reader);
+	ASSERT_NOT_NULL(begin);
+	ASSERT_NOT_NULL(end);
+
+	handler = reader->handler;
+	for (ptr = begin; ptr < end; ptr = next)
+	{
+		unless (*ptr == XML_NODE_BEGIN_SYMBOL) {
+			/* Text until the next tag. */
+			next = memchr(ptr, XML_NODE_BEGIN_SYMBOL, end - ptr);
+			unless (next) {
+				next = end;
+				/* Keep an incomplete entity for the next chunk. */
+				unless (isFinal) {
+					text = memchr(ptr, XML_AMP_SYMBOL, end - ptr);
+					for (; text && memchr(text, ';', end - text); text = memchr(text + 1, XML_AMP_SYMBOL, end - text - 1));
+					if (text)
+						next = text;
+				}
+				if (next == ptr)
+					return ptr - begin;
+			}
+
+			if (reader->tagsSize) {
+				if (handler->text) {
+					text = private_unescape_xmlr(reader, ptr, next - ptr, &len);
+					handler->text(reader->context, text, len);
+				}
+			} else {
+				/* Only spaces may surround the root. */
+				for (text = ptr; text < next && isspace((unsigned char)*text); text++);
+				if (text < next)
+					warning(MSG_REPORT("Skipping Text Outside of the Root"));
+			}
+			continue;
 		}
 
-		if (*ptr == XML_NODE_STOP_SYMBOL) {
-			/* Skip the stop symbol. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
+		/* Every tag needs at least two characters to be recognized. */
+		if (end - ptr < 2)
+			break;
 
-			/* Go back a step. */
-			node = parent;
-			unless (node)
+		if (ptr[1] == XML_META_SYMBOL) {
+			next = private_find_xmlr(ptr, end, "?>");
+			unless (next)
+				break;
+			next += 2;
+			if (handler->meta)
+				handler->meta(reader->context, ptr, next - ptr);
+		} else if (ptr[1] == '!') {
+			if (end - ptr < 4)
 				break;
-			parent = node->parent;
+			next = strncmp(ptr, "<!--", 4) ? memchr(ptr, XML_NODE_END_SYMBOL, end - ptr) : private_find_xmlr(ptr, end, "-->");
+			unless (next)
+				break;
+			next += (*next == XML_NODE_END_SYMBOL) ? 1 : 3;
+		} else if (ptr[1] == XML_NODE_STOP_SYMBOL) {
+			next = memchr(ptr, XML_NODE_END_SYMBOL, end - ptr);
+			unless (next)
+				break;
+			private_endTag_xmlr(reader, ptr + 2, next);
+			next++;
+		} else {
+			/* Find the end of the tag, skipping the quoted values. */
+			quote = '\0';
+			for (next = ptr + 1; next < end; next++) {
+				if (quote) {
+					if (*next == quote)
+						quote = '\0';
+				} else if (*next == XML_QUOTE_SYMBOL || *next == XML_APOSTROPHE_SYMBOL) {
+					quote = *next;
+				} else if (*next == XML_NODE_END_SYMBOL) {
+					break;
+				}
+			}
+			unless (next < end)
+				break;
+			private_startTag_xmlr(reader, ptr + 1, next);
+			next++;
 		}
+	}
 
-		ASSERT_NOT_EMPTY(ptr);
-		errorUnless(*ptr == XML_NODE_END_SYMBOL, MSG_ERROR_SYNTAX("Expected 'XML_NODE_END'"));
+	errorIf(isFinal && ptr < end, MSG_ERROR_SYNTAX("Incomplete Tag"));
+	return ptr - begin;
+}
 
-		/* Skip the end symbol. */
-		ptr++;
-		ASSERT_NOT_EMPTY(ptr);
+/** \brief Reads an Xml string, reporting its events to an XmlHandler.
+ ** \param xmlstr The Xml string
+ ** \param len The length of the Xml string
+ ** \param handler The XmlHandler
+ ** \param context The context passed to every callback
+ ** \related Xml
+ **/
+void parseString_xml(const char* xmlstr, const size_t len, const XmlHandler* handler, void* context)
+{
+	DECLARE_FUNCTION(parseString_xml);
 
-		while (node) {
-			/* Fill the content. */
-			i = 0;
-			while ((*ptr) && *ptr != XML_NODE_BEGIN_SYMBOL)
-				xmlContent[i++] = *(ptr++);
-			xmlContent[i] = '\0';
-			ASSERT_NOT_EMPTY(ptr);
-			/* Append the content string! */
-			private_fromXmlString(node->content[node->nChildren], xmlContent);
-
-			/* Skip the node begin symbol. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
-
-			unless (*ptr == XML_NODE_STOP_SYMBOL)
-				break;
+	/* Variable declaration. */
+	XmlReader rBuffer, *reader = &rBuffer;
 
-			/* Skip the node stop. */
-			ptr++;
-			ASSERT_NOT_EMPTY(ptr);
+	/* Checks. */
+	ASSERT_NOT_NULL(xmlstr);
+	ASSERT_NOT_NULL(handler);
 
-			len = strlen(node->tag);
-			errorUnless(!strncmp(node->tag, ptr, len), MSG_ERROR_SYNTAX("Tag Mismatch"));
+	reader = private_initialize_xmlr(reader, handler, context);
+	private_parse_xmlr(reader, xmlstr, xmlstr + len, 1);
+	private_finalize_xmlr(reader);
+}
 
-			/* Skip the end_tag. */
-			ptr += len;
-			ASSERT_NOT_EMPTY(ptr);
+/** \brief Reads a FILE stream in chunks, reporting its events to an XmlHandler.
+ ** \param stream The stream
+ ** \param handler The XmlHandler
+ ** \param context The context passed to every callback
+ ** \related Xml
+ **
+ ** The memory in use only grows beyond XML_CHUNK_SIZE for a single tag that does NOT fit in it.
+ **/
+void parseStream_xml(FILE* stream, const XmlHandler* handler, void* context)
+{
+	DECLARE_FUNCTION(parseStream_xml);
 
-			/* Skip spaces. */
-			for (; (*ptr) && isspace(*ptr); ptr++);
-			ASSERT_NOT_EMPTY(ptr);
+	/* Variable declarations. */
+	int isFinal;
+	size_t size, capacity, consumed;
+	char* buffer;
+	XmlReader rBuffer, *reader = &rBuffer;
 
-			/* Must encounter an end symbol. */
-			errorUnless(
-				*ptr == XML_NODE_END_SYMBOL,
-				MSG_ERROR_SYNTAX("Expected 'XML_NODE_END'")
-			);
+	/* Checks. */
+	ASSERT_NOT_NULL(stream);
+	ASSERT_NOT_NULL(handler);
+
+	reader = private_initialize_xmlr(reader, handler, context);
+
+	capacity = XML_CHUNK_SIZE;
+	SAFE_MALLOC(buffer, char, capacity);
+	size = 0;
+	do {
+		/* Only a single token longer than the buffer makes it grow. */
+		if (size == capacity) {
+			capacity *= 2;
+			SAFE_REALLOC(buffer, char, capacity);
+		}
 
-			/* Skip the end symbol. */
-			ptr++;
+		size += fread(buffer + size, 1, capacity - size, stream);
+		errorIf(ferror(stream), MSG_ERROR_UNKNOWN);
+		isFinal = feof(stream);
 
-			/* No children. */
-			/* Go back a step. */
-			node = parent;
-			unless (node)
-				break;
-			parent = node->parent;
+		consumed = private_parse_xmlr(reader, buffer, buffer + size, isFinal);
+		memmove(buffer, buffer + consumed, size - consumed);
+		size -= consumed;
+	} until (isFinal);
+
+	free(buffer);
+	private_finalize_xmlr(reader);
+}
 
-			ASSERT_NOT_EMPTY(ptr);
+/** \brief Reads an Xml file, reporting its events to an XmlHandler.
+ ** \param filename The filename
+ ** \param handler The XmlHandler
+ ** \param context The context passed to every callback
+ ** \related Xml
+ **
+ ** The file is memory-mapped, so the slices passed to the callbacks point into the mapping
+ ** and nothing is copied unless it contains an entity. Files that can NOT be mapped are
+ ** read with parseStream_xml instead.
+ **/
+void parseFile_xml(const char* filename, const XmlHandler* handler, void* context)
+{
+	DECLARE_FUNCTION(parseFile_xml);
+
+	/* Variable declarations. */
+	FILE* fp;
+#ifdef _POSIX_MAPPED_FILES
+	int fd;
+	struct stat st;
+	void* map;
+#endif
+
+	/* Checks. */
+	ASSERT_NOT_NULL(filename);
+	ASSERT_NOT_EMPTY(filename);
+	ASSERT_NOT_TOO_LONG(filename, BUFFER_SIZE);
+	ASSERT_NOT_NULL(handler);
+
+#ifdef _POSIX_MAPPED_FILES
+	fd = open(filename, O_RDONLY);
+	ASSERT_NOT_NEGATIVE(fd);
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			close(fd);
+			posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+			parseString_xml(map, st.st_size, handler, context);
+			munmap(map, st.st_size);
+			return;
 		}
+	}
+	close(fd);
+#endif
+
+	SAFE_FOPEN(fp,filename,"r");
+	parseStream_xml(fp, handler, context);
+	fclose(fp);
+}
+
+/** \brief The state of an Xml being built from the events of the Xml reader.
+ **/
+typedef struct XmlBuilderBody {
+	Xml* xml;
+	XmlNode* node;
+} XmlBuilder;
+
+/** \brief Stores the meta node of an Xml.
+ ** \related Xml
+ **/
+void private_meta_xmlb(void* context, const char* meta, const size_t len)
+{
+	DECLARE_FUNCTION(private_meta_xmlb);
+
+	/* Variable declaration. */
+	XmlBuilder* builder = context;
+
+	builder->xml->meta = fromSlice_arena(builder->xml->arena, meta, len);
+	ASSERT_NOT_NULL(builder->xml->meta);
+}
+
+/** \brief Opens a new XmlNode under the innermost open XmlNode.
+ ** \related Xml
+ **/
+void private_startTag_xmlb(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_startTag_xmlb);
+
+	/* Variable declarations. */
+	XmlNode* node;
+	XmlBuilder* builder = context;
+
+	/* Allocate a node from the Arena. */
+	node = initialize_xmln(NULL, builder->xml->arena, builder->node);
+	ASSERT_NOT_NULL(node);
+	unless (builder->xml->root)
+		builder->xml->root = node;
+	builder->xml->nNodes++;
+
+	/* Fill the tag information. */
+	node->tagId = intern_it(builder->xml->tags, tag, len);
+	node->tag = toString_it(builder->xml->tags, node->tagId);
+	ASSERT_XMLNODE(node);
 
-		if (node)
-			parent = node;
+	builder->node = node;
+}
+
+/** \brief Appends an XmlAttribute to the innermost open XmlNode.
+ ** \related Xml
+ **/
+void private_attribute_xmlb(void* context, const char* name, const size_t nameLen, const char* value, const size_t valueLen)
+{
+	DECLARE_FUNCTION(private_attribute_xmlb);
+
+	/* Variable declarations. */
+	XmlAttribute* attribute;
+	XmlNode* node;
+	XmlBuilder* builder = context;
+
+	node = builder->node;
+	ASSERT_XMLNODE(node);
+
+	/* Make room for one more attribute. */
+	if (node->nAttributes == node->attributeCapacity) {
+		SAFE_ARENA_REALLOC(
+			node->attributes,
+			builder->xml->arena,
+			XmlAttribute,
+			node->attributeCapacity,
+			(node->attributeCapacity ? 2 * node->attributeCapacity : XML_INITIAL_ATTRIBUTES)
+		);
+		node->attributeCapacity = node->attributeCapacity ? 2 * node->attributeCapacity : XML_INITIAL_ATTRIBUTES;
 	}
 
-	/* Skip spaces. */
-	for (; (*ptr) && isspace(*ptr); ptr++);
+	attribute = node->attributes + node->nAttributes++;
+	attribute->name = fromSlice_arena(builder->xml->arena, name, nameLen);
+	attribute->value = fromSlice_arena(builder->xml->arena, value, valueLen);
+	ASSERT_XMLATTRIBUTE(attribute);
+}
+
+/** \brief Appends text to the current content of the innermost open XmlNode.
+ ** \related Xml
+ **/
+void private_text_xmlb(void* context, const char* text, const size_t len)
+{
+	DECLARE_FUNCTION(private_text_xmlb);
+
+	/* Variable declarations. */
+	char** content;
+	size_t contentLen;
+	XmlBuilder* builder = context;
+
+	ASSERT_XMLNODE(builder->node);
+	content = builder->node->content + builder->node->nChildren;
+
+	/* The pieces of a content arrive back to back, so the content usually grows in place. */
+	contentLen = *content ? strlen(*content) : 0;
+	SAFE_ARENA_REALLOC(*content, builder->xml->arena, char, (contentLen + 1), (contentLen + len + 1));
+	memcpy(*content + contentLen, text, len);
+	(*content)[contentLen + len] = '\0';
+}
+
+/** \brief Closes the innermost open XmlNode.
+ ** \related Xml
+ **/
+void private_endTag_xmlb(void* context, const char* tag, const size_t len)
+{
+	DECLARE_FUNCTION(private_endTag_xmlb);
+
+	/* Variable declaration. */
+	XmlBuilder* builder = context;
+
+	(void)tag;
+	(void)len;
+
+	ASSERT_XMLNODE(builder->node);
+	builder->node = builder->node->parent;
+}
+
+/** \brief The XmlHandler building an Xml tree.
+ ** \related Xml
+ **/
+const XmlHandler private_builder_xml = {
+	private_meta_xmlb,
+	private_startTag_xmlb,
+	private_attribute_xmlb,
+	private_text_xmlb,
+	private_endTag_xmlb
+};
+
+/** \brief Creates an Xml from an Xml string.
+ ** \param xml The Xml
+ ** \param arena The Arena holding the Xml tree
+ ** \param xmlstr The Xml string
+ ** \returns A pointer to the Xml.
+ ** \memberof Xml
+ **/
+Xml* fromString_xml(Xml* xml, Arena* arena, const char* xmlstr)
+{
+	DECLARE_FUNCTION(fromString_xml);
+
+	/* Variable declaration. */
+	XmlBuilder builder;
+
+	/* Checks. */
+	ASSERT_NOT_NULL(xmlstr);
+	ASSERT_NOT_EMPTY(xmlstr);
+
+	xml = initialize_xml(xml, arena);
+	ASSERT_XML(xml);
+
+	builder.xml = xml;
+	builder.node = NULL;
+	parseString_xml(xmlstr, strlen(xmlstr), &private_builder_xml, &builder);
+	errorUnless(xml->nNodes, MSG_ERROR_SYNTAX("Expected 'XML_NODE_BEGIN'"));
 
-	if (*ptr)
-		warning(MSG_REPORT(ptr));
 	return xml;
 }
 
 /** \brief Creates an Xml from a FILE stream.
  ** \param xml The Xml
- ** \param steram The stream
+ ** \param arena The Arena holding the Xml tree
+ ** \param stream The stream
  ** \returns A pointer to the Xml.
  ** \memberof Xml
+ **
+ ** The stream is read in chunks of XML_CHUNK_SIZE characters.
  **/
-Xml* fromStream_xml(Xml* xml, FILE* stream)
+Xml* fromStream_xml(Xml* xml, Arena* arena, FILE* stream)
 {
 	DECLARE_FUNCTION(fromStream_xml);
 
-	/* Variable declarations. */
-	int check;
-	unsigned long len, size;
-	char buffer[BUFFER_LARGE_SIZE];
+	/* Variable declaration. */
+	XmlBuilder builder;
 
 	/* Check. */
 	ASSERT_NOT_NULL(stream);
 
-	/* Calculate file length. */
-	check = fseek(stream, 0, SEEK_END);
-	ASSERT_ZERO(check);
-
-	len = ftell(stream);
-	ASSERT_FITS_IN_BOUND(len, BUFFER_LARGE_SIZE);
-
-	/* Rewind everything. */
-	check = fseek(stream, 0, SEEK_SET);
-	ASSERT_ZERO(check);
+	xml = initialize_xml(xml, arena);
+	ASSERT_XML(xml);
 
-	/* Read the file. */
-	size = fread(buffer, 1, len, stream);
-	errorUnless(size == len, MSG_ERROR_UNKNOWN);
-	buffer[len] = '\0';
+	builder.xml = xml;
+	builder.node = NULL;
+	parseStream_xml(stream, &private_builder_xml, &builder);
+	errorUnless(xml->nNodes, MSG_ERROR_SYNTAX("Expected 'XML_NODE_BEGIN'"));
 
-	return fromString_xml(xml, buffer);
+	return xml;
 }
 
 /** \brief Creates an Xml from a file.
  ** \param xml The Xml
+ ** \param arena The Arena holding the Xml tree
  ** \param filename The filename
  ** \returns A pointer to the Xml.
  ** \memberof Xml
  **/
-Xml* fromFile_xml(Xml* xml, const char* filename)
+Xml* fromFile_xml(Xml* xml, Arena* arena, const char* filename)
 {
 	DECLARE_FUNCTION(fromFile_xml);
 
 	/* Variable declaration. */
-	FILE* fp;
+	XmlBuilder builder;
 
 	/* Checks. */
 	ASSERT_NOT_NULL(filename);
 	ASSERT_NOT_EMPTY(filename);
 	ASSERT_NOT_TOO_LONG(filename, BUFFER_SIZE);
 
-	SAFE_FOPEN(fp,filename,"r");
-	xml = fromStream_xml(xml, fp);
-	fclose(fp);
+	xml = initialize_xml(xml, arena);
+	ASSERT_XML(xml);
+
+	builder.xml = xml;
+	builder.node = NULL;
+	parseFile_xml(filename, &private_builder_xml, &builder);
+	errorUnless(xml->nNodes, MSG_ERROR_SYNTAX("Expected 'XML_NODE_BEGIN'"));
 
 	return xml;
 }
@@ -696,8 +1156,8 @@ char* toString_xml(char* xmlstr, const Xml* xml)
 	xmlstr = fromPattern(xmlstr, BUFFER_LARGE_SIZE, "%s", xml->meta);
 	ASSERT_NOT_NULL(xmlstr);
 
-	if (xml->tree->size)
-		toString_xmln(xmlstr + strlen(xmlstr), xml->tree->nodes);
+	if (xml->root)
+		toString_xmln(xmlstr + strlen(xmlstr), xml->root);
 
 	return xmlstr;
 }
@@ -0,0 +1,54 @@
+/** \file benchmarkSkip.c
+ ** \brief Measures the self-loop skipping of a length-delimited matcher on a long quoted token.
+ **
+ ** Link with the matcher compileDFA.out --length writes for test/quotedToken.xml,
+ ** built once per vector extension; `make benchmark` builds the scalar, SSE2 and
+ ** AVX2 variants and runs them. The token is BENCHMARK_SKIP_SIZE bytes.
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCHMARK_SKIP_SIZE
+	#define BENCHMARK_SKIP_SIZE (256UL << 20)
+#endif
+#ifndef BENCHMARK_SKIP_RUNS
+	#define BENCHMARK_SKIP_RUNS 8
+#endif
+
+int quotedToken(const unsigned char* buf, size_t len);
+
+int main(void)
+{
+	/* Variable declarations. */
+	unsigned char* buf;
+	clock_t start, stop;
+	double seconds;
+	int i, nAccepted;
+
+	buf = malloc(BENCHMARK_SKIP_SIZE);
+	if (!buf) {
+		fprintf(stderr, "Cannot allocate %luB\n", (unsigned long)BENCHMARK_SKIP_SIZE);
+		return 1;
+	}
+	memset(buf, 'x', BENCHMARK_SKIP_SIZE);
+	buf[0] = '"';
+	buf[BENCHMARK_SKIP_SIZE - 1] = '"';
+
+	nAccepted = 0;
+	start = clock();
+	for (i = 0; i < BENCHMARK_SKIP_RUNS; i++)
+		nAccepted += quotedToken(buf, BENCHMARK_SKIP_SIZE);
+	stop = clock();
+	free(buf);
+
+	if (nAccepted != BENCHMARK_SKIP_RUNS) {
+		fprintf(stderr, "The quoted token was rejected\n");
+		return 1;
+	}
+	seconds = (double)(stop - start) / CLOCKS_PER_SEC;
+	printf("%.1fGB/s\n", seconds > 0 ? (double)BENCHMARK_SKIP_SIZE * BENCHMARK_SKIP_RUNS / seconds / 1e9 : 0.0);
+
+	return 0;
+}
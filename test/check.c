@@ -0,0 +1,274 @@
+/** \file check.c
+ ** \brief Implements the helpers shared by the regression checks.
+ **
+ ** Every check compares two ways of matching on the same automata and inputs
+ ** and exits with 1 on any disagreement. The automata are the shipped
+ ** examples then DFAs compiled from regular expressions, or random automata;
+ ** the inputs are random walks on them, so that they are accepted often
+ ** enough.
+ **/
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "check.h"
+#include "dfa.h"
+#include "match.h"
+#include "nfa.h"
+
+/** \brief The XML examples, relative to the root of the repository.
+ **
+ ** The states of test/deadLabel.xml are named after the dead label of the generated code,
+ ** and test/quotedToken.xml loops on enough bytes for the vector skip loops.
+ **/
+static const char* const examples_chk[] = {
+	"oddOnes/oddOnes.xml",
+	"traditionalRomanNumerals/isRomanNumeral.xml",
+	"test/deadLabel.xml",
+	"test/quotedToken.xml"
+};
+
+#define CHECK_N_EXAMPLES (sizeof(examples_chk) / sizeof(examples_chk[0]))
+
+/** \brief The regular expressions, after the examples.
+ **
+ ** .*ab.* has universal states, and (a|b)*a(a|b){4} needs more states than
+ ** a shuffle vector holds.
+ **/
+static const char* const regexes_chk[CHECK_N_AUTOMATA - CHECK_N_EXAMPLES] = {
+	"\"[^\"]*\"",
+	"(a|b)*abb",
+	".*ab.*",
+	"[0-9]+(\\.[0-9]+)?",
+	"(ab|ba)*|c{2,5}",
+	"[^a]*a[^a]{3}",
+	"(a|b)*a(a|b){4}"
+};
+
+/** \brief The number of comparisons so far.
+ **/
+static unsigned long nComparisons_chk = 0;
+
+/** \brief The number of disagreements so far.
+ **/
+static unsigned long nFailures_chk = 0;
+
+/** \brief Draws a random number.
+ ** \param seed The state of the generator, updated
+ ** \returns A random number below 32768.
+ **/
+unsigned int next_chk(unsigned long* seed)
+{
+	*seed = (*seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+	return (unsigned int)(*seed >> 16) & 0x7FFF;
+}
+
+/** \brief Names one of the automata of the checks in the reports.
+ ** \param i The index of the automaton, CHECK_N_AUTOMATA or more for a random one
+ ** \returns The path of the example, or the regular expression.
+ **/
+const char* name_chk(const unsigned int i)
+{
+	if (i < CHECK_N_EXAMPLES)
+		return examples_chk[i];
+	return i < CHECK_N_AUTOMATA ? regexes_chk[i - CHECK_N_EXAMPLES] : "a random automaton";
+}
+
+/** \brief Gives the regular expression of one of the automata of the checks.
+ ** \param i The index of the automaton, below CHECK_N_AUTOMATA
+ ** \returns The regular expression, NULL for the examples.
+ **/
+const char* regex_chk(const unsigned int i)
+{
+	return i < CHECK_N_EXAMPLES ? NULL : regexes_chk[i - CHECK_N_EXAMPLES];
+}
+
+/** \brief Builds one of the automata of the checks.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param i The index of the automaton, below CHECK_N_AUTOMATA
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ **/
+DeterministicFiniteAutomaton* automaton_chk(DeterministicFiniteAutomaton* dfa, const unsigned int i)
+{
+	/* Variable declaration. */
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+
+	if (i < CHECK_N_EXAMPLES)
+		return fromFile_dfa(dfa, examples_chk[i]);
+
+	nfa = fromRegex_nfa(nfa, regexes_chk[i - CHECK_N_EXAMPLES]);
+	dfa = toDfa_nfa(dfa, nfa);
+	finalize_nfa(nfa);
+	return dfa;
+}
+
+/** \brief Builds a random DeterministicFiniteAutomaton over CHECK_RANDOM_ALPHABET.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param seed The state of the generator, updated
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ **
+ ** It has up to CHECK_RANDOM_STATES states, a third of them accepting, and
+ ** misses about one transition in four, so that some states are unreachable
+ ** and some equivalent.
+ **/
+DeterministicFiniteAutomaton* random_chk(DeterministicFiniteAutomaton* dfa, unsigned long* seed)
+{
+	/* Variable declarations. */
+	DFAStateId i, nStates;
+	const char* c;
+
+	dfa = initialize_dfa(dfa);
+	strcpy(dfa->alphabet, CHECK_RANDOM_ALPHABET);
+	nStates = 1 + next_chk(seed) % CHECK_RANDOM_STATES;
+	for (i = 0; i < nStates; i++)
+		insertState_dfa(dfa, NULL, 0)->isAccept = next_chk(seed) % 3 == 0;
+	for (i = 0; i < nStates; i++)
+		for (c = dfa->alphabet; *c; c++)
+			if (next_chk(seed) % 4)
+				insertTransition_dfa(dfa, i, next_chk(seed) % nStates, *c);
+	dfa->initialStateId = next_chk(seed) % nStates;
+
+	return dfa;
+}
+
+/** \brief Fills a buffer with a random walk on a DeterministicFiniteAutomaton.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param buf The buffer
+ ** \param len The length of the buffer
+ ** \param seed The state of the generator, updated
+ ** \returns The length of the buffer.
+ **
+ ** Most bytes follow one of the transitions of the current state; one in
+ ** sixteen is any byte, NUL included. Once the walk falls off the automaton,
+ ** it starts again from the initial state now and then.
+ **/
+size_t walk_chk(const DeterministicFiniteAutomaton* dfa, char* buf, const size_t len, unsigned long* seed)
+{
+	/* Variable declarations. */
+	size_t i, k, nSinks;
+	unsigned char c;
+	const char* symbol;
+	DFAStateId stateId;
+
+	stateId = dfa->initialStateId;
+	for (i = 0; i < len; i++) {
+		*seed = (*seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+		c = (unsigned char)(*seed >> 16);
+		nSinks = 0;
+		if (stateId != DFA_NO_STATE && ((*seed >> 8) & 15) != 0)
+			for (symbol = dfa->alphabet; *symbol; symbol++)
+				if (dfa->transitions[stateId][(unsigned char)*symbol] != DFA_NO_STATE)
+					nSinks++;
+		if (nSinks) {
+			k = (*seed >> 16) % nSinks;
+			for (symbol = dfa->alphabet; dfa->transitions[stateId][(unsigned char)*symbol] == DFA_NO_STATE || k--; symbol++);
+			c = (unsigned char)*symbol;
+		}
+		if (stateId != DFA_NO_STATE)
+			stateId = dfa->transitions[stateId][c];
+		if (stateId == DFA_NO_STATE && ((*seed >> 12) & 3) == 0)
+			stateId = dfa->initialStateId;
+		buf[i] = (char)c;
+	}
+
+	return len;
+}
+
+/** \brief Follows the transitions of a DeterministicFiniteAutomaton, the reference of the checks.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param buf The input
+ ** \param len The length of the input
+ ** \returns 1 if the input is accepted, 0 otherwise.
+ **/
+int accepts_chk(const DeterministicFiniteAutomaton* dfa, const char* buf, const size_t len)
+{
+	/* Variable declarations. */
+	size_t i;
+	DFAStateId stateId;
+
+	stateId = dfa->initialStateId;
+	for (i = 0; i < len && stateId != DFA_NO_STATE; i++)
+		stateId = dfa->transitions[stateId][(unsigned char)buf[i]];
+
+	return stateId != DFA_NO_STATE && dfa->states->array[stateId].isAccept;
+}
+
+/** \brief Finds the longest prefix that a DeterministicFiniteAutomaton accepts.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param buf The input
+ ** \param len The length of the input
+ ** \returns The length of the prefix, DFA_NO_MATCH if no prefix is accepted.
+ **/
+size_t longestPrefix_chk(const DeterministicFiniteAutomaton* dfa, const char* buf, const size_t len)
+{
+	/* Variable declarations. */
+	size_t i, longest;
+	DFAStateId stateId;
+
+	stateId = dfa->initialStateId;
+	longest = dfa->states->array[stateId].isAccept ? 0 : DFA_NO_MATCH;
+	for (i = 0; i < len && stateId != DFA_NO_STATE; ) {
+		stateId = dfa->transitions[stateId][(unsigned char)buf[i++]];
+		if (stateId != DFA_NO_STATE && dfa->states->array[stateId].isAccept)
+			longest = i;
+	}
+
+	return longest;
+}
+
+/** \brief Checks whether a step stops the process with an error, running it in a child process.
+ ** \param run The step
+ ** \param argument The argument of the step
+ ** \returns 1 if the child exits with a non-zero status or a signal, 0 if it returns.
+ **
+ ** The errors of the library exit the process, so that the check can go on
+ ** only from the parent. The child writes its error to /dev/null.
+ **/
+int isFatal_chk(void (*run)(const char*), const char* argument)
+{
+	/* Variable declarations. */
+	int status;
+	pid_t pid;
+
+	fflush(NULL);
+	if ((pid = fork()) < 0)
+		return 0;
+	if (!pid) {
+		if (!freopen("/dev/null", "w", stderr))
+			_exit(0);
+		run(argument);
+		_exit(0);
+	}
+	if (waitpid(pid, &status, 0) != pid)
+		return 0;
+
+	return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
+
+/** \brief Counts a comparison and reports it on the standard error if the results disagree.
+ ** \param expected The reference result
+ ** \param actual The result checked
+ ** \param what What is checked
+ ** \param on What it is checked on, such as the name of an automaton
+ ** \param len The length of the input
+ ** \param parameter A parameter of the check, such as a number of threads
+ **/
+void expect_chk(const int expected, const int actual, const char* what, const char* on, const size_t len, const unsigned int parameter)
+{
+	nComparisons_chk++;
+	if (!expected == !actual)
+		return;
+	nFailures_chk++;
+	fprintf(stderr, "FAILED %s on %s, length %lu, parameter %u: expected %d, got %d\n", what, on, (unsigned long)len, parameter, expected, actual);
+}
+
+/** \brief Reports the counts of a check on the standard error.
+ ** \param name The name of the check
+ ** \returns The exit status, 0 if every comparison agreed, 1 otherwise.
+ **/
+int report_chk(const char* name)
+{
+	fprintf(stderr, "%s: %lu comparisons, %lu failures\n", name, nComparisons_chk, nFailures_chk);
+	return nFailures_chk ? 1 : 0;
+}
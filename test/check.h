@@ -0,0 +1,33 @@
+/** \file check.h
+ ** \brief Declares the helpers shared by the regression checks.
+ **/
+#ifndef CHECK_H
+	#define CHECK_H
+	#include <stddef.h>
+	#include "dfa.h"
+
+	#ifndef CHECK_N_AUTOMATA
+		#define CHECK_N_AUTOMATA 11
+	#endif
+	#ifndef CHECK_MAX_INPUT
+		#define CHECK_MAX_INPUT 70000
+	#endif
+	#ifndef CHECK_RANDOM_ALPHABET
+		#define CHECK_RANDOM_ALPHABET "abc"
+	#endif
+	#ifndef CHECK_RANDOM_STATES
+		#define CHECK_RANDOM_STATES 12
+	#endif
+
+	unsigned int next_chk(unsigned long*);
+	const char* name_chk(const unsigned int);
+	const char* regex_chk(const unsigned int);
+	DeterministicFiniteAutomaton* automaton_chk(DeterministicFiniteAutomaton*, const unsigned int);
+	DeterministicFiniteAutomaton* random_chk(DeterministicFiniteAutomaton*, unsigned long*);
+	size_t walk_chk(const DeterministicFiniteAutomaton*, char*, const size_t, unsigned long*);
+	int accepts_chk(const DeterministicFiniteAutomaton*, const char*, const size_t);
+	size_t longestPrefix_chk(const DeterministicFiniteAutomaton*, const char*, const size_t);
+	int isFatal_chk(void (*)(const char*), const char*);
+	void expect_chk(const int, const int, const char*, const char*, const size_t, const unsigned int);
+	int report_chk(const char*);
+#endif
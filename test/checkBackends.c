@@ -0,0 +1,159 @@
+/** \file checkBackends.c
+ ** \brief Checks the C code emitted by every backend against the transitions it is generated from.
+ **
+ ** Each automaton is written with toFile_dfa(), or toHppFile_dfa() for the
+ ** C++ header, compiled together with test/runBackend.c under -Wall -Wextra
+ ** -Werror, and run on random walks and on their longest accepted prefixes;
+ ** every answer must agree with accepts_chk().
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "match.h"
+
+#ifndef CHECK_CC
+	#define CHECK_CC "cc"
+#endif
+#ifndef CHECK_CXX
+	#define CHECK_CXX "c++"
+#endif
+#ifndef CHECK_N_TRIALS
+	#define CHECK_N_TRIALS 8
+#endif
+#define CHECK_GENERATED "bin/checkGenerated.c"
+#define CHECK_GENERATED_HPP "bin/checkGenerated.hpp"
+#define CHECK_INPUTS "bin/checkBackends.in"
+#define CHECK_RESULTS "bin/checkBackends.res"
+#define CHECK_RUNNER "bin/checkBackends.run"
+
+/** \brief One way of emitting and compiling a matcher.
+ **/
+typedef struct BackendVariantBody {
+	const char* name;
+	DFABackend backend;
+	DFASignature signature;
+	const char* flags;
+	int isHpp;
+} BackendVariant;
+
+/** \brief The variants checked on every automaton.
+ **/
+static const BackendVariant variants_chkb[] = {
+	{"goto", DFA_BACKEND_GOTO, DFA_SIGNATURE_STRING, "-ansi -pedantic-errors", 0},
+	{"table", DFA_BACKEND_TABLE, DFA_SIGNATURE_STRING, "-ansi -pedantic-errors", 0},
+	{"goto --length", DFA_BACKEND_GOTO, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -DCHECK_LENGTH", 0},
+	{"table --length", DFA_BACKEND_TABLE, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -DCHECK_LENGTH", 0},
+	{"computed-goto", DFA_BACKEND_COMPUTED_GOTO, DFA_SIGNATURE_STRING, "-ansi -pedantic-errors", 0},
+	{"computed-goto --length", DFA_BACKEND_COMPUTED_GOTO, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -DCHECK_LENGTH", 0},
+	{"computed-goto gnu99", DFA_BACKEND_COMPUTED_GOTO, DFA_SIGNATURE_STRING, "-std=gnu99", 0},
+	{"computed-goto gnu99 --length", DFA_BACKEND_COMPUTED_GOTO, DFA_SIGNATURE_BUFFER, "-std=gnu99 -DCHECK_LENGTH", 0},
+	{"goto --length scalar", DFA_BACKEND_GOTO, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -U__SSE2__ -DCHECK_LENGTH", 0},
+	{"goto --length avx2", DFA_BACKEND_GOTO, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -mavx2 -DCHECK_LENGTH", 0},
+	{"computed-goto gnu99 --length avx2", DFA_BACKEND_COMPUTED_GOTO, DFA_SIGNATURE_BUFFER, "-std=gnu99 -mavx2 -DCHECK_LENGTH", 0},
+	{"--batch", DFA_BACKEND_TABLE, DFA_SIGNATURE_BATCH, "-ansi -pedantic-errors -DCHECK_BATCH", 0},
+	{"goto --batch", DFA_BACKEND_GOTO, DFA_SIGNATURE_BATCH, "-ansi -pedantic-errors -DCHECK_BATCH", 0},
+	{"shuffle", DFA_BACKEND_SHUFFLE, DFA_SIGNATURE_STRING, "-ansi -pedantic-errors -mssse3", 0},
+	{"shuffle --length", DFA_BACKEND_SHUFFLE, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -mssse3 -DCHECK_LENGTH", 0},
+	{"shuffle --length sse2", DFA_BACKEND_SHUFFLE, DFA_SIGNATURE_BUFFER, "-ansi -pedantic-errors -DCHECK_LENGTH", 0},
+	{"shuffle --batch", DFA_BACKEND_SHUFFLE, DFA_SIGNATURE_BATCH, "-ansi -pedantic-errors -mssse3 -DCHECK_BATCH", 0},
+	{".hpp", DFA_BACKEND_TABLE, DFA_SIGNATURE_STRING, "-x c++ -std=c++14 -pedantic-errors -DCHECK_HPP", 1},
+	{".hpp with a length", DFA_BACKEND_TABLE, DFA_SIGNATURE_BUFFER, "-x c++ -std=c++14 -pedantic-errors -DCHECK_HPP -DCHECK_LENGTH", 1}
+};
+
+/** \brief The lengths of the inputs, each walked CHECK_N_TRIALS times.
+ **/
+static const size_t lens_chkb[] = {0, 1, 2, 3, 5, 8, 13, 64, 1000, 5000};
+
+#define CHECK_N_VARIANTS (sizeof(variants_chkb) / sizeof(variants_chkb[0]))
+#define CHECK_N_LENS (sizeof(lens_chkb) / sizeof(lens_chkb[0]))
+
+/** \brief Writes the walks in hexadecimal, each on a line followed by its longest accepted prefix.
+ ** \param filename The filename
+ ** \param buf The walks, back to back
+ ** \param prefixes The lengths of their longest accepted prefixes
+ ** \returns 1 on success, 0 otherwise.
+ **/
+static int private_write_chkb(const char* filename, const char* buf, const size_t* prefixes)
+{
+	/* Variable declarations. */
+	size_t i, j, k;
+	FILE* fp;
+
+	if (!(fp = fopen(filename, "w")))
+		return 0;
+	for (i = 0; i < CHECK_N_LENS * CHECK_N_TRIALS; buf += lens_chkb[i++ / CHECK_N_TRIALS]) {
+		for (k = 0; k < 2; k++) {
+			for (j = 0; j < (k ? prefixes[i] : lens_chkb[i / CHECK_N_TRIALS]); j++)
+				fprintf(fp, "%02x", (unsigned char)buf[j]);
+			fputc('\n', fp);
+		}
+	}
+
+	return !fclose(fp);
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	static char command[1000];
+	unsigned int i, k, v;
+	size_t j, size, len;
+	size_t* prefixes;
+	unsigned long seed;
+	int actual, expected;
+	char *buf, *input;
+	const char* end;
+	FILE* fp;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+
+	start_logging();
+	for (size = 0, j = 0; j < CHECK_N_LENS; j++)
+		size += lens_chkb[j] * CHECK_N_TRIALS;
+	buf = malloc(size + 1);
+	prefixes = malloc(CHECK_N_LENS * CHECK_N_TRIALS * sizeof(size_t));
+	seed = 1;
+	for (i = 0; i < CHECK_N_AUTOMATA; i++) {
+		dfa = automaton_chk(dfa, i);
+		for (input = buf, j = 0; j < CHECK_N_LENS * CHECK_N_TRIALS; j++, input += len) {
+			len = walk_chk(dfa, input, lens_chkb[j / CHECK_N_TRIALS], &seed);
+			prefixes[j] = longestPrefix_chk(dfa, input, len);
+			if (prefixes[j] == DFA_NO_MATCH)
+				prefixes[j] = 0;
+		}
+		expect_chk(1, private_write_chkb(CHECK_INPUTS, buf, prefixes), "writing the inputs", name_chk(i), 0, 0);
+
+		for (v = 0; v < CHECK_N_VARIANTS; v++) {
+			if (variants_chkb[v].isHpp)
+				toHppFile_dfa(dfa, CHECK_GENERATED_HPP);
+			else
+				toFile_dfa(dfa, CHECK_GENERATED, variants_chkb[v].backend, variants_chkb[v].signature);
+			sprintf(command, "%s %s -Wall -Wextra -Werror -Ibin -DCHECK_MAX_INPUT=%lu -DCHECK_FUNCTION=%s test/runBackend.c -o " CHECK_RUNNER, variants_chkb[v].isHpp ? CHECK_CXX : CHECK_CC, variants_chkb[v].flags, (unsigned long)lens_chkb[CHECK_N_LENS - 1], dfa->name);
+			actual = system(command);
+			expect_chk(0, actual, "compiling", name_chk(i), 0, v);
+			if (actual || system(CHECK_RUNNER " < " CHECK_INPUTS " > " CHECK_RESULTS) || !(fp = fopen(CHECK_RESULTS, "r")))
+				continue;
+
+			/* The string signature stops at the first NUL. */
+			for (input = buf, j = 0; j < CHECK_N_LENS * CHECK_N_TRIALS; input += lens_chkb[j++ / CHECK_N_TRIALS]) {
+				for (k = 0; k < 2; k++) {
+					len = k ? prefixes[j] : lens_chkb[j / CHECK_N_TRIALS];
+					end = variants_chkb[v].signature == DFA_SIGNATURE_STRING ? memchr(input, '\0', len) : NULL;
+					expected = accepts_chk(dfa, input, end ? (size_t)(end - input) : len);
+					if (fscanf(fp, "%d", &actual) != 1)
+						actual = !expected;
+					expect_chk(expected, actual, variants_chkb[v].name, name_chk(i), len, v);
+				}
+			}
+			fclose(fp);
+		}
+		finalize_dfa(dfa);
+	}
+	free(prefixes);
+	free(buf);
+	stop_logging();
+
+	return report_chk("checkBackends");
+}
@@ -0,0 +1,174 @@
+/** \file checkEquivalence.c
+ ** \brief Checks isEquivalent_dfa() and isIncluded_dfa() and their counterexamples.
+ **
+ ** Every pair of the shipped automata and of random automata is compared
+ ** with a breadth-first search over the pairs of states, on every byte, that
+ ** finds the length of a shortest string telling them apart. The verdicts
+ ** must agree with it, and a counterexample must be that long and be
+ ** accepted by the side that it is meant for only. An automaton must also be
+ ** equivalent to its minimal DFA and to the complement of its complement, and
+ ** be included in its union with any other.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+
+#ifndef CHECK_N_RANDOM
+	#define CHECK_N_RANDOM 12
+#endif
+#define CHECK_N_OPERANDS (CHECK_N_AUTOMATA + CHECK_N_RANDOM)
+#define CHECK_NO_STRING (-1L)
+
+/** \brief Numbers a state of an operand from 1, leaving 0 to the dead state.
+ **/
+#define CHECK_ID(stateId) ((stateId) == DFA_NO_STATE ? 0 : (unsigned long)(stateId) + 1)
+
+/** \brief Tells whether a state accepts, the dead state included.
+ **/
+#define CHECK_ACCEPTS(dfa, stateId) ((stateId) != DFA_NO_STATE && (dfa)->states->array[stateId].isAccept)
+
+/** \brief Finds the length of a shortest string that tells two DeterministicFiniteAutomata apart.
+ ** \param left The left DeterministicFiniteAutomaton
+ ** \param right The right DeterministicFiniteAutomaton
+ ** \param isInclusion 1 for a string left accepts and right rejects, 0 for one that only one of them accepts
+ ** \returns The length, CHECK_NO_STRING if there is none.
+ **/
+static long private_shortest_chke(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, const int isInclusion)
+{
+	/* Variable declarations. */
+	unsigned long nPairs, head, tail, id;
+	unsigned int b;
+	int isLeft, isRight;
+	long shortest;
+	DFAStateId *lefts, *rights, p, q;
+	long* depths;
+
+	nPairs = (left->states->nStates + 1UL) * (right->states->nStates + 1UL);
+	lefts = malloc(nPairs * sizeof(DFAStateId));
+	rights = malloc(nPairs * sizeof(DFAStateId));
+	depths = malloc(nPairs * sizeof(long));
+	for (id = 0; id < nPairs; id++)
+		depths[id] = CHECK_NO_STRING;
+
+	shortest = CHECK_NO_STRING;
+	lefts[0] = left->initialStateId;
+	rights[0] = right->initialStateId;
+	depths[CHECK_ID(lefts[0]) * (right->states->nStates + 1UL) + CHECK_ID(rights[0])] = 0;
+	for (head = 0, tail = 1; head < tail; head++) {
+		p = lefts[head];
+		q = rights[head];
+		id = CHECK_ID(p) * (right->states->nStates + 1UL) + CHECK_ID(q);
+		isLeft = CHECK_ACCEPTS(left, p);
+		isRight = CHECK_ACCEPTS(right, q);
+		if (isInclusion ? isLeft && !isRight : isLeft != isRight) {
+			shortest = depths[id];
+			break;
+		}
+		for (b = 1; b < DFA_MAX_SYMBOLS; b++) {
+			lefts[tail] = p == DFA_NO_STATE ? DFA_NO_STATE : left->transitions[p][b];
+			rights[tail] = q == DFA_NO_STATE ? DFA_NO_STATE : right->transitions[q][b];
+			if (depths[CHECK_ID(lefts[tail]) * (right->states->nStates + 1UL) + CHECK_ID(rights[tail])] == CHECK_NO_STRING) {
+				depths[CHECK_ID(lefts[tail]) * (right->states->nStates + 1UL) + CHECK_ID(rights[tail])] = depths[id] + 1;
+				tail++;
+			}
+		}
+	}
+	free(depths);
+	free(rights);
+	free(lefts);
+
+	return shortest;
+}
+
+/** \brief Checks a verdict and its counterexample against private_shortest_chke().
+ ** \param left The left DeterministicFiniteAutomaton
+ ** \param right The right DeterministicFiniteAutomaton
+ ** \param isInclusion 1 to check isIncluded_dfa(), 0 to check isEquivalent_dfa()
+ ** \param name The name of the left DeterministicFiniteAutomaton
+ ** \param parameter The index of the right DeterministicFiniteAutomaton
+ **/
+static void private_check_chke(const DeterministicFiniteAutomaton* left, const DeterministicFiniteAutomaton* right, const int isInclusion, const char* name, const unsigned int parameter)
+{
+	/* Variable declarations. */
+	const char* what;
+	char* counterexample;
+	int isHolding, isLeft, isRight;
+	long shortest;
+	size_t len;
+
+	what = isInclusion ? "isIncluded_dfa" : "isEquivalent_dfa";
+	shortest = private_shortest_chke(left, right, isInclusion);
+	isHolding = isInclusion ? isIncluded_dfa(left, right, &counterexample) : isEquivalent_dfa(left, right, &counterexample);
+	expect_chk(shortest == CHECK_NO_STRING, isHolding, what, name, 0, parameter);
+	expect_chk(isHolding, counterexample == NULL, what, name, 0, parameter);
+	if (counterexample) {
+		len = strlen(counterexample);
+		isLeft = accepts_chk(left, counterexample, len);
+		isRight = accepts_chk(right, counterexample, len);
+		expect_chk(1, isInclusion ? isLeft && !isRight : isLeft != isRight, "telling them apart", name, len, parameter);
+		expect_chk((int)shortest, (int)len, "a shortest counterexample", name, len, parameter);
+		free(counterexample);
+	}
+	isHolding = isInclusion ? isIncluded_dfa(left, right, NULL) : isEquivalent_dfa(left, right, NULL);
+	expect_chk(shortest == CHECK_NO_STRING, isHolding, what, name, 0, parameter);
+}
+
+/** \brief Builds an operand, the same one for the same index.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param i The index, below CHECK_N_AUTOMATA for the shipped automata
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ **/
+static DeterministicFiniteAutomaton* private_operand_chke(DeterministicFiniteAutomaton* dfa, const unsigned int i)
+{
+	/* Variable declaration. */
+	unsigned long seed;
+
+	if (i < CHECK_N_AUTOMATA)
+		return automaton_chk(dfa, i);
+	seed = i;
+
+	return random_chk(dfa, &seed);
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	unsigned int i, j;
+	DeterministicFiniteAutomaton operands[CHECK_N_OPERANDS];
+	DeterministicFiniteAutomaton mBuffer, *minimal = &mBuffer;
+	DeterministicFiniteAutomaton tBuffer, *twice = &tBuffer;
+	DeterministicFiniteAutomaton uBuffer, *both = &uBuffer;
+
+	start_logging();
+	for (i = 0; i < CHECK_N_OPERANDS; i++)
+		private_operand_chke(operands + i, i);
+
+	for (i = 0; i < CHECK_N_OPERANDS; i++) {
+		for (j = 0; j < CHECK_N_OPERANDS; j++) {
+			private_check_chke(operands + i, operands + j, 0, name_chk(i), j);
+			private_check_chke(operands + i, operands + j, 1, name_chk(i), j);
+
+			both = product_dfa(both, operands + i, operands + j, DFA_OPERATION_UNION);
+			expect_chk(1, isIncluded_dfa(operands + i, both, NULL), "isIncluded_dfa in a union", name_chk(i), 0, j);
+			finalize_dfa(both);
+		}
+
+		minimal = minimize_dfa(private_operand_chke(minimal, i));
+		expect_chk(1, isEquivalent_dfa(operands + i, minimal, NULL), "isEquivalent_dfa to the minimal DFA", name_chk(i), 0, i);
+		twice = complement_dfa(complement_dfa(private_operand_chke(twice, i)));
+		private_check_chke(operands + i, twice, 0, name_chk(i), i);
+		private_check_chke(twice, operands + i, 1, name_chk(i), i);
+		finalize_dfa(twice);
+		twice = complement_dfa(private_operand_chke(twice, i));
+		private_check_chke(operands + i, twice, 0, name_chk(i), i);
+		finalize_dfa(twice);
+		finalize_dfa(minimal);
+	}
+	for (i = 0; i < CHECK_N_OPERANDS; i++)
+		finalize_dfa(operands + i);
+	stop_logging();
+
+	return report_chk("checkEquivalence");
+}
@@ -0,0 +1,30 @@
+/** \file checkHpp.cpp
+ ** \brief Checks that the matchers of the C++ headers fold into constant expressions.
+ **
+ ** Compiled by `make check` with -std=c++14 -fsyntax-only against the headers
+ ** compileDFA writes for the examples; a matcher that is not constexpr, or
+ ** answers wrongly, fails the build.
+ **/
+#include "isRomanNumeral.hpp"
+#include "oddOnes.hpp"
+
+static_assert(isRomanNumeral("MCMXCIV"), "MCMXCIV is a roman numeral");
+static_assert(isRomanNumeral("MMMDCCCLXXXVIII"), "MMMDCCCLXXXVIII is a roman numeral");
+static_assert(!isRomanNumeral("IIII"), "IIII is not a traditional roman numeral");
+static_assert(!isRomanNumeral("MMMM"), "MMMM is not a traditional roman numeral");
+static_assert(!isRomanNumeral("XLX"), "XLX is not a roman numeral");
+static_assert(!isRomanNumeral(""), "the empty string is not a roman numeral");
+static_assert(!isRomanNumeral(nullptr), "a null string is not a roman numeral");
+
+/* NUL ends a string but is an ordinary byte of a buffer. */
+static_assert(isRomanNumeral("XI\0I"), "a string stops at the first NUL");
+static_assert(!isRomanNumeral("XI\0I", 4), "NUL is outside the alphabet of a buffer");
+static_assert(isRomanNumeral("XIV", 2), "a buffer stops at its length");
+
+static_assert(oddOnes("1"), "one 1 is odd");
+static_assert(!oddOnes("11"), "two 1s are even");
+static_assert(oddOnes("111", 3), "three 1s are odd");
+static_assert(!oddOnes("1x1", 3), "x is outside the alphabet");
+
+/* The state type is the narrowest that holds every row. */
+static_assert(sizeof(oddOnes_dfa::string::state) == 1, "oddOnes needs one byte per state");
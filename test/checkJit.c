@@ -0,0 +1,63 @@
+/** \file checkJit.c
+ ** \brief Checks match_dfaj() against the transitions of the automata.
+ **
+ ** On x86-64 the DFAJit runs machine code written in process, so a wrong
+ ** encoding or displacement shows up here as a crash or a disagreement.
+ ** Every automaton is compiled both as built and minimized, which changes
+ ** the layout of the code but not the language. Elsewhere it checks the
+ ** fallback DFAMatcher.
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "dfa.h"
+#include "jit.h"
+#include "logging.h"
+#include "match.h"
+#include "unless.h"
+
+#ifndef CHECK_N_RANDOM
+	#define CHECK_N_RANDOM 20
+#endif
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 4, 5, 8, 13, 64, 1000, CHECK_MAX_INPUT};
+	unsigned int i, j, t, pass;
+	unsigned long seed, randomSeed;
+	size_t longest;
+	char* buf;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	DFAJit jBuffer, *jit = &jBuffer;
+
+	start_logging();
+	buf = malloc(CHECK_MAX_INPUT);
+	seed = 1;
+	randomSeed = 3;
+	for (i = 0; i < CHECK_N_AUTOMATA + CHECK_N_RANDOM; i++) {
+		dfa = i < CHECK_N_AUTOMATA ? automaton_chk(dfa, i) : random_chk(dfa, &randomSeed);
+		for (pass = 0; pass < 2; pass++) {
+			if (pass)
+				dfa = minimize_dfa(dfa);
+			jit = initialize_dfaj(jit, dfa);
+			unless (jit->function)
+				fprintf(stderr, "checkJit: %s runs on the fallback DFAMatcher\n", name_chk(i));
+			for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+				for (t = 0; t < 8; t++) {
+					walk_chk(dfa, buf, lens[j], &seed);
+					longest = longestPrefix_chk(dfa, buf, lens[j]);
+					expect_chk(accepts_chk(dfa, buf, lens[j]), match_dfaj(jit, buf, lens[j]), "match_dfaj", name_chk(i), lens[j], pass);
+					if (longest != DFA_NO_MATCH)
+						expect_chk(1, match_dfaj(jit, buf, longest), "match_dfaj on the longest prefix", name_chk(i), longest, pass);
+				}
+			}
+			finalize_dfaj(jit);
+		}
+		finalize_dfa(dfa);
+	}
+	free(buf);
+	stop_logging();
+
+	return report_chk("checkJit");
+}
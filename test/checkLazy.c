@@ -0,0 +1,68 @@
+/** \file checkLazy.c
+ ** \brief Checks match_ldfa() against the DFA of toDfa_nfa() on the compiled regexes.
+ **
+ ** Every NFA runs as a LazyDFA twice: with the default budget, and with a
+ ** budget of 1 byte that leaves room for LAZY_DFA_MIN_STATES states only,
+ ** so that the cache is flushed over and over while matching. The NFA of
+ ** test/epsilonNfa.xml adds epsilon loops to the regexes.
+ **/
+#include <stdlib.h>
+#include "check.h"
+#include "dfa.h"
+#include "lazy.h"
+#include "logging.h"
+#include "nfa.h"
+#include "unless.h"
+
+#define CHECK_NFA "test/epsilonNfa.xml"
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 5, 8, 13, 64, 1000, CHECK_MAX_INPUT};
+	static const size_t budgets[] = {0, 1};
+	unsigned int i, j, k, t;
+	unsigned long seed, nFlushes;
+	const char* name;
+	char* buf;
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	LazyDFA lBuffer, *lazy = &lBuffer;
+
+	start_logging();
+	buf = malloc(CHECK_MAX_INPUT);
+	seed = 1;
+	nFlushes = 0;
+	for (i = 0; i <= CHECK_N_AUTOMATA; i++) {
+		if (i == CHECK_N_AUTOMATA) {
+			name = CHECK_NFA;
+			nfa = fromFile_nfa(nfa, name);
+		} else {
+			unless (regex_chk(i))
+				continue;
+			name = regex_chk(i);
+			nfa = fromRegex_nfa(nfa, name);
+		}
+		dfa = toDfa_nfa(dfa, nfa);
+		for (k = 0; k < sizeof(budgets) / sizeof(budgets[0]); k++) {
+			lazy = initialize_ldfa(lazy, nfa, budgets[k]);
+			for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+				for (t = 0; t < 8; t++) {
+					walk_chk(dfa, buf, lens[j], &seed);
+					expect_chk(accepts_chk(dfa, buf, lens[j]), match_ldfa(lazy, buf, lens[j]), "match_ldfa", name, lens[j], (unsigned int)budgets[k]);
+				}
+			}
+			if (budgets[k])
+				nFlushes += lazy->nFlushes;
+			finalize_ldfa(lazy);
+		}
+		finalize_dfa(dfa);
+		finalize_nfa(nfa);
+	}
+	free(buf);
+	stop_logging();
+
+	/* A check that never flushes does not check the flushes. */
+	expect_chk(1, nFlushes > 0, "cache flushes", "the regexes", 0, 1);
+	return report_chk("checkLazy");
+}
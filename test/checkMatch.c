@@ -0,0 +1,67 @@
+/** \file checkMatch.c
+ ** \brief Checks match_dfam(), longestPrefix_dfam() and matchBatch_dfam() against the transitions of the automata.
+ **
+ ** Every random walk is also matched up to its longest accepted prefix, so
+ ** that the byte ending a run matters. The DFAMatcher skips the self-loops
+ ** of test/quotedToken.xml with vector range tests, which the walks enter
+ ** and leave at every offset. The walks of every length are also matched
+ ** as one batch, mixed with walks of other lengths so that the lanes of
+ ** matchBatch_dfam() finish at different times and get refilled.
+ **/
+#include <stdlib.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "match.h"
+
+#define CHECK_N_TRIALS 16
+#define CHECK_N_LENS (sizeof(lens) / sizeof(lens[0]))
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 5, 8, 13, 15, 16, 17, 31, 32, 33, 64, 1000, CHECK_MAX_INPUT};
+	unsigned int i, j, t;
+	unsigned long seed;
+	size_t longest;
+	size_t batchLens[CHECK_N_TRIALS];
+	const char* batch[CHECK_N_TRIALS];
+	unsigned char results[CHECK_N_TRIALS];
+	char *buf, *input;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	DFAMatcher mBuffer, *matcher = &mBuffer;
+
+	start_logging();
+	buf = malloc(CHECK_N_TRIALS * CHECK_MAX_INPUT);
+	seed = 1;
+	for (i = 0; i < CHECK_N_AUTOMATA; i++) {
+		dfa = automaton_chk(dfa, i);
+		matcher = initialize_dfam(matcher, dfa);
+		for (j = 0; j < CHECK_N_LENS; j++) {
+			for (t = 0; t < CHECK_N_TRIALS; t++) {
+				input = buf + t * CHECK_MAX_INPUT;
+				walk_chk(dfa, input, lens[j], &seed);
+				longest = longestPrefix_chk(dfa, input, lens[j]);
+				expect_chk(accepts_chk(dfa, input, lens[j]), match_dfam(matcher, input, lens[j]), "match_dfam", name_chk(i), lens[j], t);
+				expect_chk(1, longestPrefix_dfam(matcher, input, lens[j]) == longest, "longestPrefix_dfam", name_chk(i), lens[j], t);
+				if (longest != DFA_NO_MATCH)
+					expect_chk(1, match_dfam(matcher, input, longest), "match_dfam on the longest prefix", name_chk(i), longest, t);
+
+				/* Every other lane gets a prefix of another length. */
+				batch[t] = input;
+				batchLens[t] = t % 2 ? lens[(j + t) % CHECK_N_LENS] : lens[j];
+				if (batchLens[t] > lens[j])
+					batchLens[t] = lens[j];
+			}
+			matchBatch_dfam(matcher, batch, batchLens, CHECK_N_TRIALS, results);
+			for (t = 0; t < CHECK_N_TRIALS; t++)
+				expect_chk(accepts_chk(dfa, batch[t], batchLens[t]), results[t], "matchBatch_dfam", name_chk(i), batchLens[t], t);
+		}
+		finalize_dfam(matcher);
+		finalize_dfa(dfa);
+	}
+	free(buf);
+	stop_logging();
+
+	return report_chk("checkMatch");
+}
@@ -0,0 +1,87 @@
+/** \file checkMinimize.c
+ ** \brief Checks minimize_dfa() on the shipped examples and random automata.
+ **
+ ** The minimal automaton must accept the same random walks as the one it
+ ** comes from and be equivalent to it by isEquivalent_dfa(), and minimizing
+ ** it again must leave it as it is.
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+
+#ifndef CHECK_N_RANDOM
+	#define CHECK_N_RANDOM 500
+#endif
+
+/** \brief Tells whether two DeterministicFiniteAutomata have the same states and transitions.
+ ** \param a A DeterministicFiniteAutomaton
+ ** \param b A DeterministicFiniteAutomaton
+ ** \returns 1 if they are the same, 0 otherwise.
+ **/
+static int private_isSame_chkm(const DeterministicFiniteAutomaton* a, const DeterministicFiniteAutomaton* b)
+{
+	/* Variable declarations. */
+	DFAStateId i;
+	unsigned int c;
+
+	if (a->states->nStates != b->states->nStates || a->initialStateId != b->initialStateId)
+		return 0;
+	for (i = 0; i < a->states->nStates; i++) {
+		if (a->states->array[i].isAccept != b->states->array[i].isAccept)
+			return 0;
+		for (c = 0; c < DFA_MAX_SYMBOLS; c++)
+			if (a->transitions[i][c] != b->transitions[i][c])
+				return 0;
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 5, 8, 13, 64, 1000};
+	unsigned int i, j, t;
+	unsigned long seed, randomSeed, walkSeed;
+	char *buf, *counterexample;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	DeterministicFiniteAutomaton mBuffer, *minimal = &mBuffer;
+	DeterministicFiniteAutomaton tBuffer, *twice = &tBuffer;
+
+	start_logging();
+	buf = malloc(lens[sizeof(lens) / sizeof(lens[0]) - 1]);
+	randomSeed = walkSeed = 1;
+	for (i = 0; i < CHECK_N_AUTOMATA + CHECK_N_RANDOM; i++) {
+		/* Every automaton is built three times over, as minimize_dfa() works in place. */
+		seed = randomSeed;
+		dfa = i < CHECK_N_AUTOMATA ? automaton_chk(dfa, i) : random_chk(dfa, &seed);
+		seed = randomSeed;
+		minimal = minimize_dfa(i < CHECK_N_AUTOMATA ? automaton_chk(minimal, i) : random_chk(minimal, &seed));
+		seed = randomSeed;
+		twice = minimize_dfa(minimize_dfa(i < CHECK_N_AUTOMATA ? automaton_chk(twice, i) : random_chk(twice, &seed)));
+
+		randomSeed = seed;
+
+		expect_chk(1, minimal->states->nStates <= dfa->states->nStates, "no more states", name_chk(i), 0, 0);
+		expect_chk(1, private_isSame_chkm(minimal, twice), "minimizing twice", name_chk(i), 0, 0);
+		expect_chk(1, isEquivalent_dfa(dfa, minimal, &counterexample), "isEquivalent_dfa", name_chk(i), 0, 0);
+		expect_chk(1, counterexample == NULL, "no counterexample", name_chk(i), 0, 0);
+		free(counterexample);
+		expect_chk(1, isEquivalent_dfa(minimal, twice, NULL), "isEquivalent_dfa after minimizing twice", name_chk(i), 0, 0);
+		for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+			for (t = 0; t < 8; t++) {
+				walk_chk(t % 2 ? dfa : minimal, buf, lens[j], &walkSeed);
+				expect_chk(accepts_chk(dfa, buf, lens[j]), accepts_chk(minimal, buf, lens[j]), "minimize_dfa", name_chk(i), lens[j], t);
+			}
+		}
+		finalize_dfa(twice);
+		finalize_dfa(minimal);
+		finalize_dfa(dfa);
+	}
+	free(buf);
+	stop_logging();
+
+	return report_chk("checkMinimize");
+}
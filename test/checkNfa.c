@@ -0,0 +1,201 @@
+/** \file checkNfa.c
+ ** \brief Checks the <nfa> reader and toDfa_nfa() against a simulation of the NFA.
+ **
+ ** test/epsilonNfa.xml has epsilon edges, an epsilon loop, a symbol leading
+ ** to two sinks and a sink listed twice. Its DFA must accept every string of
+ ** up to CHECK_MAX_STRING symbols exactly when the same NFA, built by hand,
+ ** reaches a set of states holding an accepting one, and keep the declared
+ ** symbol no edge reads. The files with a duplicate state or a symbol
+ ** outside the alphabet must stop with an error.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "nfa.h"
+
+#ifndef CHECK_MAX_STRING
+	#define CHECK_MAX_STRING 7
+#endif
+#ifndef CHECK_STRING_ALPHABET
+	#define CHECK_STRING_ALPHABET "abcd"
+#endif
+#define CHECK_NFA "test/epsilonNfa.xml"
+
+/** \brief The files that must be rejected.
+ **/
+static const char* const malformed_chkn[] = {
+	"test/duplicateStateNfa.xml",
+	"test/outsideAlphabetNfa.xml"
+};
+
+/** \brief Adds to a set of NFA states every state reachable from it by epsilon edges.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param isIn The set, one flag per state
+ **/
+static void private_close_chkn(const NondeterministicFiniteAutomaton* nfa, unsigned char* isIn)
+{
+	/* Variable declarations. */
+	int isGrowing;
+	const NFAEdge* edge;
+
+	do {
+		isGrowing = 0;
+		for (edge = nfa->edges; edge < nfa->edges + nfa->nEdges; edge++) {
+			if (edge->isEpsilon && isIn[edge->sourceId] && !isIn[edge->sinkId]) {
+				isIn[edge->sinkId] = 1;
+				isGrowing = 1;
+			}
+		}
+	} while (isGrowing);
+}
+
+/** \brief Runs a NondeterministicFiniteAutomaton on a string, one set of states at a time.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param buf The input
+ ** \param len The length of the input
+ ** \returns 1 if an accepting state is reached, 0 otherwise.
+ **/
+static int private_accepts_chkn(const NondeterministicFiniteAutomaton* nfa, const char* buf, const size_t len)
+{
+	/* Variable declarations. */
+	size_t i;
+	unsigned int q;
+	unsigned char b;
+	int isAccepted;
+	unsigned char *isIn, *isNext, *swap;
+	const NFAEdge* edge;
+
+	isIn = calloc(nfa->nStates, 1);
+	isNext = calloc(nfa->nStates, 1);
+	isIn[nfa->initialStateId] = 1;
+	private_close_chkn(nfa, isIn);
+	for (i = 0; i < len; i++) {
+		b = (unsigned char)buf[i];
+		memset(isNext, 0, nfa->nStates);
+		for (edge = nfa->edges; edge < nfa->edges + nfa->nEdges; edge++)
+			if (!edge->isEpsilon && isIn[edge->sourceId] && (edge->bytes[b >> 3] & (1u << (b & 7))))
+				isNext[edge->sinkId] = 1;
+		private_close_chkn(nfa, isNext);
+		swap = isIn;
+		isIn = isNext;
+		isNext = swap;
+	}
+	for (isAccepted = 0, q = 0; q < nfa->nStates; q++)
+		if (isIn[q] && nfa->isAccept[q])
+			isAccepted = 1;
+	free(isIn);
+	free(isNext);
+
+	return isAccepted;
+}
+
+/** \brief Adds an edge on a string of symbols, or an epsilon edge, to a NondeterministicFiniteAutomaton.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \param sourceId The source state
+ ** \param sinkId The sink state
+ ** \param symbols The symbols, NULL for an epsilon edge
+ **/
+static void private_insertEdge_chkn(NondeterministicFiniteAutomaton* nfa, const NFAStateId sourceId, const NFAStateId sinkId, const char* symbols)
+{
+	/* Variable declaration. */
+	unsigned char bytes[NFA_SET_SIZE];
+
+	memset(bytes, 0, NFA_SET_SIZE);
+	for (; symbols && *symbols; symbols++)
+		bytes[(unsigned char)*symbols >> 3] |= (unsigned char)(1u << (*symbols & 7));
+	insertEdge_nfa(nfa, sourceId, sinkId, symbols ? bytes : NULL);
+}
+
+/** \brief Builds the NFA of test/epsilonNfa.xml with the member functions.
+ ** \param nfa The NondeterministicFiniteAutomaton
+ ** \returns A pointer to the NondeterministicFiniteAutomaton.
+ **/
+static NondeterministicFiniteAutomaton* private_build_chkn(NondeterministicFiniteAutomaton* nfa)
+{
+	/* Variable declarations. */
+	NFAStateId q0, q1, q2, q3;
+
+	nfa = initialize_nfa(nfa);
+	q0 = insertState_nfa(nfa, 0);
+	q1 = insertState_nfa(nfa, 0);
+	q2 = insertState_nfa(nfa, 1);
+	q3 = insertState_nfa(nfa, 0);
+	nfa->initialStateId = q0;
+	private_insertEdge_chkn(nfa, q0, q1, NULL);
+	private_insertEdge_chkn(nfa, q0, q2, "a");
+	private_insertEdge_chkn(nfa, q0, q3, "ab");
+	private_insertEdge_chkn(nfa, q1, q1, "a");
+	private_insertEdge_chkn(nfa, q1, q2, "b");
+	private_insertEdge_chkn(nfa, q2, q0, NULL);
+	private_insertEdge_chkn(nfa, q3, q3, NULL);
+	private_insertEdge_chkn(nfa, q3, q2, "ab");
+
+	return nfa;
+}
+
+/** \brief Reads an NFA file and determinizes it, for isFatal_chk().
+ ** \param filename The filename
+ **/
+static void private_read_chkn(const char* filename)
+{
+	/* Variable declarations. */
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+
+	nfa = fromFile_nfa(nfa, filename);
+	dfa = toDfa_nfa(dfa, nfa);
+	finalize_dfa(dfa);
+	finalize_nfa(nfa);
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	char buf[CHECK_MAX_STRING];
+	unsigned int i, k;
+	unsigned long n, nStrings, m;
+	size_t len;
+	FILE* fp;
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+	NondeterministicFiniteAutomaton sBuffer, *streamed = &sBuffer;
+	NondeterministicFiniteAutomaton bBuffer, *built = &bBuffer;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+
+	start_logging();
+	for (i = 0; i < sizeof(malformed_chkn) / sizeof(malformed_chkn[0]); i++)
+		expect_chk(1, isFatal_chk(private_read_chkn, malformed_chkn[i]), "rejecting a malformed NFA", malformed_chkn[i], 0, i);
+	expect_chk(0, isFatal_chk(private_read_chkn, CHECK_NFA), "reading a well-formed NFA", CHECK_NFA, 0, 0);
+
+	nfa = fromFile_nfa(nfa, CHECK_NFA);
+	dfa = toDfa_nfa(dfa, nfa);
+	expect_chk(1, strchr(dfa->alphabet, 'c') != NULL, "keeping the declared alphabet", CHECK_NFA, 0, 0);
+	expect_chk(1, strchr(dfa->alphabet, 'd') == NULL, "keeping out undeclared symbols", CHECK_NFA, 0, 0);
+
+	/* The stream reader builds the same NFA as the file reader. */
+	fp = fopen(CHECK_NFA, "r");
+	streamed = fromStream_nfa(streamed, fp);
+	fclose(fp);
+	expect_chk(nfa->nStates, streamed->nStates, "fromStream_nfa", CHECK_NFA, 0, 0);
+	expect_chk(nfa->nEdges, streamed->nEdges, "fromStream_nfa", CHECK_NFA, 0, 1);
+	expect_chk(1, nfa->nEdges == streamed->nEdges && !memcmp(nfa->edges, streamed->edges, nfa->nEdges * sizeof(NFAEdge)), "fromStream_nfa", CHECK_NFA, 0, 2);
+	finalize_nfa(streamed);
+
+	/* Every string over the alphabet, and a symbol outside it, up to CHECK_MAX_STRING. */
+	built = private_build_chkn(built);
+	for (nStrings = 1, len = 0; len <= CHECK_MAX_STRING; len++) {
+		for (n = 0; n < nStrings; n++) {
+			for (m = n, k = 0; k < len; k++, m /= sizeof(CHECK_STRING_ALPHABET) - 1)
+				buf[k] = CHECK_STRING_ALPHABET[m % (sizeof(CHECK_STRING_ALPHABET) - 1)];
+			expect_chk(private_accepts_chkn(built, buf, len), accepts_chk(dfa, buf, len), "toDfa_nfa", CHECK_NFA, len, (unsigned int)n);
+		}
+		nStrings *= sizeof(CHECK_STRING_ALPHABET) - 1;
+	}
+	finalize_nfa(built);
+	finalize_dfa(dfa);
+	finalize_nfa(nfa);
+	stop_logging();
+
+	return report_chk("checkNfa");
+}
@@ -0,0 +1,59 @@
+/** \file checkParallel.c
+ ** \brief Checks matchParallel_dfam() against match_dfam() across thread counts.
+ **
+ ** Built by `make check` with tiny DFA_PARALLEL_MIN_CHUNK and
+ ** DFA_PARALLEL_MERGE_SIZE, so that short inputs are split too, including
+ ** inputs shorter than the number of threads. The random automata have
+ ** unreachable and equivalent states, which the speculative runs start from.
+ **/
+#include <stdlib.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "match.h"
+
+#ifndef CHECK_MAX_THREADS
+	#define CHECK_MAX_THREADS 9
+#endif
+
+#ifndef CHECK_N_RANDOM
+	#define CHECK_N_RANDOM 20
+#endif
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 5, 7, 8, 9, 13, 64, 1000, 4097, CHECK_MAX_INPUT};
+	unsigned int i, j, t, nThreads;
+	unsigned long seed, randomSeed;
+	int expected;
+	char* buf;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	DFAMatcher mBuffer, *matcher = &mBuffer;
+
+	start_logging();
+	buf = malloc(CHECK_MAX_INPUT);
+	seed = 1;
+	randomSeed = 2;
+	for (i = 0; i < CHECK_N_AUTOMATA + CHECK_N_RANDOM; i++) {
+		dfa = i < CHECK_N_AUTOMATA ? automaton_chk(dfa, i) : random_chk(dfa, &randomSeed);
+		matcher = initialize_dfam(matcher, dfa);
+		for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+			for (t = 0; t < 4; t++) {
+				walk_chk(dfa, buf, lens[j], &seed);
+				expected = match_dfam(matcher, buf, lens[j]);
+				expect_chk(accepts_chk(dfa, buf, lens[j]), expected, "match_dfam", name_chk(i), lens[j], t);
+
+				/* 0 threads asks for one per online processor. */
+				for (nThreads = 0; nThreads <= CHECK_MAX_THREADS; nThreads++)
+					expect_chk(expected, matchParallel_dfam(matcher, buf, lens[j], nThreads), "matchParallel_dfam", name_chk(i), lens[j], nThreads);
+			}
+		}
+		finalize_dfam(matcher);
+		finalize_dfa(dfa);
+	}
+	free(buf);
+	stop_logging();
+
+	return report_chk("checkParallel");
+}
@@ -0,0 +1,153 @@
+/** \file checkProduct.c
+ ** \brief Checks product_dfa() and complement_dfa() against the membership of their operands.
+ **
+ ** Every pair of the shipped automata and of random automata goes through
+ ** the four operations. The product must accept a string exactly when the
+ ** operation of the answers of the operands does, on random walks on either
+ ** operand and on the product. The complement must accept exactly the strings
+ ** over the alphabet that the automaton rejects, and the complement of the
+ ** complement must accept what the automaton does. The DFA of
+ ** test/epsilonNfa.xml must keep the declared symbol no edge reads through
+ ** the complement.
+ **/
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "nfa.h"
+
+#ifndef CHECK_N_RANDOM
+	#define CHECK_N_RANDOM 12
+#endif
+#ifndef CHECK_N_WALKS
+	#define CHECK_N_WALKS 6
+#endif
+#define CHECK_NFA "test/epsilonNfa.xml"
+#define CHECK_N_OPERANDS (CHECK_N_AUTOMATA + CHECK_N_RANDOM)
+
+/** \brief The operations of product_dfa(), in the order of DFAOperation.
+ **/
+static const char* const operations_chkp[] = {"intersection", "union", "difference", "symmetric difference"};
+
+/** \brief Combines the answers of two operands the way product_dfa() combines their states.
+ ** \param operation The DFAOperation
+ ** \param isLeft Whether the left operand accepts
+ ** \param isRight Whether the right operand accepts
+ ** \returns 1 if the product must accept, 0 otherwise.
+ **/
+static int private_apply_chkp(const DFAOperation operation, const int isLeft, const int isRight)
+{
+	switch (operation) {
+		case DFA_OPERATION_INTERSECTION:
+			return isLeft && isRight;
+		case DFA_OPERATION_UNION:
+			return isLeft || isRight;
+		case DFA_OPERATION_DIFFERENCE:
+			return isLeft && !isRight;
+		default:
+			return !isLeft != !isRight;
+	}
+}
+
+/** \brief Tells whether every byte of a string is in the alphabet of a DeterministicFiniteAutomaton.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param buf The string
+ ** \param len The length of the string
+ ** \returns 1 if every byte is in the alphabet, 0 otherwise.
+ **/
+static int private_isOver_chkp(const DeterministicFiniteAutomaton* dfa, const char* buf, const size_t len)
+{
+	/* Variable declaration. */
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (!buf[i] || !strchr(dfa->alphabet, buf[i]))
+			return 0;
+
+	return 1;
+}
+
+/** \brief Builds an operand, the same one for the same index.
+ ** \param dfa The DeterministicFiniteAutomaton
+ ** \param i The index, below CHECK_N_AUTOMATA for the shipped automata
+ ** \returns A pointer to the DeterministicFiniteAutomaton.
+ **/
+static DeterministicFiniteAutomaton* private_operand_chkp(DeterministicFiniteAutomaton* dfa, const unsigned int i)
+{
+	/* Variable declaration. */
+	unsigned long seed;
+
+	if (i < CHECK_N_AUTOMATA)
+		return automaton_chk(dfa, i);
+	seed = i;
+
+	return random_chk(dfa, &seed);
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	static const size_t lens[] = {0, 1, 2, 3, 5, 8, 13, 64};
+	char buf[64];
+	unsigned int i, j, k, t;
+	unsigned long seed;
+	int expected;
+	size_t len;
+	DFAOperation operation;
+	DeterministicFiniteAutomaton operands[CHECK_N_OPERANDS];
+	DeterministicFiniteAutomaton pBuffer, *product = &pBuffer;
+	DeterministicFiniteAutomaton cBuffer, *complement = &cBuffer;
+	DeterministicFiniteAutomaton tBuffer, *twice = &tBuffer;
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+
+	start_logging();
+	for (i = 0; i < CHECK_N_OPERANDS; i++)
+		private_operand_chkp(operands + i, i);
+
+	seed = 1;
+	for (i = 0; i < CHECK_N_OPERANDS; i++) {
+		for (j = 0; j < CHECK_N_OPERANDS; j++) {
+			for (k = 0; k < sizeof(operations_chkp) / sizeof(operations_chkp[0]); k++) {
+				operation = (DFAOperation)k;
+				product = product_dfa(product, operands + i, operands + j, operation);
+				for (len = 0; len < sizeof(lens) / sizeof(lens[0]); len++) {
+					for (t = 0; t < 3 * CHECK_N_WALKS; t++) {
+						walk_chk(t % 3 == 0 ? operands + i : t % 3 == 1 ? operands + j : product, buf, lens[len], &seed);
+						expected = private_apply_chkp(operation, accepts_chk(operands + i, buf, lens[len]), accepts_chk(operands + j, buf, lens[len]));
+						expect_chk(expected, accepts_chk(product, buf, lens[len]), operations_chkp[k], name_chk(i), lens[len], j);
+					}
+				}
+				finalize_dfa(product);
+			}
+		}
+	}
+
+	for (i = 0; i < CHECK_N_OPERANDS; i++) {
+		complement = complement_dfa(private_operand_chkp(complement, i));
+		twice = complement_dfa(complement_dfa(private_operand_chkp(twice, i)));
+		for (len = 0; len < sizeof(lens) / sizeof(lens[0]); len++) {
+			for (t = 0; t < 2 * CHECK_N_WALKS; t++) {
+				walk_chk(t % 2 ? operands + i : complement, buf, lens[len], &seed);
+				expected = accepts_chk(operands + i, buf, lens[len]);
+				expect_chk(!expected && private_isOver_chkp(operands + i, buf, lens[len]), accepts_chk(complement, buf, lens[len]), "complement_dfa", name_chk(i), lens[len], t);
+				expect_chk(expected, accepts_chk(twice, buf, lens[len]), "complementing twice", name_chk(i), lens[len], t);
+			}
+		}
+		finalize_dfa(twice);
+		finalize_dfa(complement);
+	}
+	for (i = 0; i < CHECK_N_OPERANDS; i++)
+		finalize_dfa(operands + i);
+
+	/* The declared symbol that no edge reads is still in the alphabet of the complement. */
+	nfa = fromFile_nfa(nfa, CHECK_NFA);
+	complement = complement_dfa(toDfa_nfa(complement, nfa));
+	expect_chk(1, accepts_chk(complement, "c", 1), "complementing a declared symbol", CHECK_NFA, 1, 0);
+	expect_chk(0, accepts_chk(complement, "d", 1), "complementing an undeclared symbol", CHECK_NFA, 1, 0);
+	finalize_dfa(complement);
+	finalize_nfa(nfa);
+	stop_logging();
+
+	return report_chk("checkProduct");
+}
@@ -0,0 +1,152 @@
+/** \file checkRegex.c
+ ** \brief Checks fromRegex_nfa() and toDfa_nfa() against POSIX regcomp() on random patterns.
+ **
+ ** The patterns use the syntax that both sides read the same way: literals,
+ ** the dot, bracketed classes, grouping, alternation and the quantifiers.
+ ** POSIX searches, so the pattern is anchored as ^(...)$. Each DFA is run
+ ** on random strings and on random walks on it, cut at the first NUL since
+ ** regexec() reads strings. Malformed patterns must stop the process with
+ ** an error.
+ **/
+#include <regex.h>
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "dfa.h"
+#include "logging.h"
+#include "nfa.h"
+
+#ifndef CHECK_N_PATTERNS
+	#define CHECK_N_PATTERNS 500
+#endif
+#ifndef CHECK_N_STRINGS
+	#define CHECK_N_STRINGS 40
+#endif
+#ifndef CHECK_MAX_PATTERN
+	#define CHECK_MAX_PATTERN 200
+#endif
+#ifndef CHECK_MAX_GENERATED
+	#define CHECK_MAX_GENERATED 32768
+#endif
+#ifndef CHECK_MAX_STRING
+	#define CHECK_MAX_STRING 12
+#endif
+#ifndef CHECK_STRING_ALPHABET
+	#define CHECK_STRING_ALPHABET "abc.d"
+#endif
+
+/** \brief The atoms of the random patterns.
+ **/
+static const char* const atoms_chkr[] = {"a", "b", "c", ".", "\\.", "[ab]", "[^a]", "[a-c]", "[.b]"};
+
+/** \brief The quantifiers of the random patterns, the empty one included.
+ **/
+static const char* const quantifiers_chkr[] = {"", "", "", "*", "+", "?", "{2}", "{0,2}", "{1,}", "{1,3}"};
+
+/** \brief Malformed patterns, each of which must be rejected.
+ **/
+static const char* const malformed_chkr[] = {"a{3,1}", "[z-a]", "(a", "a)", "\\x4", "*a", "a|*", "[a", "a{", "a{1", "(?a)", "\\"};
+
+/** \brief Well-formed patterns close to the malformed ones, each of which must be accepted.
+ **/
+static const char* const wellFormed_chkr[] = {"a{1,3}", "[a-z]", "(a)", "a\\)", "\\x41", "a*", "a|b*", "[a]", "a{1}", "(?:a)", "\\\\"};
+
+#define CHECK_N_ELEMENTS(array) (sizeof(array) / sizeof(array[0]))
+
+/** \brief Appends a random alternation to a pattern.
+ ** \param pattern The pattern, NUL-terminated
+ ** \param depth How many more groups may be nested
+ ** \param seed The state of the generator, updated
+ **
+ ** Every branch has one to three pieces and no branch is empty, since POSIX
+ ** leaves empty branches and empty groups undefined. Three levels of groups
+ ** stay below CHECK_MAX_GENERATED bytes.
+ **/
+static void private_alternation_chkr(char* pattern, const unsigned int depth, unsigned long* seed)
+{
+	/* Variable declarations. */
+	unsigned int i, j, nBranches, nPieces;
+
+	nBranches = 1 + (next_chk(seed) % 4 == 0);
+	for (i = 0; i < nBranches; i++) {
+		if (i)
+			strcat(pattern, "|");
+		nPieces = 1 + next_chk(seed) % 3;
+		for (j = 0; j < nPieces; j++) {
+			if (depth && next_chk(seed) % 4 == 0) {
+				strcat(pattern, "(");
+				private_alternation_chkr(pattern, depth - 1, seed);
+				strcat(pattern, ")");
+			} else {
+				strcat(pattern, atoms_chkr[next_chk(seed) % CHECK_N_ELEMENTS(atoms_chkr)]);
+			}
+			strcat(pattern, quantifiers_chkr[next_chk(seed) % CHECK_N_ELEMENTS(quantifiers_chkr)]);
+		}
+	}
+}
+
+/** \brief Builds the NFA of a pattern, for isFatal_chk().
+ ** \param pattern The pattern
+ **/
+static void private_parse_chkr(const char* pattern)
+{
+	/* Variable declaration. */
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+
+	nfa = fromRegex_nfa(nfa, pattern);
+	finalize_nfa(nfa);
+}
+
+int main(void)
+{
+	/* Variable declarations. */
+	static char pattern[CHECK_MAX_GENERATED], anchored[CHECK_MAX_GENERATED + 8];
+	char buf[CHECK_MAX_STRING + 1];
+	unsigned int i, j, k;
+	unsigned long seed, walkSeed;
+	size_t len;
+	regex_t posix;
+	DeterministicFiniteAutomaton dBuffer, *dfa = &dBuffer;
+	NondeterministicFiniteAutomaton nBuffer, *nfa = &nBuffer;
+
+	start_logging();
+	for (i = 0; i < CHECK_N_ELEMENTS(malformed_chkr); i++)
+		expect_chk(1, isFatal_chk(private_parse_chkr, malformed_chkr[i]), "rejecting a malformed pattern", malformed_chkr[i], 0, i);
+	for (i = 0; i < CHECK_N_ELEMENTS(wellFormed_chkr); i++)
+		expect_chk(0, isFatal_chk(private_parse_chkr, wellFormed_chkr[i]), "accepting a well-formed pattern", wellFormed_chkr[i], 0, i);
+
+	seed = 1;
+	walkSeed = 2;
+	for (i = 0; i < CHECK_N_PATTERNS; i++) {
+		do {
+			pattern[0] = '\0';
+			private_alternation_chkr(pattern, 3, &seed);
+		} while (strlen(pattern) > CHECK_MAX_PATTERN);
+		sprintf(anchored, "^(%s)$", pattern);
+		if (regcomp(&posix, anchored, REG_EXTENDED | REG_NOSUB)) {
+			expect_chk(0, 1, "regcomp", pattern, 0, i);
+			continue;
+		}
+		nfa = fromRegex_nfa(nfa, pattern);
+		dfa = toDfa_nfa(dfa, nfa);
+		finalize_nfa(nfa);
+
+		for (j = 0; j < 2 * CHECK_N_STRINGS; j++) {
+			len = next_chk(&seed) % (CHECK_MAX_STRING + 1);
+			if (j < CHECK_N_STRINGS) {
+				for (k = 0; k < len; k++)
+					buf[k] = CHECK_STRING_ALPHABET[next_chk(&seed) % (sizeof(CHECK_STRING_ALPHABET) - 1)];
+			} else {
+				walk_chk(dfa, buf, len, &walkSeed);
+			}
+			buf[len] = '\0';
+			len = strlen(buf);
+			expect_chk(!regexec(&posix, buf, 0, NULL, 0), accepts_chk(dfa, buf, len), "toDfa_nfa", pattern, len, j);
+		}
+		regfree(&posix);
+		finalize_dfa(dfa);
+	}
+	stop_logging();
+
+	return report_chk("checkRegex");
+}
@@ -0,0 +1,194 @@
+/** \file checkXml.c
+ ** \brief Checks parseStream_xml() and parseFile_xml() against parseString_xml() on the shipped examples and test/entities.xml.
+ **
+ ** Built by `make check` with a tiny XML_CHUNK_SIZE and run behind more and
+ ** more leading spaces, so that every tag, attribute and entity is split
+ ** across the chunks of the stream somewhere. The stream, the mapping and
+ ** the string must report the same events, the pieces of a text being put
+ ** back together.
+ **/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "logging.h"
+#include "unless.h"
+#include "xml.h"
+
+#ifndef CHECK_MAX_PADDING
+	#define CHECK_MAX_PADDING 40
+#endif
+#define CHECK_PADDED "bin/checkXml.xml"
+
+/** \brief The documents, relative to the root of the repository.
+ **/
+static const char* const documents_chkx[] = {
+	"oddOnes/oddOnes.xml",
+	"traditionalRomanNumerals/isRomanNumeral.xml",
+	"test/entities.xml"
+};
+
+/** \brief Events that the last document must report, unescaped.
+ **/
+static const char* const entities_chkx[] = {
+	"\nAtitle=a < b && b > c",
+	"\nAquoted=say \"'hi'\" > 2",
+	"\nT\n\t<not a tag> &amp; \"quoted\" 'single'\n\t",
+	"\nSempty\nAattribute=&\nEempty",
+	"\nAanAttributeWithAnEquallyLongName=a value > its chunk\nT&<>\"'\nEaVeryLongTagNameThatSpansSeveralChunksOfTheReader",
+	"\nSspaced\nAa=1\nAb=2\nTtext\nEspaced",
+	"\nT\n\t\n\tplain text & more\n\nEdocument"
+};
+
+/** \brief The events reported by a reader, each on a line of its own.
+ **/
+typedef struct XmlEventsBody {
+	char* events;
+	size_t size;
+	size_t capacity;
+	int isText;
+} XmlEvents;
+
+/** \brief Appends to the events.
+ ** \param events The XmlEvents
+ ** \param str The string
+ ** \param len The length of the string
+ **/
+static void private_append_chkx(XmlEvents* events, const char* str, const size_t len)
+{
+	while (events->size + len + 1 > events->capacity) {
+		events->capacity = events->capacity ? 2 * events->capacity : 1024;
+		events->events = realloc(events->events, events->capacity);
+	}
+	memcpy(events->events + events->size, str, len);
+	events->size += len;
+	events->events[events->size] = '\0';
+}
+
+/** \brief Appends an event.
+ ** \param events The XmlEvents
+ ** \param kind The kind of the event, a newline then a letter
+ ** \param str The slice of the event
+ ** \param len The length of the slice
+ **/
+static void private_event_chkx(XmlEvents* events, const char* kind, const char* str, const size_t len)
+{
+	events->isText = 0;
+	private_append_chkx(events, kind, 2);
+	private_append_chkx(events, str, len);
+}
+
+/** \brief Tells whether two readers reported the same events.
+ ** \param a The XmlEvents of a reader
+ ** \param b The XmlEvents of a reader
+ ** \returns 1 if they are the same, 0 otherwise.
+ **/
+static int private_isSame_chkx(const XmlEvents* a, const XmlEvents* b)
+{
+	return a->size == b->size && !memcmp(a->events, b->events, a->size);
+}
+
+/** \brief Records a meta tag.
+ **/
+static void private_meta_chkx(void* context, const char* meta, const size_t len)
+{
+	private_event_chkx(context, "\nM", meta, len);
+}
+
+/** \brief Records a start tag.
+ **/
+static void private_startTag_chkx(void* context, const char* tag, const size_t len)
+{
+	private_event_chkx(context, "\nS", tag, len);
+}
+
+/** \brief Records an attribute.
+ **/
+static void private_attribute_chkx(void* context, const char* name, const size_t nameLen, const char* value, const size_t valueLen)
+{
+	private_event_chkx(context, "\nA", name, nameLen);
+	private_append_chkx(context, "=", 1);
+	private_append_chkx(context, value, valueLen);
+}
+
+/** \brief Records a piece of text, after the previous one if they are back to back.
+ **/
+static void private_text_chkx(void* context, const char* text, const size_t len)
+{
+	/* Variable declaration. */
+	XmlEvents* events = context;
+
+	unless (events->isText)
+		private_event_chkx(events, "\nT", text, 0);
+	events->isText = 1;
+	private_append_chkx(events, text, len);
+}
+
+/** \brief Records an end tag.
+ **/
+static void private_endTag_chkx(void* context, const char* tag, const size_t len)
+{
+	private_event_chkx(context, "\nE", tag, len);
+}
+
+/** \brief The XmlHandler recording every event.
+ **/
+static const XmlHandler handler_chkx = {
+	&private_meta_chkx,
+	&private_startTag_chkx,
+	&private_attribute_chkx,
+	&private_text_chkx,
+	&private_endTag_chkx
+};
+
+int main(void)
+{
+	/* Variable declarations. */
+	unsigned int i, j, padding;
+	size_t len;
+	char* xmlstr;
+	FILE* fp;
+	XmlEvents expected, actual;
+
+	start_logging();
+	for (i = 0; i < sizeof(documents_chkx) / sizeof(documents_chkx[0]); i++) {
+		fp = fopen(documents_chkx[i], "rb");
+		fseek(fp, 0, SEEK_END);
+		len = ftell(fp);
+		rewind(fp);
+		xmlstr = malloc(len);
+		len = fread(xmlstr, 1, len, fp);
+		fclose(fp);
+
+		memset(&expected, 0, sizeof(expected));
+		parseString_xml(xmlstr, len, &handler_chkx, &expected);
+		for (padding = 0; padding <= CHECK_MAX_PADDING; padding++) {
+			fp = fopen(CHECK_PADDED, "wb");
+			for (j = 0; j < padding; j++)
+				fputc(' ', fp);
+			fwrite(xmlstr, 1, len, fp);
+			fclose(fp);
+
+			memset(&actual, 0, sizeof(actual));
+			fp = fopen(CHECK_PADDED, "rb");
+			parseStream_xml(fp, &handler_chkx, &actual);
+			fclose(fp);
+			expect_chk(1, private_isSame_chkx(&expected, &actual), "parseStream_xml", documents_chkx[i], padding, XML_CHUNK_SIZE);
+			free(actual.events);
+
+			memset(&actual, 0, sizeof(actual));
+			parseFile_xml(CHECK_PADDED, &handler_chkx, &actual);
+			expect_chk(1, private_isSame_chkx(&expected, &actual), "parseFile_xml", documents_chkx[i], padding, XML_CHUNK_SIZE);
+			free(actual.events);
+		}
+
+		if (i == sizeof(documents_chkx) / sizeof(documents_chkx[0]) - 1)
+			for (j = 0; j < sizeof(entities_chkx) / sizeof(entities_chkx[0]); j++)
+				expect_chk(1, strstr(expected.events, entities_chkx[j]) != NULL, "unescaping", documents_chkx[i], 0, j);
+		free(expected.events);
+		free(xmlstr);
+	}
+	stop_logging();
+
+	return report_chk("checkXml");
+}
@@ -0,0 +1,97 @@
+/** \file runBackend.c
+ ** \brief Runs a generated matcher on the inputs written by checkBackends.c.
+ **
+ ** Compiled by checkBackends.c together with the code it generates. Every
+ ** line of the standard input is an input in hexadecimal; the answer of
+ ** CHECK_FUNCTION on it is printed on its own line as 0 or 1. CHECK_LENGTH
+ ** selects the signature of --length, and CHECK_BATCH the one of --batch,
+ ** which is called once on all the inputs. CHECK_HPP includes the C++
+ ** header instead, whose matchers take a const char*.
+ **/
+/* First, so that the generated code has to include what it uses. */
+#ifdef CHECK_HPP
+	#include "checkGenerated.hpp"
+#else
+	#include "checkGenerated.c"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CHECK_MAX_INPUT
+	#define CHECK_MAX_INPUT 70000
+#endif
+#ifndef CHECK_MAX_INPUTS
+	#define CHECK_MAX_INPUTS 1000
+#endif
+#if defined(CHECK_LENGTH) && defined(CHECK_HPP)
+	#define CHECK_CALL(buf, len) CHECK_FUNCTION((const char*)(buf), len)
+#elif defined(CHECK_LENGTH)
+	#define CHECK_CALL(buf, len) CHECK_FUNCTION(buf, len)
+#else
+	#define CHECK_CALL(buf, len) CHECK_FUNCTION((const char*)(buf))
+#endif
+
+#ifdef CHECK_BATCH
+/** \brief Keeps every input, then matches them all at once.
+ ** \param buf The input, or NULL to match the inputs kept so far and print the answers
+ ** \param len Its length
+ **/
+static void add_chkr(const unsigned char* buf, size_t len)
+{
+	/* Variable declarations. */
+	static unsigned char* inputs[CHECK_MAX_INPUTS];
+	static size_t lens[CHECK_MAX_INPUTS];
+	static unsigned char results[CHECK_MAX_INPUTS];
+	static size_t n = 0;
+	size_t i;
+
+	if (buf) {
+		if (n == CHECK_MAX_INPUTS)
+			exit(1);
+		inputs[n] = malloc(len + 1);
+		memcpy(inputs[n], buf, len);
+		lens[n++] = len;
+		return;
+	}
+	CHECK_FUNCTION((const unsigned char* const*)inputs, lens, n, results);
+	for (i = 0; i < n; i++) {
+		printf("%d\n", results[i] ? 1 : 0);
+		free(inputs[i]);
+	}
+}
+#endif
+
+int main(void)
+{
+	/* Variable declarations. */
+	static unsigned char buf[CHECK_MAX_INPUT + 1];
+	size_t len;
+	int c, digit, isLow;
+
+	len = 0;
+	isLow = 0;
+	while ((c = getchar()) != EOF) {
+		if (c == '\n') {
+			buf[len] = '\0';
+#ifdef CHECK_BATCH
+			add_chkr(buf, len);
+#else
+			printf("%d\n", CHECK_CALL(buf, len) ? 1 : 0);
+#endif
+			len = 0;
+			continue;
+		}
+		digit = c <= '9' ? c - '0' : c - 'a' + 10;
+		if (isLow)
+			buf[len++] |= (unsigned char)digit;
+		else
+			buf[len] = (unsigned char)(digit << 4);
+		isLow = !isLow;
+	}
+#ifdef CHECK_BATCH
+	add_chkr(NULL, 0);
+#endif
+
+	return 0;
+}